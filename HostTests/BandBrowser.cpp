@@ -0,0 +1,755 @@
+/*
+Host multi-channel PSK31 decoder ("band browser"). Decodes every PSK31 signal in the receiver passband at once
+instead of the one at the 1 Khz offset that the sketch decodes.
+
+  Filterbank - Overlap-save FFT filterbank. One FFT of the band every hop is shared by all channels. Each channel
+               takes the bins around its carrier, applies the channel filter (+/-50 Hz lowpass) and an inverse FFT
+               of only those bins gives its baseband samples decimated to ~300 Hz
+  Carriers   - Peaks in the averaged (Hann) spectrum that stand BB_DETECT_DB above the noise floor (median bin).
+               A new carrier opens a channel and a channel closes when its carrier has gone for BB_DROP_SECONDS
+  Channels   - Each channel has its own PSK31 decoder state: fine tuning NCO with AFC, bit timing (early/late on
+               the envelope), differential phase decision and the sketch's varicode trie (VaricodeNextNode())
+  Workers    - Audio is processed in batches of BB_BATCH_HOPS hops (~1 s). The main thread does the band FFTs and
+               carrier detection and the channels of a batch are shared out to a pool of worker threads
+
+  BandBrowser [-t threads] [-n channels] [-b channels] [-r rate] [-q] file|-
+    Decodes a 16 bit WAV file or raw 16 bit mono audio (file or "-" for a pipe) at rate (default F_SAMPLE) with a
+    live per-channel text view (final text only if stdout is not a terminal). -n is the most channels open (default
+    BB_MAX_CHANNELS). -b opens that many channels evenly across the passband (no carrier detection) to benchmark.
+    E.g. sox rx.wav -r 9615 -t raw -e signed -b 16 -c 1 - | ./build/BandBrowser -
+  Throughput is reported in channels per core: channel seconds decoded per CPU second of the worker threads.
+
+With no file a band of BB_TEST_SIGNALS PSK31 signals (-6 to 20 dB SNR, staggered starts) in receiver noise is
+decoded as a test. Exits with 1 if a signal is not found within BB_TEST_FREQ_TOL, its text has a CER over
+BB_TEST_MAX_CER or a channel opens on noise. Then the same band is decoded with BB_BENCH_CHANNELS channels
+*/
+
+#include <string>                  // Before Arduino.h (min/max macros)
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef std::complex<double> Cpx;
+
+#define PSK31_BAUD 31.25
+#define BB_MAX_BIN_HZ 5.0               // Filterbank FFT is the smallest power of 2 with bins this narrow (2048 at 9615 Hz)
+#define BB_MIN_CHANNEL_RATE 250.0       // Channel sample rate (Hz) at least this (8 or more samples per bit)
+#define BB_FILTER_HZ 50.0               // Channel filter cutoff (-6 dB). PSK31 main lobe is +/-31 Hz
+#define BB_BATCH_HOPS 10                // Hops per batch (~1 s at 9615 Hz)
+#define BB_MIN_HZ 200.0                 // Passband searched for carriers
+#define BB_MAX_HZ 2900.0
+#define BB_PEAK_HZ 40.0                 // Carrier is the strongest bin within +/-BB_PEAK_HZ. Centre is the centroid
+#define BB_DETECT_DB 6.0                // Carrier peak above the noise floor (median bin of the averaged spectrum)
+#define BB_SPACING_HZ 50.0              // Carriers closer than this to an open channel belong to it
+#define BB_AVERAGE 0.3                  // Spectrum averaging per batch (exponential, ~3 s)
+#define BB_DROP_SECONDS 10              // Channel closes when its carrier has not been seen for this long
+#define BB_QUIET_SECONDS 2              // No text shown when the carrier has not been seen for this long
+#define BB_MAX_CHANNELS 32
+#define BB_HISTORY 16                   // Channel samples kept for bit timing interpolation (power of 2)
+#define BB_TIMING_GAIN 0.1              // Bit timing correction (samples) per unit early/late error
+#define BB_SETTLE_BITS 32               // No text until the bit timing and AFC have settled after a channel opens
+#define BB_AFC_GAIN 0.02                // Fraction of the frequency error corrected each bit
+#define BB_AFC_RANGE 15.0               // Most fine tuning (Hz) from the filterbank bin
+#define BB_TEXT_KEEP 4096               // Characters kept per channel
+#define BB_VIEW_CHARS 64                // Characters shown per channel in the live view
+
+// Self test
+#define BB_TEST_SECONDS 60
+#define BB_TEST_SIGNALS 8
+#define BB_TEST_NOISE_RMS 1000.0        // 16 bit counts
+#define BB_TEST_FREQ_TOL 2.0            // Hz
+#define BB_TEST_MAX_CER 2.0             // %
+#define BB_BENCH_CHANNELS 64
+
+static double ThreadSeconds (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double WallSeconds (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Radix 2 complex FFT (in place). Inverse is not scaled
+class FFT {
+  public:
+    FFT (int size) : n (size), rev (size), w (size / 2) {
+      int bits = 0, i, b;
+      while ((1 << bits) < n) bits++;
+      for (i = 0; i < n; i++) {
+        rev[i] = 0;
+        for (b = 0; b < bits; b++) if (i & (1 << b)) rev[i] |= 1 << (bits - 1 - b);
+      }
+      for (i = 0; i < n / 2; i++) w[i] = std::polar (1.0, -2.0 * PI * i / n);
+    }
+    void Run (Cpx *x, bool inverse) const {
+      int len, i, k, step;
+      Cpx t;
+      for (i = 0; i < n; i++) if (i < rev[i]) std::swap (x[i], x[rev[i]]);
+      for (len = 2; len <= n; len <<= 1) {
+        step = n / len;
+        for (i = 0; i < n; i += len) {
+          for (k = 0; k < len / 2; k++) {
+            t = x[i + k + len / 2] * (inverse ? std::conj (w[k * step]) : w[k * step]);
+            x[i + k + len / 2] = x[i + k] - t;
+            x[i + k] += t;
+          }
+        }
+      }
+    }
+    int n;
+  private:
+    std::vector<int> rev;
+    std::vector<Cpx> w;
+};
+
+// Overlap-save filterbank. fftN point FFT every hop (fftN/2 new samples). A channel is chanN bins around its carrier
+// so channel samples are decimated by fftN/chanN. The channel filter is fftN/2 + 1 taps (the overlap-save limit)
+class Filterbank {
+  public:
+    Filterbank (double rate) : fs (rate), band (FFTSize (rate)), chan (ChannelSize (rate, band.n)), H (band.n) {
+      int taps = band.n / 2 + 1, i;
+      double fc = BB_FILTER_HZ / fs, x, sum = 0;
+      std::vector<Cpx> h (band.n);
+
+      // Windowed sinc lowpass (Blackman). Unity gain at DC. Only the chanN bins around 0 Hz are used
+      for (i = 0; i < taps; i++) {
+        x = i - (taps - 1) / 2.0;
+        h[i] = (x == 0 ? 2.0 * fc : sin (2.0 * PI * fc * x) / (PI * x)) *
+               (0.42 - 0.5 * cos (2.0 * PI * i / (taps - 1)) + 0.08 * cos (4.0 * PI * i / (taps - 1)));
+        sum += h[i].real ();
+      }
+      for (i = 0; i < taps; i++) h[i] /= sum;
+      band.Run (&h[0], false);
+      H = h;
+      hop = band.n / 2;
+      binHz = fs / band.n;
+      chanRate = fs * chan.n / band.n;
+    }
+    // Baseband samples of the channel at bin k0 for the hop (hop is the hop count, X its spectrum). Returns the
+    // chanN/2 new samples in y. Multiplying by (-1)^(k0 x hop) keeps the phase of the carrier continuous from hop
+    // to hop (the FFT is referenced to the start of the buffer which moves by half the FFT each hop)
+    void Channel (const Cpx *X, unsigned long hop, int k0, Cpx *y) const {
+      int m, o, n = band.n;
+      Cpx Y[chan.n];
+      double scale = (((unsigned long)k0 * hop) & 1 ? -1.0 : 1.0) / n;
+
+      for (m = 0; m < chan.n; m++) {
+        o = m < chan.n / 2 ? m : m - chan.n;
+        Y[m] = X[(k0 + o + n) % n] * H[(o + n) % n];
+      }
+      chan.Run (Y, true);
+      for (m = 0; m < chan.n / 2; m++) y[m] = Y[chan.n / 2 + m] * scale;      // Last half is valid (overlap-save)
+    }
+    double fs, binHz, chanRate;
+    int hop;
+    FFT band, chan;
+  private:
+    static int FFTSize (double rate) { int n = 256; while (rate / n > BB_MAX_BIN_HZ) n <<= 1; return n; }
+    static int ChannelSize (double rate, int n) { int c = 8; while (rate * c / n < BB_MIN_CHANNEL_RATE) c <<= 1; return c; }
+    std::vector<Cpx> H;
+};
+
+// One PSK31 decoder per channel. All state is here so channels can be decoded on any thread
+class PSKChannel {
+  public:
+    void Open (const Filterbank *fb, double f, unsigned long batch) {
+      bank = fb;
+      bin = (int)lround (f / fb->binHz);
+      offset = f - bin * fb->binHz;
+      freq = f;
+      level = 0;
+      theta = 0;
+      sps = fb->chanRate / PSK31_BAUD;
+      n = 0;
+      bits = 0;
+      t = sps;
+      last = 0;
+      node = VARICODE_ROOT;
+      seen = batch;
+      open = true;
+      text.clear ();
+    }
+    // Decode a batch (hops of the band spectrum). show is 0 while the carrier has gone (text not kept)
+    void Decode (const std::vector<std::vector<Cpx> > &spectra, unsigned long firstHop, bool show) {
+      Cpx y[BB_HISTORY * 8];
+      size_t b;
+      int i, count = bank->chan.n / 2;
+
+      for (b = 0; b < spectra.size (); b++) {
+        bank->Channel (&spectra[b][0], firstHop + b, bin, y);
+        for (i = 0; i < count; i++) Sample (y[i], show);
+      }
+      freq = bin * bank->binHz + offset;
+    }
+    bool open;
+    double freq, level;                 // Carrier (Hz) and level above the noise floor (dB)
+    unsigned long seen;                 // Batch the carrier was last seen
+    std::string text;
+  private:
+    Cpx At (double when) const {
+      // Linear interpolation between channel samples
+      long i = (long)floor (when);
+      double frac = when - i;
+      return hist[i & (BB_HISTORY - 1)] * (1.0 - frac) + hist[(i + 1) & (BB_HISTORY - 1)] * frac;
+    }
+    void Sample (Cpx y, bool show) {
+      Cpx c, e, l, d;
+      double pe, pl, err;
+      unsigned char ch;
+
+      // Fine tuning. The filterbank bin centre is up to half a bin from the carrier
+      hist[n & (BB_HISTORY - 1)] = y * std::polar (1.0, -theta);
+      theta = fmod (theta + 2.0 * PI * offset / bank->chanRate, 2.0 * PI);
+      n++;
+
+      // Bit strobe (t) when the late sample (a quarter bit after) has arrived. The PSK31 envelope peaks mid bit
+      // (it goes to zero between bits at a phase reversal) so the strobe moves towards the stronger of early/late
+      if (t + sps / 4.0 > n - 1.0) return;
+      c = At (t);
+      e = At (t - sps / 4.0);
+      l = At (t + sps / 4.0);
+      pe = std::norm (e);
+      pl = std::norm (l);
+      err = (pl - pe) / (pl + pe + 1e-9);
+      t += sps + BB_TIMING_GAIN * err;
+
+      // Differential decision. No phase reversal is a 1 bit
+      d = c * std::conj (last);
+      last = c;
+
+      // AFC. Squaring removes the modulation and leaves twice the rotation per bit from the frequency error
+      offset += BB_AFC_GAIN * std::arg (d * d) / 2.0 * PSK31_BAUD / (2.0 * PI);
+      offset = constrain (offset, -BB_AFC_RANGE, BB_AFC_RANGE);
+
+      ch = VaricodeNextNode (&node, d.real () > 0);
+      if (bits < BB_SETTLE_BITS) bits++;
+      else if (show && ch && ch != VARICODE_INVALID) {
+        text += (char)ch;
+        if (text.size () > BB_TEXT_KEEP) text.erase (0, text.size () - BB_TEXT_KEEP);
+      }
+    }
+    const Filterbank *bank;
+    int bin;                            // Filterbank bin of the channel
+    double offset, theta;               // Fine tuning from the bin (Hz, AFC) and NCO phase
+    double sps, t;                      // Channel samples per bit and next bit strobe (channel samples)
+    unsigned long n, bits;              // Channel samples and bits received
+    Cpx hist[BB_HISTORY], last;         // Recent samples and the last bit strobe
+    unsigned char node;                 // Varicode trie node
+};
+
+// Worker threads. Run() calls job(0) to job(jobs - 1) spread over the workers and returns when all are done
+class WorkerPool {
+  public:
+    WorkerPool (int count) : cpu (count, 0.0) {
+      generation = 0;
+      quit = false;
+      for (int i = 0; i < count; i++) threads.push_back (std::thread (&WorkerPool::Worker, this, i));
+    }
+    ~WorkerPool () {
+      {
+        std::lock_guard<std::mutex> lock (m);
+        quit = true;
+      }
+      start.notify_all ();
+      for (size_t i = 0; i < threads.size (); i++) threads[i].join ();
+    }
+    void Run (int jobs, const std::function<void (int)> &job) {
+      std::unique_lock<std::mutex> lock (m);
+      work = &job;
+      count = jobs;
+      next = 0;
+      running = threads.size ();
+      generation++;
+      start.notify_all ();
+      done.wait (lock, [this] { return running == 0; });
+    }
+    double CPUSeconds (void) const { double s = 0; for (size_t i = 0; i < cpu.size (); i++) s += cpu[i]; return s; }
+    size_t Size (void) const { return threads.size (); }
+  private:
+    void Worker (int id) {
+      unsigned long seen = 0;
+      double t0;
+      int j;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock (m);
+          start.wait (lock, [&] { return quit || generation != seen; });
+          if (quit) return;
+          seen = generation;
+        }
+        t0 = ThreadSeconds ();
+        while ((j = next++) < count) (*work) (j);
+        cpu[id] += ThreadSeconds () - t0;
+        {
+          std::lock_guard<std::mutex> lock (m);
+          if (--running == 0) done.notify_one ();
+        }
+      }
+    }
+    std::vector<std::thread> threads;
+    std::vector<double> cpu;            // CPU seconds of each worker
+    std::mutex m;
+    std::condition_variable start, done;
+    const std::function<void (int)> *work;
+    std::atomic<int> next;
+    int count;
+    size_t running;
+    unsigned long generation;
+    bool quit;
+};
+
+typedef struct {
+  double freq, level;
+} Carrier_def;
+
+// Carrier detection from the band spectra of a batch. Power of each bin is the Hann windowed spectrum (formed from
+// the FFT bins, -1/4 +1/2 -1/4) so that a strong signal does not leak into the bins far from it
+class CarrierFinder {
+  public:
+    CarrierFinder (const Filterbank *fb) : bank (fb), avg (fb->band.n / 2, 0.0) { batches = 0; }
+    std::vector<Carrier_def> Find (const std::vector<std::vector<Cpx> > &spectra) {
+      std::vector<Carrier_def> found;
+      std::vector<double> p (avg.size (), 0.0), sorted;
+      int k, j, lo = (int)(BB_MIN_HZ / bank->binHz), hi = (int)(BB_MAX_HZ / bank->binHz), peak = (int)(BB_PEAK_HZ / bank->binHz);
+      size_t b;
+      double floor, w, sum, c;
+      Carrier_def carrier;
+
+      for (b = 0; b < spectra.size (); b++) {
+        for (k = 1; k < (int)p.size () - 1; k++) p[k] += std::norm (0.5 * spectra[b][k] - 0.25 * (spectra[b][k - 1] + spectra[b][k + 1]));
+      }
+      for (k = 0; k < (int)p.size (); k++) avg[k] = batches ? avg[k] + BB_AVERAGE * (p[k] / spectra.size () - avg[k]) : p[k] / spectra.size ();
+      batches++;
+
+      sorted.assign (avg.begin () + lo, avg.begin () + hi);
+      std::nth_element (sorted.begin (), sorted.begin () + sorted.size () / 2, sorted.end ());
+      floor = sorted[sorted.size () / 2] + 1e-9;
+
+      for (k = lo + peak; k < hi - peak; k++) {
+        if (avg[k] < floor * pow (10.0, BB_DETECT_DB / 10.0)) continue;
+        for (j = -peak; j <= peak && avg[k + j] <= avg[k]; j++) ;
+        if (j <= peak) continue;                                // Not the strongest nearby
+
+        // Centroid of the power over the floor. PSK31 idle is two tones 31 Hz apart so the peak is not the centre
+        c = k;
+        for (int pass = 0; pass < 2; pass++) {
+          sum = w = 0;
+          for (j = (int)lround (c) - peak; j <= (int)lround (c) + peak; j++) {
+            if (j < 0 || j >= (int)avg.size () || avg[j] <= floor) continue;
+            w += (avg[j] - floor) * j;
+            sum += avg[j] - floor;
+          }
+          c = w / sum;
+        }
+        carrier.freq = c * bank->binHz;
+        carrier.level = 10.0 * log10 (avg[k] / floor);
+        found.push_back (carrier);
+      }
+      return found;
+    }
+  private:
+    const Filterbank *bank;
+    std::vector<double> avg;
+    unsigned long batches;
+};
+
+// Audio source. 16 bit WAV (first channel) or raw 16 bit mono
+class AudioInput {
+  public:
+    AudioInput (FILE *file, double rawRate) {
+      unsigned char h[12], c[8];
+      unsigned long size;
+      unsigned int fmt = 0;
+      f = file;
+      channels = 1;
+      rate = rawRate;
+      pending = 0;
+      if (fread (h, 1, 12, f) != 12) { pending = 0; return; }
+      if (memcmp (h, "RIFF", 4) || memcmp (h + 8, "WAVE", 4)) {
+        memcpy (head, h, 12);                                   // Raw audio. The 12 bytes are the first 6 samples
+        pending = 12;
+        return;
+      }
+      while (fread (c, 1, 8, f) == 8) {
+        size = c[4] | c[5] << 8 | c[6] << 16 | (unsigned long)c[7] << 24;
+        if (!memcmp (c, "data", 4)) break;
+        std::vector<unsigned char> chunk (size + (size & 1));
+        if (fread (&chunk[0], 1, chunk.size (), f) != chunk.size ()) break;
+        if (!memcmp (c, "fmt ", 4) && size >= 16) {
+          fmt = chunk[0] | chunk[1] << 8;
+          channels = chunk[2] | chunk[3] << 8;
+          rate = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | (unsigned long)chunk[7] << 24;
+          if (fmt != 1 || (chunk[14] | chunk[15] << 8) != 16) fprintf (stderr, "Only 16 bit PCM WAV is supported\n");
+        }
+      }
+    }
+    // Read up to count samples. Returns the number read (0 at end)
+    size_t Read (double *x, size_t count) {
+      unsigned char s[2];
+      size_t i;
+      int c;
+      for (i = 0; i < count; i++) {
+        for (c = 0; c < channels; c++) {
+          if (pending) { s[0] = head[12 - pending]; s[1] = head[13 - pending]; pending -= 2; }
+          else if (fread (s, 1, 2, f) != 2) return i;
+          if (!c) x[i] = (short)(s[0] | s[1] << 8);
+        }
+      }
+      return i;
+    }
+    double rate;
+  private:
+    FILE *f;
+    int channels, pending;
+    unsigned char head[12];
+};
+
+// Test band. PSK31 signals (text as sent by the sketch: varicode then "00") in receiver noise
+class TestBand {
+  public:
+    TestBand (void) : noise (3, BB_TEST_NOISE_RMS) {
+      static const double freqs[BB_TEST_SIGNALS] = {452.3, 611.8, 797.1, 1000.0, 1243.6, 1517.4, 1862.9, 2304.2};
+      static const int snrs[BB_TEST_SIGNALS] = {-6, 20, 0, 10, -3, 3, 15, 6};
+      char line[80];
+      int i, bits;
+      unsigned int code;
+      const char *s;
+
+      n = 0;
+      for (i = 0; i < BB_TEST_SIGNALS; i++) {
+        Signal_def sig;
+        sig.freq = freqs[i];
+        sig.snr = snrs[i];
+        sig.amp = BB_TEST_NOISE_RMS * sqrt (2.0 * pow (10.0, snrs[i] / 10.0));   // Tone power A^2/2 to noise power
+        sig.phase = 2.0 * PI * noise.rng.Uniform ();
+        sig.start = (unsigned long)(i * 0.7 * F_SAMPLE);                         // Staggered starts
+        sig.bits.assign (32, 0);                                                 // Idle (reversals) for bit sync
+        while (sig.bits.size () < (BB_TEST_SECONDS + 1) * PSK31_BAUD) {
+          snprintf (line, sizeof(line), "Signal %d at %d dB: The quick brown fox jumps over the lazy dog 0123456789. ", i + 1, snrs[i]);
+          for (s = line; *s; s++) {
+            code = LookupVaricode (*s);
+            bits = LookupVaricodeLength (*s);
+            while (bits--) { sig.bits.push_back (code & 1); code >>= 1; }
+            sig.bits.push_back (0);
+            sig.bits.push_back (0);
+            sig.text += *s;
+          }
+        }
+        signals.push_back (sig);
+      }
+    }
+    double Sample (void) {
+      double v = noise.Sample (), spb = F_SAMPLE / PSK31_BAUD, pos, env;
+      unsigned long b;
+      int sign;
+      for (size_t i = 0; i < signals.size (); i++) {
+        Signal_def &sig = signals[i];
+        sig.phase += 2.0 * PI * sig.freq / F_SAMPLE;
+        if (n < sig.start) continue;
+        pos = (n - sig.start) / spb;
+        b = (unsigned long)pos;
+        if (b >= sig.bits.size ()) continue;
+        // Sign is the phase before bit b (one reversal per 0 bit). A 0 bit reverses with a cosine envelope
+        while (sig.signBits < b) { if (!sig.bits[sig.signBits]) sig.sign = -sig.sign; sig.signBits++; }
+        sign = sig.sign;
+        env = sig.bits[b] ? sign : sign * cos (PI * (pos - b));
+        v += sig.amp * env * cos (sig.phase);
+      }
+      n++;
+      return v;
+    }
+    struct Signal_def {
+      double freq, amp, phase;
+      int snr, sign = 1;
+      unsigned long start, signBits = 0;
+      std::vector<unsigned char> bits;
+      std::string text;                 // Text sent (whole repeats of the line, may run past the end of the test)
+    };
+    std::vector<Signal_def> signals;
+  private:
+    HostReceiverNoise noise;
+    unsigned long n;
+};
+
+// Audio source for the browser. A file or pipe, or the test band
+class Source {
+  public:
+    Source (AudioInput *in, TestBand *band, unsigned long samples) { input = in; test = band; left = samples; }
+    size_t Read (double *x, size_t count) {
+      size_t i;
+      if (input) return input->Read (x, count);
+      for (i = 0; i < count && left; i++, left--) x[i] = test->Sample ();
+      return i;
+    }
+  private:
+    AudioInput *input;
+    TestBand *test;
+    unsigned long left;
+};
+
+typedef struct {
+  double audioSeconds, channelSeconds, channelCPU, bankCPU, wall;
+  size_t threads;
+} Stats_def;
+
+class BandBrowser {
+  public:
+    BandBrowser (double rate, int threads, int maxChannels, int fixedChannels, bool view) :
+      bank (rate), finder (&bank), pool (threads), channels (fixedChannels ? fixedChannels : maxChannels) {
+      live = view;
+      fixed = fixedChannels;
+      for (size_t i = 0; i < channels.size (); i++) {
+        channels[i].open = false;
+        if (fixed) channels[i].Open (&bank, BB_MIN_HZ + (BB_MAX_HZ - BB_MIN_HZ) * (i + 0.5) / fixed, 0);
+      }
+    }
+    Stats_def Run (Source *src) {
+      std::vector<double> buff (bank.band.n, 0.0);
+      std::vector<std::vector<Cpx> > spectra;
+      std::vector<Cpx> X (bank.band.n);
+      unsigned long hop = 0, batch = 0, samples = 0, quiet = (unsigned long)ceil (BB_QUIET_SECONDS * bank.fs / (bank.hop * BB_BATCH_HOPS));
+      double t0, wall = WallSeconds (), batchSeconds;
+      size_t got, open, i;
+      Stats_def st;
+      std::function<void (int)> job;
+
+      memset (&st, 0, sizeof(st));
+      st.threads = pool.Size ();
+      do {
+        // Band FFTs of a batch (main thread). Each hop shifts in half the FFT of new samples
+        spectra.clear ();
+        got = bank.hop;
+        while (spectra.size () < BB_BATCH_HOPS && got == (size_t)bank.hop) {
+          memmove (&buff[0], &buff[bank.hop], bank.hop * sizeof(double));
+          got = src->Read (&buff[bank.hop], bank.hop);
+          if (!got) break;
+          t0 = ThreadSeconds ();
+          std::fill (buff.begin () + bank.hop + got, buff.end (), 0.0);
+          samples += got;
+          for (i = 0; i < (size_t)bank.band.n; i++) X[i] = buff[i];
+          bank.band.Run (&X[0], false);
+          spectra.push_back (X);
+          st.bankCPU += ThreadSeconds () - t0;
+        }
+        if (spectra.empty ()) break;
+        t0 = ThreadSeconds ();
+        if (!fixed) UpdateChannels (finder.Find (spectra), batch);
+        st.bankCPU += ThreadSeconds () - t0;
+
+        // Channels of the batch on the workers
+        job = [&] (int c) {
+          if (channels[c].open) channels[c].Decode (spectra, hop, fixed || batch - channels[c].seen < quiet);
+        };
+        pool.Run (channels.size (), job);
+
+        batchSeconds = spectra.size () * bank.hop / bank.fs;
+        for (open = 0, i = 0; i < channels.size (); i++) open += channels[i].open;
+        st.channelSeconds += open * batchSeconds;
+        hop += spectra.size ();
+        batch++;
+        if (live) View (samples);
+      } while (got == (size_t)bank.hop);
+
+      st.audioSeconds = samples / bank.fs;
+      st.channelCPU = pool.CPUSeconds ();
+      st.wall = WallSeconds () - wall;
+      return st;
+    }
+    void View (unsigned long samples) {
+      size_t i, j;
+      std::string s;
+      printf ("\033[H\033[J%.0f s  %d Hz bins  %.0f Hz channel rate\n", samples / bank.fs, (int)lround (bank.binHz), bank.chanRate);
+      for (i = 0; i < channels.size (); i++) {
+        if (!channels[i].open) continue;
+        s = channels[i].text.size () > BB_VIEW_CHARS ? channels[i].text.substr (channels[i].text.size () - BB_VIEW_CHARS) : channels[i].text;
+        for (j = 0; j < s.size (); j++) if ((unsigned char)s[j] < ' ') s[j] = ' ';
+        printf ("%2u %7.1f Hz %5.1f dB | %s\n", (unsigned int)i + 1, channels[i].freq, channels[i].level, s.c_str ());
+      }
+      fflush (stdout);
+    }
+    Filterbank bank;
+    CarrierFinder finder;
+    WorkerPool pool;
+    std::vector<PSKChannel> channels;
+    std::vector<PSKChannel> closed;     // Channels that have closed (for the final text)
+  private:
+    void UpdateChannels (const std::vector<Carrier_def> &found, unsigned long batch) {
+      unsigned long drop = (unsigned long)ceil (BB_DROP_SECONDS * bank.fs / (bank.hop * BB_BATCH_HOPS));
+      size_t i, j;
+
+      for (i = 0; i < found.size (); i++) {
+        for (j = 0; j < channels.size (); j++) {
+          if (channels[j].open && fabs (channels[j].freq - found[i].freq) < BB_SPACING_HZ) break;
+        }
+        if (j < channels.size ()) {
+          channels[j].seen = batch;
+          channels[j].level = found[i].level;
+          continue;
+        }
+        for (j = 0; j < channels.size () && channels[j].open; j++) ;
+        if (j == channels.size ()) continue;                    // All channels in use
+        channels[j].Open (&bank, found[i].freq, batch);
+        channels[j].level = found[i].level;
+      }
+      for (j = 0; j < channels.size (); j++) {
+        if (channels[j].open && batch - channels[j].seen > drop) {
+          closed.push_back (channels[j]);
+          channels[j].open = false;
+        }
+      }
+    }
+    bool live;
+    int fixed;
+};
+
+static void Benchmark (const char *name, const Stats_def &st)
+{
+  printf ("%s: %.0f s of audio in %.2f s on %u worker threads. Filterbank %.3f%% of a core. ", name, st.audioSeconds,
+          st.wall, (unsigned int)st.threads, 100.0 * st.bankCPU / st.audioSeconds);
+  if (st.channelCPU > 0) printf ("%.0f channels per core\n", st.channelSeconds / st.channelCPU);
+  else printf ("no channel time measured\n");
+}
+
+static unsigned int EditDistance (const std::string &sent, const std::string &rx)
+{
+// Edit distance of rx to the best matching part of sent (the start and end of sent are free: the channel opens
+// after the signal starts and the test can end part way through a character)
+  std::vector<unsigned int> d (rx.size () + 1), p (rx.size () + 1);
+  unsigned int best;
+  size_t i, j;
+
+  for (j = 0; j <= rx.size (); j++) p[j] = j;
+  best = p[rx.size ()];
+  for (i = 1; i <= sent.size (); i++) {
+    d[0] = 0;
+    for (j = 1; j <= rx.size (); j++) {
+      d[j] = min (min (p[j] + 1, d[j - 1] + 1), p[j - 1] + (sent[i - 1] != rx[j - 1]));
+    }
+    p.swap (d);
+    if (p[rx.size ()] < best) best = p[rx.size ()];
+  }
+  return best;
+}
+
+static int SelfTest (int threads)
+{
+  TestBand band;
+  Source src (NULL, &band, (unsigned long)(BB_TEST_SECONDS * F_SAMPLE));
+  BandBrowser bb (F_SAMPLE, threads, BB_MAX_CHANNELS, 0, false);
+  Stats_def st;
+  size_t i, j, matched = 0;
+  double cer, expect;
+  int fail = 0;
+
+  st = bb.Run (&src);
+  printf ("Band of %d PSK31 signals, %d s\n", BB_TEST_SIGNALS, BB_TEST_SECONDS);
+  for (i = 0; i < band.signals.size (); i++) {
+    TestBand::Signal_def &sig = band.signals[i];
+    for (j = 0; j < bb.channels.size (); j++) {
+      if (bb.channels[j].open && fabs (bb.channels[j].freq - sig.freq) < BB_SPACING_HZ) break;
+    }
+    if (j == bb.channels.size ()) {
+      printf ("%7.1f Hz %3d dB: no channel  FAIL\n", sig.freq, sig.snr);
+      fail = 1;
+      continue;
+    }
+    matched++;
+    PSKChannel &ch = bb.channels[j];
+    cer = ch.text.empty () ? 100.0 : 100.0 * EditDistance (sig.text, ch.text) / ch.text.size ();
+    expect = (BB_TEST_SECONDS - sig.start / (double)F_SAMPLE) * PSK31_BAUD / (sig.bits.size () / (double)sig.text.size ());
+    printf ("%7.1f Hz %3d dB: channel %7.1f Hz %5.1f dB, %4u chars CER %.2f%%", sig.freq, sig.snr, ch.freq, ch.level,
+            (unsigned int)ch.text.size (), cer);
+    if (fabs (ch.freq - sig.freq) > BB_TEST_FREQ_TOL || cer > BB_TEST_MAX_CER || ch.text.size () < expect * 0.9) {
+      printf ("  FAIL\n  %s\n", ch.text.substr (0, 160).c_str ());
+      fail = 1;
+    } else printf ("  ok\n");
+  }
+  for (j = 0, i = 0; j < bb.channels.size (); j++) i += bb.channels[j].open;
+  i += bb.closed.size ();
+  if (i != matched) {
+    printf ("FAIL: %u channels opened on noise\n", (unsigned int)(i - matched));
+    fail = 1;
+  }
+  Benchmark ("Decode", st);
+  return fail;
+}
+
+static int Bench (int threads)
+{
+  TestBand band;
+  Source src (NULL, &band, (unsigned long)(BB_TEST_SECONDS * F_SAMPLE));
+  BandBrowser bb (F_SAMPLE, threads, 0, BB_BENCH_CHANNELS, false);
+  char name[40];
+
+  snprintf (name, sizeof(name), "Benchmark %d channels", BB_BENCH_CHANNELS);
+  Benchmark (name, bb.Run (&src));
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  int threads = max (1, (int)std::thread::hardware_concurrency ()), maxChannels = BB_MAX_CHANNELS, fixed = 0, opt;
+  double rate = F_SAMPLE;
+  bool quiet = false;
+  FILE *f;
+  size_t i;
+  int fail;
+
+  while ((opt = getopt (argc, argv, "t:n:b:r:q")) != -1) {
+    switch (opt) {
+      case 't': threads = max (1, atoi (optarg)); break;
+      case 'n': maxChannels = max (1, atoi (optarg)); break;
+      case 'b': fixed = max (1, atoi (optarg)); break;
+      case 'r': rate = atof (optarg); break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf (stderr, "BandBrowser [-t threads] [-n channels] [-b channels] [-r rate] [-q] file|-\n");
+        return 2;
+    }
+  }
+
+  // No file. Test band then benchmark
+  if (optind >= argc) {
+    fail = SelfTest (threads);
+    fail |= Bench (threads);
+    printf (fail ? "FAIL\n" : "PASS\n");
+    return fail;
+  }
+
+  f = strcmp (argv[optind], "-") ? fopen (argv[optind], "rb") : stdin;
+  if (!f) {
+    perror (argv[optind]);
+    return 2;
+  }
+  AudioInput in (f, rate);
+  Source src (&in, NULL, 0);
+  BandBrowser bb (in.rate, threads, maxChannels, fixed, !quiet && isatty (fileno (stdout)));
+  Stats_def st = bb.Run (&src);
+
+  if (!quiet && !isatty (fileno (stdout))) {
+    for (i = 0; i < bb.closed.size (); i++) printf ("%7.1f Hz (closed): %s\n", bb.closed[i].freq, bb.closed[i].text.c_str ());
+    for (i = 0; i < bb.channels.size (); i++) {
+      if (bb.channels[i].open) printf ("%7.1f Hz: %s\n", bb.channels[i].freq, bb.channels[i].text.c_str ());
+    }
+  }
+  Benchmark ("Decode", st);
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+Host test for the fractional baud clock (Timer.cpp). SetBaudClock() then NextBaudCount() once per symbol as the
+Timer 3/4 ISRs do for PSK31 (31.25 baud) and the RTTY baud rates (45.45 baud is 5500.55 ticks per symbol).
+The CTC periods (compare value + 1) are accumulated and compared with the exact symbol time after every symbol.
+Checks that each period is a whole or one tick longer, that the accumulated error never reaches one tick, that
+the accumulator fits 16 bits (unsigned int on the AVR) and that the rate over a long run is exact
+Exits with 1 on any failure
+*/
+
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+
+#define TEST_SYMBOLS 10000000UL         // ~2.5 days at 45.45 baud
+
+static int Run (unsigned int baud)
+{
+// Clock TEST_SYMBOLS symbols at baud (x100). Returns 1 on failure
+  BaudClock_def bc;
+  unsigned long n, period, ticks = 0;
+  long long err, maxErr = 0, exact;
+  int fail = 0;
+
+  SetBaudClock (&bc, baud);
+  for (n = 1; n <= TEST_SYMBOLS; n++) {
+    period = NextBaudCount (&bc) + TIMER_CTC_ADJUST;
+    ticks += period;
+    if (period != bc.count && period != bc.count + 1UL) fail = 1;
+    if (bc.acc >= bc.baud || bc.acc > 0xFFFF) fail = 1;
+
+    // Error in ticks x baud. n symbols take n x TIMER_64_HZ x 100 / baud ticks
+    exact = (long long)n * TIMER_64_HZ * 100;
+    err = (long long)ticks * baud - exact;
+    if (err < 0) err = -err;
+    if (err > maxErr) maxErr = err;
+  }
+  if (maxErr >= baud || bc.symbols != TEST_SYMBOLS || bc.count > 0xFFFF) fail = 1;
+
+  printf ("%2u.%02u baud: %u + %u/%u ticks per symbol, max error %.3f ticks, rate error %.4f ppm  %s\n",
+          baud / 100, baud % 100, bc.count, bc.rem, bc.baud, (double)maxErr / baud,
+          1e6 * (double)err / (double)exact, fail ? "FAIL" : "ok");
+  return fail;
+}
+
+int main (void)
+{
+  int fail = 0;
+
+  fail |= Run (PSK_BAUD_X100);
+  fail |= Run (RTTY_SLOWEST_BAUD_X100);
+  fail |= Run (5000);
+  fail |= Run (RTTY_FASTEST_BAUD_X100);
+
+  printf (fail ? "FAIL\n" : "PASS\n");
+  return fail;
+}
@@ -0,0 +1,127 @@
+/*
+Host test for the push button and encoder button debouncer. Pin waveforms (one BTN_xxx mask per Timer 1 poll)
+with contact bounce, glitches, long holds and overlapping buttons are fed to DebounceButtons() as the Timer 1 ISR
+does and the queued events (PopButtonEvent()) are checked against the expected poll and event.
+Also checks queue overflow and that ProcessButtonEvents() latches pbenable and steps frequency_mult
+Exits with 1 on any difference
+*/
+
+#include <vector>                  // Before Arduino.h (min/max macros)
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+
+typedef struct {
+  unsigned char active;                 // BTN_xxx pushed
+  unsigned int polls;
+} Segment_def;
+
+typedef struct {
+  unsigned int poll;
+  unsigned char event;
+} Event_def;
+
+static int Run (const char *name, const std::vector<Segment_def> &wave, const std::vector<Event_def> &expect)
+{
+// Feed the waveform one poll at a time and compare the events. Returns 1 if they differ
+  std::vector<Event_def> got;
+  Event_def e;
+  unsigned int poll = 0;
+  size_t i;
+  int fail = 0;
+
+  ResetButtons ();
+  for (i = 0; i < wave.size (); i++) {
+    for (unsigned int n = 0; n < wave[i].polls; n++, poll++) {
+      DebounceButtons (&buttons, wave[i].active);
+      e.poll = poll;
+      while ((e.event = PopButtonEvent ())) got.push_back (e);
+    }
+  }
+
+  if (got.size () != expect.size ()) fail = 1;
+  for (i = 0; i < got.size () && !fail; i++) {
+    if (got[i].poll != expect[i].poll || got[i].event != expect[i].event) fail = 1;
+  }
+  printf ("%-28s %s\n", name, fail ? "FAIL" : "ok");
+  if (fail) {
+    for (i = 0; i < got.size (); i++) printf ("  got poll %u event %02X\n", got[i].poll, got[i].event);
+    for (i = 0; i < expect.size (); i++) printf ("  expected poll %u event %02X\n", expect[i].poll, expect[i].event);
+  }
+  return fail;
+}
+
+static int QueueOverflow (void)
+{
+// Events are not popped: the queue holds BTN_QUEUE_SIZE-1 and the rest are dropped and counted
+  unsigned int i, n;
+  int fail;
+
+  ResetButtons ();
+  for (i = 0; i < BTN_QUEUE_SIZE; i++) {
+    for (n = 0; n < BTN_DEBOUNCE_POLLS; n++) DebounceButtons (&buttons, BTN_PB1);
+    for (n = 0; n < BTN_DEBOUNCE_POLLS; n++) DebounceButtons (&buttons, 0);
+  }
+  n = 0;
+  while (PopButtonEvent ()) n++;
+  fail = n != BTN_QUEUE_SIZE - 1 || btnEvents != BTN_QUEUE_SIZE - 1 || btnOverflow != BTN_QUEUE_SIZE + 1;
+  printf ("%-28s %s\n", "Queue overflow", fail ? "FAIL" : "ok");
+  if (fail) printf ("  %u events popped, btnEvents %lu btnOverflow %lu\n", n, btnEvents, btnOverflow);
+  return fail;
+}
+
+static int Process (void)
+{
+// Push button press is latched in pbenable and encoder press steps frequency_mult
+  unsigned int n;
+  int fail;
+
+  ResetButtons ();
+  frequency_mult = MINIMUM_FREQUENCY_MULTIPLIER;
+  for (n = 0; n < BTN_DEBOUNCE_POLLS; n++) DebounceButtons (&buttons, BTN_PB2 | BTN_ENC);
+  for (n = 0; n < BTN_DEBOUNCE_POLLS; n++) DebounceButtons (&buttons, 0);
+  ProcessButtonEvents ();
+  fail = pbenable != BTN_PB2 || frequency_mult != MINIMUM_FREQUENCY_MULTIPLIER * 10 || PopButtonEvent ();
+  printf ("%-28s %s\n", "ProcessButtonEvents", fail ? "FAIL" : "ok");
+  if (fail) printf ("  pbenable %02X frequency_mult %lu\n", pbenable, (unsigned long)frequency_mult);
+  return fail;
+}
+
+int main (void)
+{
+  const unsigned int D = BTN_DEBOUNCE_POLLS, L = BTN_LONG_POLLS;
+  int fail = 0;
+
+  // State changes on the BTN_DEBOUNCE_POLLS poll at the new level
+  fail |= Run ("Clean press/release", {{BTN_PB1, D}, {0, D}},
+    {{D - 1, BTN_EVENT_PRESS | BTN_PB1}, {2 * D - 1, BTN_EVENT_RELEASE | BTN_PB1}});
+
+  // Bounce restarts the count. Press at poll 7 + 7, release bounces at 19
+  fail |= Run ("Bouncy press/release", {{BTN_PB2, 1}, {0, 1}, {BTN_PB2, 1}, {0, 1}, {BTN_PB2, 2}, {0, 1},
+    {BTN_PB2, 10}, {0, 2}, {BTN_PB2, 1}, {0, 10}},
+    {{7 + D - 1, BTN_EVENT_PRESS | BTN_PB2}, {20 + D - 1, BTN_EVENT_RELEASE | BTN_PB2}});
+
+  fail |= Run ("Glitch shorter than debounce", {{BTN_PB3, D - 1}, {0, D}, {BTN_PB3, 1}, {0, D}}, {});
+
+  // One long press event however long the button is held
+  fail |= Run ("Encoder long press", {{BTN_ENC, D + L + 100}, {0, D}},
+    {{D - 1, BTN_EVENT_PRESS | BTN_ENC}, {D - 1 + L, BTN_EVENT_LONG | BTN_ENC},
+     {2 * D + L + 99, BTN_EVENT_RELEASE | BTN_ENC}});
+
+  // Long press is timed from the debounced press to the debounced release (both are D - 1 polls late)
+  fail |= Run ("Released before long press", {{BTN_ENC, L - 1}, {0, D}},
+    {{D - 1, BTN_EVENT_PRESS | BTN_ENC}, {D + L - 2, BTN_EVENT_RELEASE | BTN_ENC}});
+
+  // Buttons are independent. PB1 polls 0-11, PB3 polls 4-19
+  fail |= Run ("Overlapping buttons", {{BTN_PB1, 4}, {BTN_PB1 | BTN_PB3, 8}, {BTN_PB3, 8}, {0, D}},
+    {{D - 1, BTN_EVENT_PRESS | BTN_PB1}, {4 + D - 1, BTN_EVENT_PRESS | BTN_PB3},
+     {12 + D - 1, BTN_EVENT_RELEASE | BTN_PB1}, {20 + D - 1, BTN_EVENT_RELEASE | BTN_PB3}});
+
+  fail |= QueueOverflow ();
+  fail |= Process ();
+
+  printf (fail ? "FAIL\n" : "PASS\n");
+  return fail;
+}
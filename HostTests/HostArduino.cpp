@@ -0,0 +1,182 @@
+/*
+Host (PC) replacements for the Arduino core, AVR registers and the sketch routines in the .ino file so that
+parts of the sketch can be linked and exercised by the host tests. Time only moves when a test calls
+delay() or HostAdvanceMicros(). The .ino routines are weak so that a test can replace them
+*/
+
+#define HOST_DEFINE_REGISTERS
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+
+HardwareSerial Serial, Serial1, Serial2;
+SPIClass SPI;
+
+static unsigned long hostMicros;
+static uint8_t hostEEPROM[4096];
+
+void HostAdvanceMicros (unsigned long us) { hostMicros += us; }
+
+unsigned long millis (void) { return hostMicros / 1000; }
+unsigned long micros (void) { return hostMicros; }
+void delay (unsigned long ms) { hostMicros += ms * 1000; }
+void delayMicroseconds (unsigned int us) { hostMicros += us; }
+
+void pinMode (uint8_t, uint8_t) {}
+void digitalWrite (uint8_t, uint8_t) {}
+int digitalRead (uint8_t) { return HIGH; }
+void tone (uint8_t, unsigned int) {}
+void noTone (uint8_t) {}
+long random (long lo, long hi) { return lo + rand() % (hi - lo); }
+
+void set_sleep_mode (int) {}
+void sleep_mode (void) {}
+void sleep_enable (void) {}
+void sleep_disable (void) {}
+void sleep_cpu (void) {}
+
+uint8_t eeprom_read_byte (const uint8_t *a) { return hostEEPROM[(uintptr_t)a]; }
+void eeprom_write_byte (uint8_t *a, uint8_t d) { hostEEPROM[(uintptr_t)a] = d; }
+void eeprom_update_byte (uint8_t *a, uint8_t d) { hostEEPROM[(uintptr_t)a] = d; }
+uint16_t eeprom_read_word (const uint16_t *a) { uint16_t d; memcpy (&d, &hostEEPROM[(uintptr_t)a], 2); return d; }
+void eeprom_write_word (uint16_t *a, uint16_t d) { memcpy (&hostEEPROM[(uintptr_t)a], &d, 2); }
+uint32_t eeprom_read_dword (const uint32_t *a) { uint32_t d; memcpy (&d, &hostEEPROM[(uintptr_t)a], 4); return d; }
+void eeprom_write_dword (uint32_t *a, uint32_t d) { memcpy (&hostEEPROM[(uintptr_t)a], &d, 4); }
+void eeprom_update_dword (uint32_t *a, uint32_t d) { memcpy (&hostEEPROM[(uintptr_t)a], &d, 4); }
+void eeprom_read_block (void *d, const void *a, size_t n) { memcpy (d, &hostEEPROM[(uintptr_t)a], n); }
+void eeprom_write_block (const void *s, void *a, size_t n) { memcpy (&hostEEPROM[(uintptr_t)a], s, n); }
+void eeprom_update_block (const void *s, void *a, size_t n) { memcpy (&hostEEPROM[(uintptr_t)a], s, n); }
+
+/*
+I2C device model. TWCR writes run the TWI state machine against one device (a Si5351 at SI5351_ADDRESS) and each
+START, byte and STOP completes as soon as TWCR is written: TWINT is set straight away (except after a STOP) with the
+status in TWSR. The TWI interupt (TWI_vect) is taken while TWINT, TWIE and the SREG I bit are set, with the I bit
+cleared in the ISR as on the AVR (no nesting). So queued writes are sent when interupts are enabled and wait for
+polling (or sei()) when they are not
+*/
+#define HOST_TWI_START        0x08
+#define HOST_TWI_START_RPT    0x10
+#define HOST_TWI_SLA_W_ACK    0x18
+#define HOST_TWI_SLA_W_NACK   0x20
+#define HOST_TWI_DATA_ACK     0x28
+#define HOST_TWI_DATA_NACK    0x30
+#define HOST_TWI_SLA_R_ACK    0x40
+#define HOST_TWI_SLA_R_NACK   0x48
+#define HOST_TWI_READ_ACK     0x50
+#define HOST_TWI_READ_NACK    0x58
+
+enum { TWI_IDLE, TWI_STARTED, TWI_REGISTER, TWI_WRITE, TWI_READ, TWI_NACKED };
+
+HostTWCR TWCR;
+HostSREG SREG;
+HostI2CDevice_def hostI2C;
+static uint8_t twiState, twiInISR;
+extern "C" void TWI_vect (void);
+
+void HostI2CReset (void)
+{
+  memset (&hostI2C, 0, sizeof(hostI2C));
+  hostI2C.address = SI5351_ADDRESS;
+  twiState = TWI_IDLE;
+  TWCR.value = 0;
+}
+
+static void HostTWIInterupt (void)
+{
+  if (twiInISR) return;                 // Taken again when the ISR returns
+  twiInISR = 1;
+  while ((SREG.value & (1 << SREG_I)) && (TWCR.value & (1 << TWIE)) && (TWCR.value & (1 << TWINT))) {
+    SREG.value &= ~(1 << SREG_I);
+    TWI_vect ();
+    SREG.value |= (1 << SREG_I);        // RETI
+  }
+  twiInISR = 0;
+}
+
+static uint8_t HostTWIStep (uint8_t v)
+{
+// One TWI operation. Returns the status or 0 if TWINT is not set (STOP)
+  if (v & (1 << TWSTO)) {
+    twiState = TWI_IDLE;
+    if (!(v & (1 << TWSTA))) return 0;
+  }
+  if (v & (1 << TWSTA)) {
+    v = twiState == TWI_IDLE ? HOST_TWI_START : HOST_TWI_START_RPT;
+    twiState = TWI_STARTED;
+    return v;
+  }
+
+  switch (twiState) {
+    case TWI_STARTED:                   // Address
+      if (hostI2C.nack || (TWDR >> 1) != hostI2C.address) {
+        twiState = TWI_NACKED;
+        return (TWDR & 1) ? HOST_TWI_SLA_R_NACK : HOST_TWI_SLA_W_NACK;
+      }
+      if (TWDR & 1) {
+        twiState = TWI_READ;
+        return HOST_TWI_SLA_R_ACK;
+      }
+      twiState = TWI_REGISTER;
+      hostI2C.transactions++;
+      return HOST_TWI_SLA_W_ACK;
+
+    case TWI_REGISTER:
+      hostI2C.reg = TWDR;
+      twiState = TWI_WRITE;
+      return HOST_TWI_DATA_ACK;
+
+    case TWI_WRITE:
+      hostI2C.regs[hostI2C.reg++] = TWDR;
+      hostI2C.bytes++;
+      return HOST_TWI_DATA_ACK;
+
+    case TWI_READ:
+      TWDR = hostI2C.regs[hostI2C.reg++];
+      return (v & (1 << TWEA)) ? HOST_TWI_READ_ACK : HOST_TWI_READ_NACK;
+
+    default:                            // Not addressed
+      return HOST_TWI_DATA_NACK;
+  }
+}
+
+HostTWCR &HostTWCR::operator= (uint8_t v)
+{
+  uint8_t status;
+
+  value = v & ~((1 << TWINT) | (1 << TWSTO));   // Writing 1 clears TWINT. TWSTO clears when the STOP is sent
+  if ((v & (1 << TWINT)) && (v & (1 << TWEN))) {
+    status = HostTWIStep (v);
+    if (status) {
+      TWSR = (TWSR & 0x3) | status;
+      value |= (1 << TWINT);
+    }
+  }
+  HostTWIInterupt ();
+  return *this;
+}
+
+HostSREG &HostSREG::operator= (uint8_t v)
+{
+  value = v;
+  HostTWIInterupt ();
+  return *this;
+}
+
+void fht_window (void) {}
+void fht_reorder (void) {}
+void fht_run (void) {}
+void fht_mag_log (void) {}
+void fht_mag_lin (void) {}
+void fht_mag_octave (void) {}
+
+// Sketch routines from PSKRTTY_Transceiver_v0.1a.ino
+__attribute__((weak)) void Reset (void) {}
+__attribute__((weak)) void ResetFrequencies (void) {}
+__attribute__((weak)) void StatusLED (void) {}
+__attribute__((weak)) void TestLEDS (void) {}
+__attribute__((weak)) void MeasurePinIO (void) {}
+__attribute__((weak)) void EEPROMWriteCorrection (void) {}
+__attribute__((weak)) void EEPROMReadCorrection (void) {}
+__attribute__((weak)) void EEPROMWriteRTTYConfig (void) {}
+__attribute__((weak)) void EEPROMReadRTTYConfig (void) {}
@@ -0,0 +1,74 @@
+#ifndef HOSTARDUINO_H_
+#define HOSTARDUINO_H_
+
+// Host test support (see HostArduino.cpp)
+void HostAdvanceMicros (unsigned long us);
+
+// I2C device model (a Si5351 on the TWI). See HostArduino.cpp
+struct HostI2CDevice_def {
+  uint8_t address;                      // 7 bit address
+  uint8_t regs[256];
+  uint8_t reg;                          // Register pointer (auto increments)
+  uint8_t nack;                         // Set to NACK the address (device missing)
+  unsigned long transactions, bytes;    // Write transactions (START + address ACK) and data bytes written
+};
+extern HostI2CDevice_def hostI2C;
+void HostI2CReset (void);
+
+// Gaussian noise with a fixed seed so that results can be repeated
+class HostNoise {
+  public:
+    HostNoise (unsigned long seed) { state = seed; }
+    double Uniform (void) { state = state * 6364136223846793005ULL + 1442695040888963407ULL; return ((state >> 11) + 0.5) / 9007199254740992.0; }
+    double Gauss (void) { return sqrt (-2.0 * log (Uniform ())) * cos (2.0 * PI * Uniform ()); }
+  private:
+    unsigned long long state;
+};
+
+// 2nd order section (RBJ cookbook). Highpass or lowpass at f0 Hz for F_SAMPLE
+class HostBiquad {
+  public:
+    HostBiquad (double f0, bool highpass) {
+      double w = 2.0 * PI * f0 / F_SAMPLE, a = sin (w) / (2.0 * 0.7071), cw = cos (w);
+      double a0 = 1.0 + a;
+      b0 = (highpass ? (1.0 + cw) / 2.0 : (1.0 - cw) / 2.0) / a0;
+      b1 = (highpass ? -(1.0 + cw) : 1.0 - cw) / a0;
+      b2 = b0;
+      a1 = -2.0 * cw / a0;
+      a2 = (1.0 - a) / a0;
+      x1 = x2 = y1 = y2 = 0;
+    }
+    double Filter (double x) {
+      double y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+      x2 = x1; x1 = x; y2 = y1; y1 = y;
+      return y;
+    }
+  private:
+    double b0, b1, b2, a1, a2, x1, x2, y1, y2;
+};
+
+// Receiver noise. Gaussian noise in the receiver audio passband (300 - 2700 Hz, 4th order) scaled to rms (ADC counts)
+class HostReceiverNoise {
+  public:
+    HostReceiverNoise (unsigned long seed, double rms) : rng (seed), hp1 (300, true), hp2 (300, true), lp1 (2700, false), lp2 (2700, false) {
+      double p = 0;
+      gain = 1;
+      for (int i = 0; i < 100000; i++) { double v = Sample (); p += v * v; }
+      gain = rms / sqrt (p / 100000);
+    }
+    double Sample (void) { return gain * lp2.Filter (lp1.Filter (hp2.Filter (hp1.Filter (rng.Gauss ())))); }
+    HostNoise rng;                        // Also used by tests for random data
+  private:
+    HostBiquad hp1, hp2, lp1, lp2;
+    double gain;
+};
+
+// ADC sample (10 bit signed, as formed by the ADC ISR)
+inline int HostADC (double v)
+{
+  if (v > 511) v = 511;
+  if (v < -512) v = -512;
+  return (int)lround (v);
+}
+
+#endif // HOSTARDUINO_H_
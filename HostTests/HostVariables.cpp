@@ -0,0 +1,4 @@
+// Sketch globals. Same includes as PSKRTTY_Transceiver_v0.1a.ino
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllVariables.h"
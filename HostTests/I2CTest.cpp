@@ -0,0 +1,98 @@
+/*
+Host test for the interupt driven TWI driver (i2c.cpp) and the Si5351 register writes against the I2C device model
+in HostArduino.cpp. Checks that after power up ResetSi5351() and SetFrequency() program the Si5351, that long writes
+are split, that writes queued with interupts disabled are sent without deadlock, that a missing device is counted
+in i2cErrors and that polled reads still work after queued writes.
+Exits with 1 on any failure (and is killed by an alarm if the driver hangs)
+*/
+
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#define TEST_TIMEOUT 10                 // Seconds. A hung driver fails the test
+
+extern unsigned char siShadow[SI_SHADOW_REGS];
+
+static int Check (const char *name, int ok)
+{
+  printf ("%-36s %s\n", name, ok ? "ok" : "FAIL");
+  return !ok;
+}
+
+static int ShadowMatches (void)
+{
+// Registers the sketch writes (output enable, CLK0-2 control and the multisynths) match the shadow copy
+  return hostI2C.regs[SIREG_3_OUTPUT_ENABLE_CTL] == siShadow[SIREG_3_OUTPUT_ENABLE_CTL] &&
+    !memcmp (&hostI2C.regs[SIREG_16_CLK0_CTL], &siShadow[SIREG_16_CLK0_CTL], 3) &&
+    !memcmp (&hostI2C.regs[SIREG_26_MSNA_1], &siShadow[SIREG_26_MSNA_1], SI_SHADOW_REGS - SIREG_26_MSNA_1);
+}
+
+int main (void)
+{
+  unsigned char data[2 * I2C_MAX_DATA + 3], value, i;
+  unsigned long transactions;
+  uint16_t errors;
+  int fail = 0;
+
+  alarm (TEST_TIMEOUT);
+  HostI2CReset ();
+  memset (hostI2C.regs, 0x5A, sizeof(hostI2C.regs));      // Power up contents are unknown
+  sei ();                                                 // As Arduino init() before setup()
+
+  // TWCR is 0 after reset so nothing can be queued until i2cInit()
+  fail |= Check ("Not queued before i2cInit()", i2cQueueWrite (SIREG_3_OUTPUT_ENABLE_CTL, 1, data) == 1);
+
+  // Power up sequence (see setup())
+  ResetSi5351 (SI_CRY_LOAD_8PF);
+  i2cFlush ();
+  fail |= Check ("ResetSi5351() programs the Si5351", ShadowMatches () &&
+    hostI2C.regs[SIREG_3_OUTPUT_ENABLE_CTL] == 0xFF && hostI2C.regs[SIREG_16_CLK0_CTL] == 0x80 &&
+    hostI2C.regs[SIREG_183_CRY_LOAD_CAP] == SI_CRY_LOAD_8PF && hostI2C.regs[SIREG_42_MSYN0_1] == 0);
+
+  SetFrequency (14070000);
+  i2cFlush ();
+  fail |= Check ("SetFrequency() programs the Si5351", ShadowMatches () && hostI2C.regs[SIREG_177_PLL_RESET] &&
+    hostI2C.regs[SIREG_26_MSNA_1 + 3] && hostI2C.regs[SIREG_42_MSYN0_1 + 3] &&
+    !hostI2C.regs[SIREG_3_OUTPUT_ENABLE_CTL] && !(hostI2C.regs[SIREG_16_CLK0_CTL] & SI_CLK_OFF));
+
+  // Longer than a queue entry. Sent as consecutive register runs
+  for (i = 0; i < sizeof(data); i++) data[i] = 0xA0 + i;
+  transactions = hostI2C.transactions;
+  Si5351RepeatedWriteRegister (SIREG_50_MSYN1_1, sizeof(data), data);
+  i2cFlush ();
+  fail |= Check ("Long write split", hostI2C.transactions - transactions == 3 &&
+    !memcmp (&hostI2C.regs[SIREG_50_MSYN1_1], data, sizeof(data)) && ShadowMatches ());
+
+  // More writes than the queue holds with interupts disabled. The TWI is polled until there is room
+  cli ();
+  for (i = 0; i < 3 * I2C_QUEUE_SIZE; i++) Si5351WriteRegister (SIREG_58_MSYN2_1 + (i & 0x7), i);
+  i2cFlush ();
+  fail |= Check ("Full queue with interupts disabled", !i2cBusy () && ShadowMatches () &&
+    hostI2C.regs[SIREG_58_MSYN2_1 + 7] == 3 * I2C_QUEUE_SIZE - 1);
+  sei ();
+
+  // Device does not ACK. The write is dropped and counted and the queue carries on
+  errors = i2cErrors;
+  hostI2C.nack = 1;
+  Si5351WriteRegister (SIREG_17_CLK1_CTL, 0x4F);
+  i2cFlush ();
+  hostI2C.nack = 0;
+  Si5351WriteRegister (SIREG_18_CLK2_CTL, 0x4F);
+  i2cFlush ();
+  fail |= Check ("NACK counted in i2cErrors", i2cErrors == errors + 1 && i2cLastError == 0x20 &&
+    hostI2C.regs[SIREG_17_CLK1_CTL] == 0x80 && hostI2C.regs[SIREG_18_CLK2_CTL] == 0x4F);
+
+  // Polled read after queued writes
+  Si5351WriteRegister (SIREG_183_CRY_LOAD_CAP, SI_CRY_LOAD_10PF);
+  value = 0;
+  fail |= Check ("Read after queued write", !i2cReadRegister (SIREG_183_CRY_LOAD_CAP, &value) &&
+    value == SI_CRY_LOAD_10PF);
+
+  printf ("%lu transactions, %lu bytes, %u errors\n", hostI2C.transactions, hostI2C.bytes, i2cErrors);
+  printf (fail ? "FAIL\n" : "PASS\n");
+  return fail;
+}
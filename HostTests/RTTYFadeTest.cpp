@@ -0,0 +1,187 @@
+/*
+Host benchmark of the RTTY mark/space decision with selective fading. 45.45 baud 170 Hz shift RTTY (Mark 1000 Hz,
+Space 830 Hz) plus receiver noise is decoded as DecodeRTTYBlock() does: Goertzel Mark/Space power straight to
+RTTYBitSync() (square law decision). An envelope ATC (per tone peak/floor threshold correction) was tried here and
+had a higher CER than the square law decision with and without fading so it was removed
+Character error rate (CER) is the edit distance between the sent text and the displayed characters / sent characters
+
+Selective fading is Rayleigh fading of each tone on its own (i.e. one tone can fade while the other does not)
+Exits with 1 if there are errors on an unfaded signal at 10dB or more or the CER with selective fading at 20dB
+is over MAX_FADE_CER
+*/
+
+#include <string>                  // Before Arduino.h (min/max macros)
+#include <vector>
+#include <algorithm>
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+
+#define SIGNAL_AMPLITUDE 120.0          // ADC counts. Leaves room for noise and fading peaks (ADC is +/-512)
+#define TEST_SECONDS 300
+#define FADE_HZ 1.0                     // Fading rate (Doppler spread). Typical for HF
+#define FADE_PATHS 16                   // Sinusoids in the fading model
+#define IDLE_BITS 40                    // Mark before the first character
+#define MAX_FADE_CER 10.0               // CER (%) with selective fading at 20dB
+
+static const char text[] = "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG ";
+
+// Rayleigh fading gain (mean power 1) with a Gaussian Doppler spectrum FADE_HZ wide (2 sigma) as in the Watterson HF
+// channel model. Sum of FADE_PATHS sinusoids with random Doppler and phase for each of I and Q (a first order lowpass 
+// of white noise is far too rough: it changes by half in 20ms for a 1Hz corner)
+class Fader {
+  public:
+    Fader (HostNoise *rng) {
+      double w;
+      for (int k = 0; k < FADE_PATHS; k++) {
+        w = 2.0 * PI * rng->Gauss () * FADE_HZ / 2.0 / F_SAMPLE;
+        rc[k] = cos (w);                                          // Rotate each path by its Doppler every sample
+        rs[k] = sin (w);
+        w = 2.0 * PI * rng->Uniform ();
+        ic[k] = cos (w);
+        is[k] = sin (w);
+        w = 2.0 * PI * rng->Uniform ();
+        qc[k] = cos (w);
+        qs[k] = sin (w);
+      }
+    }
+    double Gain (void) {
+      double i = 0, q = 0, t;
+      for (int k = 0; k < FADE_PATHS; k++) {
+        i += ic[k];
+        q += qc[k];
+        t = ic[k] * rc[k] - is[k] * rs[k];
+        is[k] = is[k] * rc[k] + ic[k] * rs[k];
+        ic[k] = t;
+        t = qc[k] * rc[k] - qs[k] * rs[k];
+        qs[k] = qs[k] * rc[k] + qc[k] * rs[k];
+        qc[k] = t;
+      }
+      return sqrt ((i * i + q * q) / FADE_PATHS);
+    }
+  private:
+    double rc[FADE_PATHS], rs[FADE_PATHS], ic[FADE_PATHS], is[FADE_PATHS], qc[FADE_PATHS], qs[FADE_PATHS];
+};
+
+class RTTYSignal {
+  public:
+    RTTYSignal (unsigned long seed, int snr, bool fading) :
+      noise (seed, SIGNAL_AMPLITUDE / sqrt (2.0 * pow (10.0, snr / 10.0))),         // Tone power A^2/2 to noise power
+      markFade (&noise.rng), spaceFade (&noise.rng) {
+      amp = SIGNAL_AMPLITUDE;
+      fade = fading;
+      phase = 0;
+      n = 0;
+      halfBitSamples = F_SAMPLE * 50.0 / rttyBaud;
+      Bits (1, IDLE_BITS * 2);
+    }
+    void Send (const char *s) {
+      // LTRS before each word so that letters are restored after a lost character
+      for (; *s; s++) {
+        if (*s != ' ') {
+          if (s == text || s[-1] == ' ') Code (RTTY_LETTERS);
+          Code (Baudot (*s, 1));
+        } else Code (Baudot (' ', 1));
+        sent += *s;
+      }
+    }
+    int Sample (void) {
+      double g, v;
+      unsigned char bit;
+      unsigned long b = (unsigned long)(n / halfBitSamples);
+
+      bit = b < bits.size () ? bits[b] : 1;
+      phase += 2.0 * PI * (bit ? RTTY_SPACE_FREQUENCY + rttyShift : RTTY_SPACE_FREQUENCY) / F_SAMPLE;
+      g = 1.0;
+      if (fade) {
+        double gm = markFade.Gain (), gs = spaceFade.Gain ();
+        g = bit ? gm : gs;
+      }
+      v = amp * g * cos (phase) + noise.Sample ();
+      n++;
+      return HostADC (v);
+    }
+    unsigned long Samples (void) { return (unsigned long)(bits.size () * halfBitSamples) + F_SAMPLE; }
+    std::string sent;
+  private:
+    void Bits (unsigned char b, int halves) { while (halves--) bits.push_back (b); }
+    void Code (unsigned char c) {
+      Bits (0, 2);                                                    // Start
+      for (int i = 0; i < BAUDOT_BITS; i++) Bits ((c >> i) & 1, 2);
+      Bits (1, 3);                                                    // 1.5 stop bits
+    }
+    HostReceiverNoise noise;
+    Fader markFade, spaceFade;
+    std::vector<unsigned char> bits;                                  // Half bits
+    double amp, phase, halfBitSamples;
+    unsigned long n;
+    bool fade;
+};
+
+unsigned int EditDistance (const std::string &a, const std::string &b)
+{
+  std::vector<unsigned int> d (b.size () + 1), p (b.size () + 1);
+  for (size_t j = 0; j <= b.size (); j++) p[j] = j;
+  for (size_t i = 1; i <= a.size (); i++) {
+    d[0] = i;
+    for (size_t j = 1; j <= b.size (); j++) {
+      d[j] = min (min (p[j] + 1, d[j - 1] + 1), p[j - 1] + (a[i - 1] != b[j - 1]));
+    }
+    p.swap (d);
+  }
+  return p[b.size ()];
+}
+
+double Decode (int snr, bool fading)
+{
+// Decode the test signal. Returns CER (%)
+  RTTYSignal sig (7, snr, fading);
+  std::string rx;
+  unsigned long s, total;
+  long markpwr, spacepwr;
+  unsigned char i;
+  char c;
+
+  while (sig.sent.size () < TEST_SECONDS * rttyBaud / 100 / 7.5) sig.Send (text);
+  ResetRTTY ();
+  ResetCarrierDetect (&rttySquelch);
+
+  total = sig.Samples ();
+  for (s = 0; s + CORRBUFFSZ <= total; s += CORRBUFFSZ) {
+    for (i = 0; i < CORRBUFFSZ; i++) rttybuff[i] = sig.Sample ();
+    blockEnergy = BlockEnergy (rttybuff, CORRBUFFSZ);
+    markpwr = GoertzelPower (rttybuff, CORRBUFFSZ, rttyMarkCoeff);
+    spacepwr = GoertzelPower (rttybuff, CORRBUFFSZ, rttySpaceCoeff);
+    blockSigPwr = markpwr + spacepwr;
+    if (CarrierDetect (&rttySquelch, blockSigPwr, blockEnergy, RTTY_SQUELCH_RATIO, RTTY_SQUELCH_HANG)) {
+      c = RTTYBitSync (markpwr, spacepwr, CORRBUFFSZ);
+    } else {
+      c = RTTYBitSync (0, 0, CORRBUFFSZ);
+    }
+    if (rttyLocked && c && rttySquelch.hang) rx += c;
+  }
+  return 100.0 * EditDistance (sig.sent, rx) / sig.sent.size ();
+}
+
+int main (void)
+{
+  static const int snrs[] = {0, 3, 6, 10, 20};
+  double cer, fade;
+  unsigned char i;
+  int fail = 0;
+
+  SetRTTYConfig (RTTY_DEFAULT_CONFIG);
+  printf ("RTTY 45.45 baud 170 Hz CER %% (%d s per run, SNR in receiver bandwidth)\n", TEST_SECONDS);
+  printf ("SNR dB | No fading | Selective %.1f Hz\n", FADE_HZ);
+  for (i = 0; i < sizeof(snrs) / sizeof(int); i++) {
+    cer = Decode (snrs[i], false);
+    fade = Decode (snrs[i], true);
+    printf ("%6d | %9.1f | %16.1f\n", snrs[i], cer, fade);
+    if (snrs[i] >= 10 && cer > 0) { printf ("FAIL: errors on a strong signal\n"); fail = 1; }
+    if (snrs[i] >= 20 && fade > MAX_FADE_CER) { printf ("FAIL: CER with selective fading\n"); fail = 1; }
+  }
+  if (!fail) printf ("PASS\n");
+  return fail;
+}
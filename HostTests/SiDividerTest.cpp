@@ -0,0 +1,92 @@
+/*
+Host test for the Si5351 fast retune path in CalculateDividers(). A random walk of tuning steps (up to SI_RETUNE_MAX,
+i.e. encoder steps and RTTY mark/space), band jumps and crystal calibration changes is run through CalculateDividers().
+After every call the PLL (MSN_P1-3) and output (MS_P1-3) register values are compared with the full calculation
+of the same frequency. The cached solution is then restored so that fast retunes build on each other as on the radio.
+
+Also checks that the cached solution fits in 32 bits (long is 64 bits on the host but 32 bits on the AVR)
+Exits with 1 on any mismatch or if the fast path was not used
+*/
+
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+
+#define TEST_STEPS 3000000UL
+#define JUMP_ODDS 100                   // 1 in JUMP_ODDS calls is a jump anywhere in the band
+#define CAL_ODDS 1000                   // 1 in CAL_ODDS calls changes the crystal calibration
+#define MAX_CORRECTION 2000             // Calibration range (correction is in 0.1 ppm)
+
+extern Si5351_Tune_def siTune;
+
+typedef struct {
+  unsigned long MSN_P1, MSN_P2, MSN_P3, MS_P1, MS_P2, MS_P3;
+} SiRegs_def;
+
+static void SaveRegs (SiRegs_def *r)
+{
+  r->MSN_P1 = multisynth.MSN_P1;
+  r->MSN_P2 = multisynth.MSN_P2;
+  r->MSN_P3 = multisynth.MSN_P3;
+  r->MS_P1 = multisynth.MS_P1;
+  r->MS_P2 = multisynth.MS_P2;
+  r->MS_P3 = multisynth.MS_P3;
+}
+
+int main (void)
+{
+  HostNoise rng (11);
+  SiRegs_def fast, full;
+  Si5351_Tune_def tune;
+  unsigned long i, freq, mismatches = 0, overflows = 0, fastCalls = 0, fastBefore;
+  long delta;
+
+  memset ((char *)&multisynth, 0, sizeof(multisynth));
+  memset ((char *)&siTune, 0, sizeof(siTune));
+  multisynth.Fxtal = SI_CRY_FREQ_25MHZ;
+  freq = 14070000;
+
+  for (i = 0; i < TEST_STEPS; i++) {
+    if ((unsigned long)(rng.Uniform () * CAL_ODDS) == 0) {
+      multisynth.correction = (long)(rng.Uniform () * (2 * MAX_CORRECTION + 1)) - MAX_CORRECTION;
+    }
+    if ((unsigned long)(rng.Uniform () * JUMP_ODDS) == 0) {
+      freq = SI_MIN_OUT_FREQ + (unsigned long)(rng.Uniform () * (SI_MAX_OUT_FREQ - SI_MIN_OUT_FREQ));
+    } else {
+      delta = (long)(rng.Uniform () * (2 * SI_RETUNE_MAX + 1)) - SI_RETUNE_MAX;
+      if (freq + delta >= SI_MIN_OUT_FREQ && freq + delta <= SI_MAX_OUT_FREQ) freq += delta;
+    }
+
+    fastBefore = siFastRetunes;
+    CalculateDividers (freq);
+    if (siFastRetunes != fastBefore) fastCalls++;
+    SaveRegs (&fast);
+    tune = siTune;
+    if (tune.div > 0xFFFFFFFFUL || tune.rem > 0xFFFFFFFFUL) overflows++;
+
+    siTune.pllValid = 0;
+    siTune.msValid = 0;
+    CalculateDividers (freq);
+    SaveRegs (&full);
+    siTune = tune;
+
+    if (memcmp (&fast, &full, sizeof(fast))) {
+      if (mismatches < 10) {
+        printf ("Mismatch %lu Hz corr %ld: MS_P1 %lu/%lu MS_P2 %lu/%lu MSN_P2 %lu/%lu\n", freq, multisynth.correction,
+          fast.MS_P1, full.MS_P1, fast.MS_P2, full.MS_P2, fast.MSN_P2, full.MSN_P2);
+      }
+      mismatches++;
+    }
+  }
+
+  printf ("%lu calls (%lu fast retunes): %lu mismatches, %lu 32 bit overflows\n", TEST_STEPS, fastCalls, mismatches,
+    overflows);
+  if (mismatches || overflows || !fastCalls) {
+    printf ("FAIL\n");
+    return 1;
+  }
+  printf ("PASS\n");
+  return 0;
+}
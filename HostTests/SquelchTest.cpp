@@ -0,0 +1,186 @@
+/*
+Host test for the PSK and RTTY carrier detect gates (squelch). Band limited Gaussian noise (receiver audio passband)
+with and without a signal is fed through the gate exactly as the decoders do:
+  PSK  - PSK31 random text. Block pairs are contiguous CROSSCORRSZ x 2 samples at F_SAMPLE (as filled by the ADC
+         ISR) through PSKQualityBlock() and CarrierDetect() as GetPhaseShift() does
+  RTTY - 45.45 baud 170 Hz FSK random bits. Blocks of CORRBUFFSZ samples through BlockEnergy(), GoertzelPower()
+         for Mark and Space and CarrierDetect() as DecodeRTTYBlock() does
+
+Reports the time the gate is open, the number of opens (all opens are false on noise) and how well a signal holds
+the gate open. Exits with 1 if PSK_SQUELCH_RATIO/PSK_SQUELCH_HANG or RTTY_SQUELCH_RATIO/RTTY_SQUELCH_HANG miss
+the limits below. "SquelchTest sweep" prints the tables used to pick them
+*/
+
+#include "Arduino.h"
+#include "AllIncludes.h"
+#include "AllExternVariables.h"
+#include "HostArduino.h"
+#include <stdio.h>
+
+#define PSK_GATE_SAMPLES (CROSSCORRSZ * 2)
+#define RTTY_GATE_SAMPLES CORRBUFFSZ
+#define NOISE_RMS 30.0                  // ADC counts. Receiver hiss well above the ADC LSB
+#define NOISE_SECONDS 600               // Noise only run (10 minutes)
+#define SIGNAL_SECONDS 60               // Each signal run (random text)
+#define SETTLE_SECONDS 1                // Ignore first second of signal (noise floor and gate settle)
+#define PSK31_BAUD 31.25
+
+// Limits for the squelch ratio and hang of each mode
+#define MAX_NOISE_OPEN_PCT 2.0          // Gate open on noise
+#define MAX_FALSE_OPENS_PER_MIN 10
+#define MIN_SIGNAL_OPEN_PCT 99.0        // Gate open with a signal at MIN_SIGNAL_SNR
+#define MIN_SIGNAL_SNR 0                // dB in receiver bandwidth (300 - 2700 Hz)
+
+typedef struct {
+  double openPct;
+  unsigned int opens, falseOpens;
+} Gate_def;
+
+class Receiver {
+  public:
+    Receiver (unsigned long seed, double amplitude, bool rttySignal) : noise (seed, NOISE_RMS) {
+      amp = amplitude;
+      rtty = rttySignal;
+      n = 0;
+      sign = 1;
+      bit = 1;
+      phase = 0;
+    }
+    int Sample (void) {
+      double v = rtty ? RTTY () : PSK ();
+      n++;
+      return HostADC (v + noise.Sample ());
+    }
+  private:
+    double PSK (void) {
+      double spb = F_SAMPLE / PSK31_BAUD, t = fmod (n, spb) / spb, env;
+      if (fmod (n, spb) < 1.0) {                    // Next symbol. Random text, 0 bit is a phase reversal
+        if (!bit) sign = -sign;
+        bit = noise.rng.Uniform () < 0.5;
+      }
+      env = bit ? sign : sign * cos (PI * t);
+      return amp * env * cos (2.0 * PI * PSK_CARRIER_FREQUENCY * n / F_SAMPLE);
+    }
+    double RTTY (void) {
+      double spb = F_SAMPLE * 100.0 / rttyBaud;     // rttyBaud is baud x 100
+      if (fmod (n, spb) < 1.0) bit = noise.rng.Uniform () < 0.5;
+      phase += 2.0 * PI * (bit ? RTTY_SPACE_FREQUENCY + rttyShift : RTTY_SPACE_FREQUENCY) / F_SAMPLE;
+      return amp * cos (phase);
+    }
+    HostReceiverNoise noise;
+    double amp, phase;
+    unsigned long n;
+    int sign, bit;
+    bool rtty;
+};
+
+static double BlocksPerSecond (bool rtty)
+{
+  return (double)F_SAMPLE / (rtty ? RTTY_GATE_SAMPLES : PSK_GATE_SAMPLES);
+}
+
+Gate_def RunGate (Receiver *rx, bool rtty, unsigned long blocks, unsigned char ratio, unsigned char hang)
+{
+// Feed blocks to the gate. Returns the open time and the gate's open counts after the settle time
+// Nothing is decoded so every open that closes again is a false open
+  Squelch_def *sq = rtty ? &rttySquelch : &pskSquelch;
+  unsigned long b, open = 0, settle = (unsigned long)(SETTLE_SECONDS * BlocksPerSecond (rtty));
+  unsigned char i, pass;
+  Gate_def g;
+
+  ResetCarrierDetect (sq);
+  ResetPSKQuality ();
+  for (b = 0; b < settle + blocks; b++) {
+    if (b == settle) sq->opens = sq->falseOpens = 0;
+    if (rtty) {
+      for (i = 0; i < RTTY_GATE_SAMPLES; i++) rttybuff[i] = rx->Sample ();
+      blockEnergy = BlockEnergy (rttybuff, CORRBUFFSZ);
+      blockSigPwr = GoertzelPower (rttybuff, CORRBUFFSZ, rttyMarkCoeff) + GoertzelPower (rttybuff, CORRBUFFSZ, rttySpaceCoeff);
+      pass = CarrierDetect (sq, blockSigPwr, blockEnergy, ratio, hang);
+    } else {
+      for (i = 0; i < CROSSCORRSZ; i++) corrbufflag[i] = rx->Sample ();
+      for (i = 0; i < CROSSCORRSZ; i++) corrbuff[i] = rx->Sample ();
+      PSKQualityBlock ();
+      pass = CarrierDetect (sq, blockSigPwr, blockEnergy, ratio, hang);
+    }
+    if (pass && b >= settle) open++;
+  }
+  g.openPct = 100.0 * open / blocks;
+  g.opens = sq->opens;
+  g.falseOpens = sq->falseOpens;
+  return g;
+}
+
+Gate_def NoiseOnly (bool rtty, unsigned char ratio, unsigned char hang)
+{
+  Receiver rx (1, 0, rtty);
+  return RunGate (&rx, rtty, (unsigned long)(NOISE_SECONDS * BlocksPerSecond (rtty)), ratio, hang);
+}
+
+Gate_def WithSignal (bool rtty, unsigned char ratio, unsigned char hang, int snr)
+{
+  Receiver rx (2, NOISE_RMS * sqrt (2.0 * pow (10.0, snr / 10.0)), rtty);     // Carrier power A^2/2 to noise power
+  return RunGate (&rx, rtty, (unsigned long)(SIGNAL_SECONDS * BlocksPerSecond (rtty)), ratio, hang);
+}
+
+void Sweep (bool rtty, const unsigned char *ratios, unsigned char nratios, const unsigned char *hangs, unsigned char nhangs)
+{
+  static const int snrs[] = {-6, -3, 0, 3, 6};
+  unsigned char r, h, s;
+  Gate_def g;
+
+  printf ("%s\nratio hang | noise open%% false opens/min | signal open%% at SNR dB", rtty ? "RTTY" : "PSK");
+  for (s = 0; s < sizeof(snrs) / sizeof(int); s++) printf (" %5d", snrs[s]);
+  printf ("\n");
+  for (r = 0; r < nratios; r++) {
+    for (h = 0; h < nhangs; h++) {
+      g = NoiseOnly (rtty, ratios[r], hangs[h]);
+      printf ("%5d %4d | %11.2f %15.1f |                        ", ratios[r], hangs[h], g.openPct, g.falseOpens * 60.0 / NOISE_SECONDS);
+      for (s = 0; s < sizeof(snrs) / sizeof(int); s++) printf (" %5.1f", WithSignal (rtty, ratios[r], hangs[h], snrs[s]).openPct);
+      printf ("\n");
+    }
+  }
+}
+
+int Check (bool rtty, unsigned char ratio, unsigned char hang)
+{
+// Check a mode's squelch settings against the limits. Returns 1 if they miss
+  Gate_def noise, sig;
+  int fail = 0;
+
+  noise = NoiseOnly (rtty, ratio, hang);
+  sig = WithSignal (rtty, ratio, hang, MIN_SIGNAL_SNR);
+  printf ("%s squelch ratio %d hang %d\n", rtty ? "RTTY" : "PSK", ratio, hang);
+  printf ("  Noise (%d s): open %.2f%% closed %.2f%% false opens %u (%.1f/min)\n", NOISE_SECONDS, noise.openPct,
+          100.0 - noise.openPct, noise.falseOpens, noise.falseOpens * 60.0 / NOISE_SECONDS);
+  printf ("  %s at %d dB SNR (%d s): open %.2f%% opens %u\n", rtty ? "RTTY" : "PSK31", MIN_SIGNAL_SNR, SIGNAL_SECONDS,
+          sig.openPct, sig.opens);
+
+  if (noise.openPct > MAX_NOISE_OPEN_PCT) { printf ("FAIL: gate open on noise\n"); fail = 1; }
+  if (noise.falseOpens * 60.0 / NOISE_SECONDS > MAX_FALSE_OPENS_PER_MIN) { printf ("FAIL: false opens\n"); fail = 1; }
+  if (sig.openPct < MIN_SIGNAL_OPEN_PCT) { printf ("FAIL: gate closes on signal\n"); fail = 1; }
+  return fail;
+}
+
+int main (int argc, char *argv[])
+{
+  static const unsigned char pskRatios[] = {8, 16, 24, 32, 40, 44, 48, 56, 64};
+  static const unsigned char pskHangs[] = {12, 33, 48, 64};
+  static const unsigned char rttyRatios[] = {12, 16, 20, 24, 28, 32, 40, 48};
+  static const unsigned char rttyHangs[] = {5, 10, 20, 30, 40};
+  int fail = 0;
+
+  SetPSKTone (0);
+  SetRTTYConfig (RTTY_DEFAULT_CONFIG);
+  SetRTTYTones (0);
+  if (argc > 1 && !strcmp (argv[1], "sweep")) {
+    Sweep (false, pskRatios, sizeof(pskRatios), pskHangs, sizeof(pskHangs));
+    Sweep (true, rttyRatios, sizeof(rttyRatios), rttyHangs, sizeof(rttyHangs));
+    return 0;
+  }
+
+  fail |= Check (false, PSK_SQUELCH_RATIO, PSK_SQUELCH_HANG);
+  fail |= Check (true, RTTY_SQUELCH_RATIO, RTTY_SQUELCH_HANG);
+  if (!fail) printf ("PASS\n");
+  return fail;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#define ILI9340_BLACK 0
+#define ILI9340_BLUE 0x001F
+#define ILI9340_RED 0xF800
+#define ILI9340_GREEN 0x07E0
+#define ILI9340_CYAN 0x07FF
+#define ILI9340_MAGENTA 0xF81F
+#define ILI9340_YELLOW 0xFFE0
+#define ILI9340_WHITE 0xFFFF
+class Adafruit_ILI9340 { public:
+ Adafruit_ILI9340(int,int,int){}
+ void begin(){} void fillScreen(uint16_t){} void fillRect(int16_t,int16_t,int16_t,int16_t,uint16_t){}
+ void setTextColor(uint16_t){} void setTextSize(uint8_t){} void setCursor(int16_t,int16_t){}
+ int16_t getCursorX(){return 0;} int16_t getCursorY(){return 0;} int16_t width(){return 0;} int16_t height(){return 0;}
+ template<class T> void print(T){} template<class T> void println(T){} void println(){}
+ void setAddrWindow(uint16_t,uint16_t,uint16_t,uint16_t){} void pushColor(uint16_t){} void writecommand(uint8_t){} void writedata(uint8_t){}
+ void drawPixel(int16_t,int16_t,uint16_t){} void drawFastVLine(int16_t,int16_t,int16_t,uint16_t){} void drawFastHLine(int16_t,int16_t,int16_t,uint16_t){}
+ uint16_t Color565(uint8_t,uint8_t,uint8_t){return 0;}
+};
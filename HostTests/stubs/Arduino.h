@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <ctype.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+typedef bool boolean;
+typedef uint8_t byte;
+#define PI 3.1415926535897932384626433832795
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define HEX 16
+#define DEC 10
+#define BIN 2
+#define A0 54
+#define B00000000 0
+#define B00000001 1
+#define B00000010 2
+#define B00000011 3
+#define B00000100 4
+#define B00001100 12
+#define B00010000 16
+#define B00100000 32
+#define B01000000 64
+#define B10000000 128
+#define B11111100 252
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*)(s))
+struct HardwareSerial {
+  void begin(long){} int available(){return 0;} int read(){return 0;} void flush(){}
+  size_t write(uint8_t){return 1;}
+  template<class T> size_t print(T){return 0;}
+  template<class T> size_t print(T,int){return 0;}
+  template<class T> size_t println(T){return 0;}
+  template<class T> size_t println(T,int){return 0;}
+  size_t println(){return 0;}
+};
+extern HardwareSerial Serial, Serial1, Serial2;
+void pinMode(uint8_t,uint8_t); void digitalWrite(uint8_t,uint8_t); int digitalRead(uint8_t);
+void delay(unsigned long); void delayMicroseconds(unsigned int);
+unsigned long millis(void); unsigned long micros(void);
+void tone(uint8_t, unsigned int); void noTone(uint8_t);
+long random(long,long);
+inline bool isPrintable(int c){return isprint(c);}
+#undef abs
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#ifndef min
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
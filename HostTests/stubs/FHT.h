@@ -0,0 +1,4 @@
+#pragma once
+// Library defines the FHT buffers. WaterFall.cpp is the only file that includes it
+int fht_input[FHT_N]; uint8_t fht_log_out[FHT_N/2];
+void fht_window(); void fht_reorder(); void fht_run(); void fht_mag_log(); void fht_mag_lin(); void fht_mag_octave();
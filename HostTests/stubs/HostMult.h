@@ -0,0 +1,5 @@
+#pragma once
+// AVRMult.h is AVR assembler. Its include guard is defined here (forced include, see Makefile) so the sketch gets plain C
+#define _AVRMult_H_
+#include <stdint.h>
+inline int32_t muls16x16_32 (int16_t multiplicand, int16_t multiplier) { return (int32_t)multiplicand * multiplier; }
@@ -0,0 +1,3 @@
+#pragma once
+// The sketch includes "Main.h" but the file is main.h (fine on the case insensitive Arduino IDE hosts)
+#include "../../PSKRTTY_Transceiver_v0.1a/main.h"
@@ -0,0 +1,4 @@
+#pragma once
+#include <stdint.h>
+class SPIClass { public: static uint8_t transfer(uint8_t d){return d;} static void begin(){} };
+extern SPIClass SPI;
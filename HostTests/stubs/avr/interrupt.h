@@ -0,0 +1,5 @@
+#pragma once
+#include <avr/io.h>
+#define ISR(v) extern "C" void v(void); void v(void)
+#define cli() (SREG = SREG & ~(1 << SREG_I))
+#define sei() (SREG = SREG | (1 << SREG_I))
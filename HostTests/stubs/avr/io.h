@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+// Registers are plain variables. HostArduino.cpp defines them
+#ifdef HOST_DEFINE_REGISTERS
+#define R8(n) volatile uint8_t n;
+#define R16(n) volatile uint16_t n;
+#else
+#define R8(n) extern volatile uint8_t n;
+#define R16(n) extern volatile uint16_t n;
+#endif
+R8(ADCSRA) R8(ADCSRB) R8(ADMUX) R8(ADCL) R8(ADCH) R8(DIDR0) R16(ADC)
+R8(TCCR0A) R8(TCCR0B) R8(TIMSK0) R8(TCNT0) R8(OCR0A)
+R8(TCCR1A) R8(TCCR1B) R8(TIMSK1) R16(TCNT1) R16(OCR1A) R8(TIFR1)
+R8(TCCR3A) R8(TCCR3B) R8(TIMSK3) R16(TCNT3) R16(OCR3A) R8(TIFR3)
+R8(TCCR4A) R8(TCCR4B) R8(TIMSK4) R16(TCNT4) R16(OCR4A) R8(TIFR4)
+R8(TCCR5A) R8(TCCR5B) R8(TIMSK5) R16(TCNT5) R16(OCR5A) R8(TIFR5)
+R8(TWSR) R8(TWDR) R8(TWBR)
+R8(PINA) R8(PINB) R8(PINC) R8(PIND) R8(PINE) R8(PINF) R8(PING) R8(PINH) R8(PINJ) R8(PINK) R8(PINL)
+R8(PORTA) R8(PORTB) R8(PORTC) R8(PORTD) R8(PORTE) R8(PORTF) R8(PORTG) R8(PORTH) R8(PORTJ) R8(PORTK) R8(PORTL)
+R8(DDRA) R8(DDRB) R8(DDRC) R8(DDRD) R8(DDRE) R8(DDRF) R8(DDRG) R8(DDRH) R8(DDRJ) R8(DDRK) R8(DDRL)
+R8(PCICR) R8(PCMSK0) R8(PCMSK1) R8(PCMSK2) R8(PCIFR) R8(SMCR)
+#define ADC0D 0
+#define REFS0 6
+#define ADATE 5
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADEN 7
+#define ADIE 3
+#define ADSC 6
+#define ADIF 4
+#define WGM12 3
+#define WGM32 3
+#define WGM42 3
+#define WGM52 3
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define OCIE1A 1
+#define OCIE3A 1
+#define OCIE4A 1
+#define OCIE5A 1
+#define ICF3 5
+#define OCF3A 1
+#define OCF3B 2
+#define OCF3C 3
+#define OCF4A 1
+#define OCF1A 1
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define SREG_I 7
+#define DDE4 4
+#define DDE5 5
+#define DDG5 5
+#define PINE4 4
+#define PING5 5
+#define PINH3 3
+#define PINH4 4
+#define PINH5 5
+#define PINB5 5
+#define PINB6 6
+#define PINE3 3
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCINT0 0
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PE3 3
+#define PE4 4
+#define PE5 5
+#define PG5 5
+#define PH3 3
+#define PH4 4
+#define PH5 5
+#define PH6 6
+#define PJ0 0
+#define PJ1 1
+
+// TWCR and SREG writes go to the I2C device model (HostArduino.cpp) so that the TWI and its interupt can be run
+class HostTWCR {
+  public:
+    HostTWCR &operator= (uint8_t v);
+    operator uint8_t () const { return value; }
+    volatile uint8_t value;
+};
+class HostSREG {
+  public:
+    HostSREG &operator= (uint8_t v);
+    operator uint8_t () const { return value; }
+    volatile uint8_t value;
+};
+extern HostTWCR TWCR;
+extern HostSREG SREG;
@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#define PROGMEM
+#define PSTR(s) (s)
+static inline uint16_t HostReadWord (const void *a) { uint16_t v; memcpy (&v, a, sizeof(v)); return v; }
+static inline uint32_t HostReadDword (const void *a) { uint32_t v; memcpy (&v, a, sizeof(v)); return v; }
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define pgm_read_word(a) HostReadWord (a)
+#define pgm_read_dword(a) HostReadDword (a)
+#define memcpy_P memcpy
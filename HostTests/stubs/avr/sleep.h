@@ -0,0 +1,3 @@
+#pragma once
+#define SLEEP_MODE_IDLE 0
+void set_sleep_mode(int); void sleep_mode(void); void sleep_enable(void); void sleep_disable(void); void sleep_cpu(void);
@@ -0,0 +1,4 @@
+#pragma once
+#define ATOMIC_BLOCK(t) for(int __i=1;__i;__i=0)
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 1
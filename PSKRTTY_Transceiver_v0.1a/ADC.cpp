@@ -25,31 +25,34 @@ ISR(ADC_vect)
 
   CheckForClip ();
 
+  // Front end shared by all decoders. Remove DC (ADC bias) with a running average of the samples
+  adcDC += si - (adcDC >> ADC_DC_SHIFT);
+  si -= (int)(adcDC >> ADC_DC_SHIFT);
+
   // ---------------  Fill RTTY Auto-Correlation Bufffer
+  // RTTY has its own buffers and flag (RTTYDONE) so that PSK can be decoded from the same samples
   if (flags & DECODERTTY) {
+    adcSampleCtr++;           // Sampling is continuous. Count samples so RTTY bit timing is kept when blocks are late
+    rttyadcbuff[rttyCtr++] = si;   // put data into buffer
     
     // Check if buffer full
-    if (aCtr < CORRBUFFSZ) {
-      adcbuff[aCtr++] = si;   // put data into buffer
-      
-    } else if ( !(flags & ADCDONE) ) {
-      flags |= ADCDONE;
-      memcpy ((char *)corrbuff, (char *)adcbuff, sizeof(corrbuff));
-      aCtr = 0;
-      if (!(flags & REALTIME)) StopSampling();
-
-    // Overrun condition
-    }  else {
-      flags |= DISPLAY_ERROR;
-      errorCode = RTTY_DATA_OVERRUN;
-//      aCtr = 0;
-//      flags &= ~ADCDONE;
-//      flags &= ~MEASURETHRESHOLD;
+    if (rttyCtr >= CORRBUFFSZ) {
+      rttyCtr = 0;
+      if ( !(flags & RTTYDONE) ) {
+        flags |= RTTYDONE;
+        memcpy ((char *)rttybuff, (char *)rttyadcbuff, sizeof(rttybuff));
+        rttyBlockStamp = adcSampleCtr;    // Sample count at end of block. Not changed until RTTYDONE cleared
+
+      // Overrun condition. Drop the block, bit synchronizer detects the gap from the sample count
+      }  else {
+        rttyOverruns++;
+      }
     }
+  }
 
-    // ---------------  Fill PSK Cross-Correlation Bufffers
-    // MUST have two buffers back to back (i.e contigious buffers)..so wait for flag to clear
-  } else if (!(flags & ADCDONE) && flags & DECODEPSK) {
+  // ---------------  Fill PSK Cross-Correlation Bufffers
+  // MUST have two buffers back to back (i.e contigious buffers)..so wait for flag to clear
+  if (!(flags & ADCDONE) && flags & DECODEPSK) {
 
     // Fill First buffer
     if (aCtr < CROSSCORRSZ) {
@@ -67,6 +70,7 @@ ISR(ADC_vect)
       } else if (!(flags & BUFF1DONE) && !(flags & PROCESSINGDONE)) {
           flags |= DISPLAY_ERROR;
           errorCode = PSK_BUFFER_OVERFLOW;
+          pskOverruns++;
       }
       adcbuff[aCtr - CROSSCORRSZ] = si;  // put real data into 2nd buffer
       aCtr++;
@@ -84,6 +88,7 @@ ISR(ADC_vect)
       } else {
           flags |= DISPLAY_ERROR;
           errorCode = PSK_BUFFER_OVERFLOW;
+          pskOverruns++;
       }
     }
 
@@ -91,26 +96,31 @@ ISR(ADC_vect)
   } else if ((flags & ADCDONE) && (flags & DECODEPSK)) {
     flags |= DISPLAY_ERROR;
     errorCode = PSK_DATA_OVERRUN;
+    pskOverruns++;
 //    aCtr = 0;
 //    flags &= ~ADCDONE;
 //    flags |= PROCESSINGDONE;
 //    flags &= ~MEASURETHRESHOLD;
 
   // ---------------  Fill Descrete FFT Buffer
+  // Sampling is continuous. adcbuff[] is a ring of FHT_RING samples (three FHT_N2 half blocks). Every FHT_N2 samples
+  // (50% overlap) the end of the last FHT_N samples is published and the main loop copies the window (CopyFHTWindow())
+  // while the next half block is sampled into the third half. Copying 256 bytes here would take longer than a sample
+  // If the main loop is still busy with the last window this one is skipped
   } else if (flags & DOFHT) {
-    // Check if buffer full
-    if (aCtr < FHT_N) {
-      adcbuff[aCtr++] = si;   // put data into buffer
-      
-    } else if ( !(flags & ADCDONE) ) {
-      flags |= ADCDONE;
-      memcpy ((char *)fht_input, (char *)adcbuff, sizeof(fht_input));
-      memcpy ((char *)corrbuff, (char *)adcbuff, sizeof(corrbuff));
-      aCtr = 0;
+    adcbuff[aCtr++] = si;
+    if (aCtr >= FHT_RING) aCtr = 0;
 
-    // Overrun condition...don't do anything...don't care in this mode
-    }  else {
-      aCtr = 0;
+    if (!(aCtr & (FHT_N2 - 1))) {
+      fhtHalfBlocks++;
+      if (!fhtFill) {                       // Window not full yet (first FHT_N2 samples)
+        fhtFill = 1;
+
+      } else if ( !(flags & ADCDONE) ) {
+        flags |= ADCDONE;
+        fhtWindowEnd = aCtr;
+        fhtWindowBlock = fhtHalfBlocks;
+      }
     }
 
   // ---------------  Fill Buffer for Console Dump
@@ -132,6 +142,36 @@ ISR(ADC_vect)
 
 }
 
+unsigned char CopyFHTWindow (void)
+{
+// Routine to copy the FFT window published by the ADC ISR out of the sample ring into fht_input[] (oldest sample first)
+// and, for the narrow waterfall, the start of it into corrbuff[]. The ISR samples into the third half of the ring
+// so the window is whole if it has not finished that half. Returns 1 if copied or 0 if the ISR has moved on (window
+// dropped). Only whole windows are counted in fhtCovered
+
+  unsigned int start, n;
+  unsigned long block;
+
+  start = fhtWindowEnd + FHT_N2;            // Oldest sample is FHT_N before the end (i.e. FHT_N2 after it in the ring)
+  if (start >= FHT_RING) start -= FHT_RING;
+  n = FHT_RING - start;
+  if (n > FHT_N) n = FHT_N;
+  memcpy ((char *)fht_input, (char *)&adcbuff[start], n * sizeof(int));
+  memcpy ((char *)&fht_input[n], (char *)adcbuff, (FHT_N - n) * sizeof(int));
+
+  cli();
+  block = fhtHalfBlocks;
+  sei();
+  if (block != fhtWindowBlock) return 0;
+
+  if (flags & NARROW_WATERFALL) memcpy ((char *)corrbuff, (char *)fht_input, sizeof(corrbuff));
+
+  // Window covers its two half blocks less any the last copied window covered
+  fhtCovered += min (fhtWindowBlock - fhtLastBlock, 2UL);
+  fhtLastBlock = fhtWindowBlock;
+  return 1;
+}
+
 void CheckForClip (void)
 {
 // This function is used to check if sucessive sampled values are the same
@@ -143,7 +183,7 @@ void CheckForClip (void)
   // Next check if last value also exceeds min threshold 
   // If thresholds are met, then check the difference between values to see if they fall below a
   // difference threshold. 
-  if (si > ADC_CLIPPING_THRESHOLD && lastsi > ADC_CLIPPING_THRESHOLD || si < -(ADC_CLIPPING_THRESHOLD) && lastsi < -(ADC_CLIPPING_THRESHOLD) ) {
+  if ((si > ADC_CLIPPING_THRESHOLD && lastsi > ADC_CLIPPING_THRESHOLD) || (si < -(ADC_CLIPPING_THRESHOLD) && lastsi < -(ADC_CLIPPING_THRESHOLD))) {
 
     deltasi = si ^ lastsi;                    // XOR to find the difference. Only care about differences in lower 2 bits
     
@@ -182,7 +222,9 @@ void CheckForClip (void)
 void ToggleSampling (unsigned char mode)
 {
 // Routing to toggle the ADC on/off for acquiring samples.
+// This is called before and after slow LCD updates so its also a good place to do deferred Tx work
   
+  RunDeferredWork ();
   if (flags & REALTIME) {
     if (mode) {
       StartSampling();
@@ -197,8 +239,16 @@ void StartSampling (void)
 {
 // Routine to enable Sampling
 
+  // Sampling was stopped (e.g. for a slow LCD update). Count the samples missed so that RTTY bit timing is kept
+  if ((flags & DECODERTTY) && adcStopTime) {
+    adcSampleCtr += ((micros() - adcStopTime) * (F_SAMPLE / 100)) / 10000UL;
+  }
+  adcStopTime = 0;
+
   // First rest all associated variables
   aCtr = 0;
+  fhtFill = 0;
+  rttyCtr = 0;
   lastsi = 0;
   deltasi = 0;
   clipctr = 0;
@@ -207,6 +257,7 @@ void StartSampling (void)
   slctr = 0;
 
   flags &= ~ADCDONE;
+  flags &= ~RTTYDONE;
   EnableADC();
 }
 
@@ -216,6 +267,7 @@ void StopSampling (void)
 
   aCtr = 0;
   ADCSRA = 0;
+  adcStopTime = micros();
 }
 
 
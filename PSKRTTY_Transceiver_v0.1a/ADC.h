@@ -7,12 +7,14 @@ void StartSampling (void);
 void StopSampling (void);
 void ToggleSampling (unsigned char mode);
 void CheckForClip (void);
+unsigned char CopyFHTWindow (void);
 
 #define MAX_CLIP_COUNT 2
 #define MAX_CLIP_RESET_COUNT 500
 #define MIN_ADC_DELTA 3
 #define ADC_RESET_COUNT 3000
 #define ADC_CLIPPING_THRESHOLD 200
+#define ADC_DC_SHIFT 8                  // DC removal averages over 256 samples (~27ms)
 
 
 
@@ -30,8 +30,10 @@ extern volatile unsigned long TermFlags;
 
 // Correlation Buffers and Variables
 // Use the largest buffer size to accomodate the data
-extern volatile int adcbuff[FHT_N];        // Correlation buffers use CORRBUFFSZ and DFT buffers use DFTBUFSZ which is larger
+extern volatile int adcbuff[FHT_RING];     // Correlation buffers use CORRBUFFSZ and DFT buffers use DFTBUFSZ which is larger
 extern volatile int corrbuff[CORRBUFFSZ];
+extern volatile int rttyadcbuff[CORRBUFFSZ];
+extern volatile int rttybuff[CORRBUFFSZ];
 
 extern volatile int adcbufflag[FHT_N];
 extern volatile int corrbufflag[CORRBUFFSZ];
@@ -48,6 +50,10 @@ extern volatile unsigned char ThreshDivider;
 extern byte aLow, aHigh;
 extern int si;
 extern unsigned int aCtr;
+extern volatile unsigned char rttyCtr;
+extern volatile long adcDC;
+extern unsigned long adcStopTime;
+extern volatile unsigned int pskOverruns;
 extern int vLevel, sLevel, slctr;
 extern int lastsi, deltasi, clipctr, clipctrrst;
 
@@ -56,12 +62,24 @@ extern volatile int digitalSignalLevel, oldDigitalLevel;
 extern volatile int dlevelctr, levelctr, slevelctr, maxCorrLevel, maxvLevel;
 extern volatile int oldCorrLevel, oldvLevel;
 
+// Carrier Detect (Squelch) Variables
+extern unsigned long blockSigPwr, blockEnergy;
+extern Squelch_def pskSquelch, rttySquelch;
+
+// Decode CPU Budget Variables
+extern unsigned long decodeBusy, decodeWindowStart;
+extern unsigned long decodeOverrunsLast;
+extern unsigned char decodeLoad, decodeLoadMax;
+extern unsigned int decodeBudgetExceeded;
+
 // This is a define in the FHT.h define. However it cannot be included because it defines this variable and will get a redefined error
 extern int fht_input[(FHT_N)]; // FHT input data buffer
 extern uint8_t fht_log_out[(FHT_N/2)]; // FHT log output magintude buffer
 
 // Frequency Control variables
 extern unsigned long frequency_clk0, frequency_clk0_tx;
+extern int tuneOffset;
+extern unsigned long tuneSteps;
 extern long frequency_inc;
 extern unsigned long frequency_mult;
 extern unsigned long frequency_mult_old;
@@ -70,13 +88,31 @@ extern unsigned long frequency_mult_old;
 extern int rttySpaceFreq;
 extern int rttyMarkFreq;
 extern int rttyMarkBin, rttySpaceBin, rttySpaceMag, rttyMarkMag;
-
-extern volatile unsigned char rttyFigures, rttyChar, bitpos, rttyMark, rttySpace, rttyState, rttyIdle, nortty;
+extern int rttyMarkCoeff, rttySpaceCoeff;
+extern unsigned char rttyConfig;
+extern unsigned int rttyBaud, rttyShift;
+extern BaudClock_def rttyClock;
+extern unsigned char rttySpaceFFTBin, rttyMarkFFTBin, rttySpaceCBin, rttyMarkCBin, rttyPBBinWidth;
+
+extern volatile unsigned char rttyFigures, rttyChar, bitpos, rttyState, nortty;
+extern volatile unsigned int adcSampleCtr, rttyBlockStamp;
+extern unsigned int rttyLastStamp, rttyDpllPhase;
+extern unsigned long rttyPhaseInc;
+extern unsigned char rttyPhaseFrac;
+extern long rttyBitSum, rttyBitMag, rttyLastD;
+extern long rttyEdgeD, rttyEdgeMag;
+extern unsigned int rttyEdgeSamples;
+extern int rttyDpllErr;
+extern unsigned long rttyBits, rttyFrameErrors;
+extern volatile unsigned int rttyOverruns;
 extern boolean rttyLocked;
 
 // RTTY Transmitter Variables
 extern unsigned long rttyTransmitSpaceFreq;
 extern unsigned long rttyTransmitMarkFreq;
+extern unsigned char rttyMarkRegs[SI_MSREGS], rttySpaceRegs[SI_MSREGS];
+extern unsigned long rttyRegsSpaceFreq, rttyRegsMarkFreq;
+extern volatile unsigned int rttyKeyTime;
 extern volatile unsigned char rttyPriorState, rttyDelay;
 extern volatile char rttyLTRSSwitch;
 
@@ -85,16 +121,30 @@ extern boolean pskChanged, pskLocked;
 extern unsigned char pskbinthresh;
 extern long int pskcorrthresh, corrTotal;
 extern unsigned char pskPhase;
-extern unsigned int pskVaricode;
+extern unsigned char pskNode;
 extern unsigned int pskbinlevel;
 extern unsigned int levelResetCtr;
 extern boolean pskChanged, pskLocked;
 extern unsigned char pskResetCtr;
 extern boolean decodePhaseChange;
 
+// PSK Signal Quality Variables
+extern unsigned long pskSigPwr, pskNoisePwr;
+extern unsigned int pskNcoInc;
+extern unsigned int pskPhaseErrSum;
+extern unsigned char pskPhaseErrCnt;
+extern unsigned int pskBitMag, pskBitPhaseErr;
+extern unsigned int pskEnvPeak, pskEnvCnt;
+extern unsigned long pskEnvSum;
+extern unsigned long pskImdMean, pskImdPeak;
+extern unsigned char pskImdCnt, pskLastBit;
+extern int pskSNR, pskIMD;
+extern unsigned char pskPhaseErr;
+extern unsigned char pskQualityCtr;
+
 // PSK Transmitter Variables
-extern unsigned char pskSwap, pskVcodeLen;
-extern unsigned int pskVcode;
+extern unsigned char pskSwap;
+extern BaudClock_def pskClock;
 extern unsigned char decodeLastPhase;
 extern int decodePhaseCtr;
 extern unsigned char pskState;
@@ -107,24 +157,52 @@ extern unsigned char fft_tmp[FHT_N2];
 extern unsigned long FFTavg;
 extern unsigned long FFTrms;
 
+// Streaming Spectrum Variables
+extern volatile unsigned char fhtFill;
+extern volatile unsigned char fhtWindowEnd;
+extern volatile unsigned long fhtHalfBlocks;
+extern volatile unsigned long fhtWindowBlock;
+extern unsigned long fhtLastBlock;
+extern unsigned long fhtCovered;
+extern unsigned int fhtRowSum[FHT_N2];
+extern unsigned char fhtRowFFTs;
+extern unsigned long fhtRowTime;
+extern unsigned long fhtStartTime;
+extern unsigned long fhtFFTs, fhtRows;
+
+
 // Encoder Variables
 extern volatile int enc_states[];
 extern volatile int old_AB;
-extern unsigned char encoderVal, encoderState;
-extern unsigned int pbstate;
-extern unsigned long pbreset;
+extern unsigned char encoderVal;
+extern volatile unsigned char encoderState;
+extern volatile int encoderCount;
+extern volatile unsigned char encoderTicks;
+extern volatile unsigned long encoderSteps, encoderDropped, encoderMissed;
+extern unsigned long encoderLastUpdate, encoderUpdates, encoderRateStart;
+extern unsigned int encoderRateCtr, encoderRate;
+extern volatile unsigned char ctlPinH, ctlPinE, ctlPinB;
+extern volatile unsigned char ctlHold;
+extern volatile unsigned long ctlPolls, ctlActivePolls, ctlIsrTicks;
 
 // Push Button Debounce
-extern volatile unsigned char pb1ctr, pb2ctr, pb3ctr, pbenable;
-extern volatile unsigned int pbreusectr; 
+extern Debounce_def buttons;
+extern volatile unsigned char btnQueue[BTN_QUEUE_SIZE];
+extern volatile unsigned char btnQueueHead, btnQueueTail;
+extern volatile unsigned long btnEvents, btnOverflow;
+extern unsigned char pbenable;
 
 // LCD Variables
 extern unsigned int maxX, maxY, fontX, fontY, charX, charY;
 extern unsigned int lcdchars, currentx, currenty;
 extern unsigned int LCDErrctr;
+extern unsigned int wfScrollLine;
+extern unsigned long wfRowTime, wfRowMaxTime;
+extern unsigned long wfBarTime;
 
 // LED Variables
 extern volatile unsigned int statusLEDctr;
+extern unsigned int pinSlowCycles, pinFastCycles;
 
 // LCD Menu variables
 extern unsigned char MenuSelection, MenuLevel;
@@ -147,6 +225,29 @@ extern unsigned char loadcharctr, callsignsize;
 extern unsigned char idle;
 extern unsigned char endBuff;
 
+// Transmit Symbol Queue variables
+extern volatile TxSymbol_def txQueue[TX_QUEUE_SIZE];
+extern volatile unsigned char txQueueHead, txQueueTail;
+extern volatile WorkItem_def workQueue[WORK_QUEUE_SIZE];
+extern volatile unsigned char workQueueHead, workQueueTail;
+extern unsigned int workMaxLatency;
+extern unsigned int workDeadlineMiss;
+extern volatile unsigned int workOverflow;
+extern unsigned long workCount;
+extern volatile unsigned long txISRMaxTime;
+extern unsigned char pskTxRegs[SI_MSREGS];
+extern unsigned long pskTxRegsFreq;
+extern unsigned long memRecallTime;
+extern ScanEntry_def scanTable[SCAN_MAX_STEPS];
+extern unsigned long scanStart;
+extern unsigned int scanStep;
+extern unsigned char scanSteps;
+extern unsigned char scanList[SCAN_LIST_SIZE];
+extern unsigned char scanListCount;
+extern unsigned int scanStepsPerSec;
+extern volatile unsigned int txSymbol;
+extern volatile unsigned char txSymbolLen;
+
 
 
 // Timer Variables
@@ -160,6 +261,10 @@ extern Si5351_def multisynth;
 extern Si5351_CLK_def clk0ctl;
 extern Si5351_CLK_def clk1ctl;
 extern Si5351_CLK_def clk2ctl;
+extern unsigned long siBytesWritten;
+extern unsigned int siSetFreqBytes, siPLLResets;
+extern unsigned int siFastRetunes, siFullRetunes;
+extern unsigned long siSetFreqTime;
 
 extern Adafruit_ILI9340 tft;
 
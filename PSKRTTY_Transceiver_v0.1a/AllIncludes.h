@@ -14,8 +14,9 @@ This define is used centrally control all includes.
 #include <avr/io.h>           // Needed PIN I/O
 #include <avr/interrupt.h>    // Needed for timer and adc interrupt
 #include <avr/eeprom.h>       // Needed for storing calibration to Arduino EEPROM
+#include <avr/pgmspace.h>     // Needed for Varicode/Baudot lookup tables stored in flash
 
-#include <Wire.h>             // Needed to communitate I2C to Si5351
+// Wire.h must NOT be included. Wire library has its own TWI interupt (see i2c.cpp)
 #include <SPI.h>              // Needed to communitate I2C to Si5351
 
 #include "Main.h"   		// Main Defines for this program
@@ -26,11 +27,18 @@ This define is used centrally control all includes.
 #include "LCD_Interface.h"    // VE3OOI LCD display funcation routines  (needs LCD library)
 #include "Timer.h"            // VE3OOI Timer control routines
 #include "WaterFall.h"        // VE3OOI Waterfall processing routines
+#include "CodecTables.h"      // Compile time Varicode/Baudot table generation
 #include "RTTY.h"             // VE3OOI RTTY Decode Routines
 #include "PSK.h"              // VE3OOI PSK Decode Routines
 #include "Correlation.h"      // VE3OOI Correlation Routines
+#include "TimingConfig.h"     // Compile time timing configuration (derived from F_CPU and sample rate)
 #include "UART.h"             // VE3OOI Serial Interface Routines (TTY Commands)
 #include "Pbutton_menu.h"     // VE3OOI Pushbutton and Menu Support
+#include "TxQueue.h"          // Pre-encoded transmit symbol queue
+#include "WorkQueue.h"        // Deferred work (I2C) from timer interupts
+#include "Memory.h"           // Memory channels stored in EEPROM
+#include "Scan.h"             // Band activity scanner
+#include "Buttons.h"          // Push button debouncing and events
 
 #include "i2c.h"
 #include "SPI.h"
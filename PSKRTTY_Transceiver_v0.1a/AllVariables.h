@@ -26,8 +26,10 @@ volatile unsigned long TermFlags;
 
 // Correlation Buffers and Variables
 // Use the largest buffer size to accomodate the data
-volatile int adcbuff[FHT_N];        // Correlation buffers use CORRBUFFSZ and DFT buffers use DFTBUFSZ which is larger
+volatile int adcbuff[FHT_RING];     // Correlation buffers use CORRBUFFSZ and DFT buffers use DFTBUFSZ which is larger
 volatile int corrbuff[CORRBUFFSZ];
+volatile int rttyadcbuff[CORRBUFFSZ];       // RTTY has its own buffers so that PSK can be decoded from the same samples
+volatile int rttybuff[CORRBUFFSZ];
 
 volatile int adcbufflag[FHT_N];
 volatile int corrbufflag[CORRBUFFSZ];
@@ -48,11 +50,28 @@ unsigned char fft_tmp[FHT_N2];
 unsigned long FFTavg;
 unsigned long FFTrms;
 
+// Streaming Spectrum Variables (overlapped FFTs averaged to display rows)
+volatile unsigned char fhtFill;           // First half block sampled (ADC ISR)
+volatile unsigned char fhtWindowEnd;      // Ring index after the newest sample of the published window (ADC ISR)
+volatile unsigned long fhtHalfBlocks;     // FHT_N2 sample blocks sampled
+volatile unsigned long fhtWindowBlock;    // fhtHalfBlocks when the window was published (ADC ISR)
+unsigned long fhtLastBlock;               // fhtWindowBlock of the last window copied (CopyFHTWindow())
+unsigned long fhtCovered;                 // FHT_N2 sample blocks that were in at least one copied window
+unsigned int fhtRowSum[FHT_N2];           // Sum of fht_log_out[] for the FFTs in the current row
+unsigned char fhtRowFFTs;                 // FFTs in the current row
+unsigned long fhtRowTime;                 // Time (ms) last row displayed
+unsigned long fhtStartTime;               // Time (ms) spectrum started (setupFFT())
+unsigned long fhtFFTs, fhtRows;           // FFTs done and rows displayed
+
 
 // ADC Sampling Variables
 byte aLow, aHigh;
 int si;
 unsigned int aCtr;
+volatile unsigned char rttyCtr;         // RTTY buffer fill count (independent of PSK/FFT buffers)
+volatile long adcDC;                    // Running average of samples x256 (DC removal)
+unsigned long adcStopTime;              // Time sampling was stopped. Used to keep RTTY bit timing
+volatile unsigned int pskOverruns;      // PSK blocks dropped
 int vLevel, sLevel, slctr;
 int lastsi, deltasi, clipctr, clipctrrst;
 
@@ -61,8 +80,20 @@ volatile int digitalSignalLevel, oldDigitalLevel;
 volatile int dlevelctr, levelctr, slevelctr, maxCorrLevel, maxvLevel;
 volatile int oldCorrLevel, oldvLevel;
 
+// Carrier Detect (Squelch) Variables
+unsigned long blockSigPwr, blockEnergy;     // In band power and total energy of the current block
+Squelch_def pskSquelch, rttySquelch;        // Carrier detect gate for each decoder
+
+// Decode CPU Budget Variables
+unsigned long decodeBusy, decodeWindowStart;   // Processing time (us) in current window and start of window
+unsigned long decodeOverrunsLast;           // Overruns at start of window
+unsigned char decodeLoad, decodeLoadMax;    // Load (%) of last window and maximum
+unsigned int decodeBudgetExceeded;          // Windows where load or overruns exceeded the budget
+
 // Frequency Control variables
 unsigned long frequency_clk0, frequency_clk0_tx;
+int tuneOffset;                             // Decoder tone offset (Hz) from the programmed Si5351 frequency (see FineTune())
+unsigned long tuneSteps;                    // Encoder steps followed by moving the decoder tones (no Si5351 retune)
 long frequency_inc;
 unsigned long frequency_mult;
 unsigned long frequency_mult_old;
@@ -70,17 +101,34 @@ unsigned long frequency_mult_old;
 // Encoder Variables
 volatile int enc_states[] = {0, -1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 volatile int old_AB = 0;
-unsigned char encoderVal, encoderState;
-unsigned int pbstate;
-unsigned long pbreset;
+unsigned char encoderVal;
+volatile unsigned char encoderState;        // Signals from Timer 1 ISR. Bit 0 button pushed, bit 1 rotated
+volatile int encoderCount;                  // Signed steps accumulated by CheckEncoder() (see ApplyEncoderSteps())
+volatile unsigned char encoderTicks;        // Polls since last detent (acceleration)
+volatile unsigned long encoderSteps;        // Detents counted
+volatile unsigned long encoderDropped;      // Steps dropped because the accumulated count was full
+volatile unsigned long encoderMissed;       // Quadrature states missed between polls (steps may be lost)
+unsigned long encoderLastUpdate;            // Time (ms) of last batch applied
+unsigned long encoderUpdates;               // Batches applied (one Si5351 write and LCD update each)
+unsigned long encoderRateStart;             // Updates per second measurement (peak in encoderRate)
+unsigned int encoderRateCtr, encoderRate;
+volatile unsigned char ctlPinH, ctlPinE, ctlPinB;     // Control pin snapshot taken by Timer 1 ISR (masked ports)
+volatile unsigned char ctlHold;             // Polls left before controls are idle (ISR fast path)
+volatile unsigned long ctlPolls;            // Timer 1 ISR count
+volatile unsigned long ctlActivePolls;      // Polls that ran CheckEncoder() and DebounceButtons()
+volatile unsigned long ctlIsrTicks;         // Time in Timer 1 ISR (Timer 1 ticks, 4 us)
 
 // Local LCD variables
 unsigned int maxX, maxY, fontX, fontY, charX, charY;
 unsigned int lcdchars, currentx, currenty;
 unsigned int LCDErrctr;
+unsigned int wfScrollLine;                  // LCD line of newest waterfall row (0 if not scrolling)
+unsigned long wfRowTime, wfRowMaxTime;      // Time (us) to draw last and longest waterfall row
+unsigned long wfBarTime;                    // Time (us) to draw bar graph spectrum (see LCDMeasureWaterfall())
 
 // LED Variables
 volatile unsigned int statusLEDctr;
+unsigned int pinSlowCycles, pinFastCycles;   // Cycles per digitalWrite() and PinLow()/PinHigh() (see MeasurePinIO())
 
 // Local PSK Variables
 boolean pskChanged, pskLocked;
@@ -91,13 +139,27 @@ boolean decodePhaseChange;
 unsigned char pskbinthresh;
 long int pskcorrthresh, corrTotal;
 unsigned char pskPhase; 
-unsigned int pskVaricode;
+unsigned char pskNode;
 unsigned int pskbinlevel; 
 unsigned int levelResetCtr;
 
+// PSK Signal Quality Variables
+unsigned long pskSigPwr, pskNoisePwr;       // Signal and noise energy for current character
+unsigned int pskNcoInc;                     // Reference phase increment per sample (see SetPSKTone())
+unsigned int pskPhaseErrSum;                // Sum of phase error for each bit in current character
+unsigned char pskPhaseErrCnt;               // Number of bits with phase error in current character
+unsigned int pskBitMag, pskBitPhaseErr;     // Strongest block in current bit and its phase error
+unsigned int pskEnvPeak, pskEnvCnt;         // Envelope peak and number of blocks in current bit
+unsigned long pskEnvSum;                    // Envelope sum in current bit
+unsigned long pskImdMean, pskImdPeak;       // Envelope mean and peak over idle bits
+unsigned char pskImdCnt, pskLastBit;
+int pskSNR, pskIMD;                         // Last SNR and IMD (dB)
+unsigned char pskPhaseErr;                  // Last average phase error (degrees)
+unsigned char pskQualityCtr;
+
 // PSK Transmitter Variables
-unsigned char pskSwap, pskVcodeLen;
-unsigned int pskVcode;
+unsigned char pskSwap;
+BaudClock_def pskClock;                   // Timer 3 baud clock for Rx and Tx bit time
 unsigned char decodeLastPhase;
 int decodePhaseCtr;
 unsigned char pskState;
@@ -106,14 +168,32 @@ unsigned char pskState;
 int rttySpaceFreq;
 int rttyMarkFreq;
 int rttyMarkBin, rttySpaceBin, rttySpaceMag, rttyMarkMag;
+int rttyMarkCoeff, rttySpaceCoeff;        // Goertzel coefficients for carrier detect
+unsigned char rttyConfig;                 // Baud rate and shift selection. Saved in EEPROM
+unsigned int rttyBaud, rttyShift;         // Baud rate x100 and shift (Hz)
+BaudClock_def rttyClock;                  // Timer 4 baud clock for Tx
+unsigned char rttySpaceFFTBin, rttyMarkFFTBin, rttySpaceCBin, rttyMarkCBin, rttyPBBinWidth;    // Waterfall markers
 
 // RTTY Transmitter Variables
 unsigned long rttyTransmitSpaceFreq;
 unsigned long rttyTransmitMarkFreq;
+unsigned char rttyMarkRegs[SI_MSREGS], rttySpaceRegs[SI_MSREGS];     // Precalculated Si5351 CLK0 multisynth registers for Tx keying
+unsigned long rttyRegsSpaceFreq, rttyRegsMarkFreq;                   // Frequencies rttySpaceRegs and rttyMarkRegs are for
+volatile unsigned int rttyKeyTime;                                        // Time (us) to key Mark/Space
 volatile unsigned char rttyPriorState, rttyDelay;
 volatile char rttyLTRSSwitch;
 
-volatile unsigned char rttyFigures, rttyChar, bitpos, rttyMark, rttySpace, rttyState, rttyIdle, nortty;
+volatile unsigned char rttyFigures, rttyChar, bitpos, rttyState, nortty;
+volatile unsigned int adcSampleCtr, rttyBlockStamp;    // ADC sample count and count at end of last RTTY block
+unsigned int rttyLastStamp, rttyDpllPhase;                 // RTTY bit synchronizer (DPLL) 
+unsigned long rttyPhaseInc;                                // DPLL phase increment per sample (x256)
+unsigned char rttyPhaseFrac;                               // DPLL phase fraction carried between blocks
+long rttyBitSum, rttyBitMag, rttyLastD;                   // Mark-Space integrated over bit and of last clear block
+long rttyEdgeD, rttyEdgeMag;                               // Mark-Space and power of unclear block (edge) after last clear block
+unsigned int rttyEdgeSamples;                              // Samples in unclear block. 0 if none
+int rttyDpllErr;                                           // Last DPLL phase error at bit edge
+unsigned long rttyBits, rttyFrameErrors;                   // RTTY bit and framing error counts
+volatile unsigned int rttyOverruns;                        // RTTY blocks dropped
 boolean rttyLocked;
 
 
@@ -121,14 +201,46 @@ boolean rttyLocked;
 unsigned char idle;
 unsigned char endBuff;
 
+// Transmit Symbol Queue variables. Filled by main loop and emptied by Tx timer
+volatile TxSymbol_def txQueue[TX_QUEUE_SIZE];
+volatile unsigned char txQueueHead, txQueueTail;
+volatile unsigned int txSymbol;           // Symbol being transmitted
+volatile unsigned char txSymbolLen;       // Number of bits in symbol being transmitted
+
+// Deferred Work Queue variables. Filled by Tx timers and emptied by main loop
+volatile WorkItem_def workQueue[WORK_QUEUE_SIZE];
+volatile unsigned char workQueueHead, workQueueTail;
+unsigned int workMaxLatency;              // Longest time (us) from timer ISR to work
+unsigned int workDeadlineMiss;            // Work started after WORK_DEADLINE_US
+volatile unsigned int workOverflow;       // Work dropped because queue full
+unsigned long workCount;                  // Work items done
+volatile unsigned long txISRMaxTime;      // Longest Tx timer ISR (us). Other interupts (e.g. ADC) blocked this long
+
+// Memory Channel variables
+unsigned char pskTxRegs[SI_MSREGS];       // Si5351 CLK0 multisynth registers for PSK Tx from last recalled channel
+unsigned long pskTxRegsFreq;              // Frequency pskTxRegs are for
+unsigned long memRecallTime;              // Time (us) to program Si5351 for last recalled channel
+
+// Band Scanner variables
+ScanEntry_def scanTable[SCAN_MAX_STEPS];  // Peak level and bin of each step
+unsigned long scanStart;                  // First frequency scanned
+unsigned int scanStep;                    // Frequency step
+unsigned char scanSteps;                  // Steps scanned
+unsigned char scanList[SCAN_LIST_SIZE];   // Most active steps (index to scanTable[]). Largest peak first
+unsigned char scanListCount;
+unsigned int scanStepsPerSec;             // Scan speed x10
+
 // Timer Variables
 byte adcsraReset, timsk1Reset, tccr1aReset, timsk3Reset, tccr3aReset, tccr4aReset, timsk4Reset;
 byte tcc0areset, tccr0bReset, timsk0Reset;
 
 
 // Push Button Debounce
-volatile unsigned char pb1ctr, pb2ctr, pb3ctr, pbenable;
-volatile unsigned int pbreusectr; 
+Debounce_def buttons;                       // Debouncer state (Timer 1 ISR)
+volatile unsigned char btnQueue[BTN_QUEUE_SIZE];    // Press/release/long press events for the main loop
+volatile unsigned char btnQueueHead, btnQueueTail;
+volatile unsigned long btnEvents, btnOverflow;      // Events queued and events dropped (queue full)
+unsigned char pbenable;                     // Push button presses waiting for the menu (see IsPushed())
 
 unsigned char MenuSelection, MenuLevel;
 
@@ -137,12 +249,12 @@ char RootMenuOptions[MAXMENU_ITEMS][MAXMENU_LEN] = {
   {"SLevels\0"},
   {"RX Menu\0"},
   {"CLR LCD\0"},
-  {"LCD Test\0"},
+  {"RTTY Cfg\0"},
   {"Help\0"},
   {"Reset\0"},
   {"INFO\0"},
 };
-unsigned char RootMenuValues[MAXMENU_ITEMS] = {CTL_W, CTL_S, CTL_K, CTL_C, CTL_O, CTL_H, CTL_Z, CTL_Q};
+unsigned char RootMenuValues[MAXMENU_ITEMS] = {CTL_W, CTL_S, CTL_K, CTL_C, CTL_A, CTL_H, CTL_Z, CTL_Q};
 
 char RxMenuOptions[MAXMENU_ITEMS][MAXMENU_LEN] = {
   {"SetLevel\0"},
@@ -150,11 +262,11 @@ char RxMenuOptions[MAXMENU_ITEMS][MAXMENU_LEN] = {
   {"RTTY TxRx\0"},
   {"PSK TxRx\0"},
   {"CLR LCD\0"},
-  {"Help\0"},
+  {"Dual Rx\0"},
   {"Tx Test\0"},
   {"Top Menu"}
 };
-unsigned char RxMenuValues[MAXMENU_ITEMS] = {CTL_T, CTL_D, CTL_R, CTL_P, CTL_C, CTL_H, CTL_G, CTL_I};
+unsigned char RxMenuValues[MAXMENU_ITEMS] = {CTL_T, CTL_D, CTL_R, CTL_P, CTL_C, CTL_BSLASH, CTL_G, CTL_I};
 
 char TxMenuOptions[MAXMENU_ITEMS][MAXMENU_LEN] = {
   {"Stop Tx\0"},
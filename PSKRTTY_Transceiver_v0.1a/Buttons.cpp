@@ -0,0 +1,138 @@
+/*
+
+Push button and encoder push button debouncing.  The Timer 1 ISR reads the control ports once and passes a bit
+mask of the buttons that are pushed (active) to DebounceButtons().  All buttons are debounced in parallel with a
+vertical counter: bit n of cnt0/cnt1/cnt2 is a 3 bit counter for button n that counts polls where the pin differs
+from the debounced state and is cleared when it agrees.  The state toggles when the counter rolls over (i.e.
+BTN_DEBOUNCE_POLLS at the new level).  A handful of logic operations debounce all the buttons.
+
+Press, release and long press events are queued for the main loop (ProcessButtonEvents()).  Like the work queue
+it is a single producer (ISR) single consumer (main loop) ring so interupts do not need to be disabled and the
+ISR no longer sets bits in flags.  DebounceButtons() only uses its arguments and the queue so it can be built on
+a host and driven with recorded pin waveforms.
+
+*/
+
+#include "Arduino.h"
+
+#include "AllIncludes.h"
+
+#include "AllExternVariables.h"
+
+
+void ResetButtons (void)
+{
+// Routine to reset the debouncer (all released), empty the event queue and reset the statistics
+  memset ((char *)&buttons, 0, sizeof(buttons));
+  btnQueueHead = btnQueueTail = 0;
+  btnEvents = 0;
+  btnOverflow = 0;
+  pbenable = 0;
+}
+
+
+void DebounceButtons (Debounce_def *db, unsigned char active)
+{
+// Routine called for each poll with the buttons that are pushed (BTN_xxx bits). Queues events for changes
+  unsigned char delta, toggle, bit, i;
+
+  delta = active ^ db->state;                       // Buttons that differ from the debounced state
+
+  // Count up where different, clear where the same. Roll over from 7 to 0 is the toggle
+  toggle = delta & db->cnt0 & db->cnt1 & db->cnt2;
+  db->cnt2 = (db->cnt2 ^ (db->cnt1 & db->cnt0)) & delta;
+  db->cnt1 = (db->cnt1 ^ db->cnt0) & delta;
+  db->cnt0 = ~db->cnt0 & delta;
+  db->state ^= toggle;
+
+  // Nothing pushed or changed (usual case)
+  if (!db->state && !toggle) return;
+
+  for (i = 0, bit = 1; i < BTN_COUNT; i++, bit <<= 1) {
+    if (toggle & bit) {
+      if (db->state & bit) {
+        PushButtonEvent (BTN_EVENT_PRESS | bit);
+        db->hold[i] = 0;
+        db->longSent &= ~bit;
+      } else {
+        PushButtonEvent (BTN_EVENT_RELEASE | bit);
+      }
+
+    // Held
+    } else if ((db->state & bit) && !(db->longSent & bit)) {
+      if (++db->hold[i] >= BTN_LONG_POLLS) {
+        PushButtonEvent (BTN_EVENT_LONG | bit);
+        db->longSent |= bit;
+      }
+    }
+  }
+}
+
+
+void PushButtonEvent (unsigned char event)
+{
+// Routine called by the Timer 1 ISR to queue an event. If the queue is full the event is dropped and counted
+  unsigned char head, next;
+
+  head = btnQueueHead;
+  next = (head + 1) & BTN_QUEUE_MASK;
+  if (next == btnQueueTail) {
+    btnOverflow++;
+    return;
+  }
+  btnQueue[head] = event;
+  btnQueueHead = next;
+  btnEvents++;
+}
+
+
+unsigned char PopButtonEvent (void)
+{
+// Routine to get the next event. Returns 0 if the queue is empty
+  unsigned char tail, event;
+
+  tail = btnQueueTail;
+  if (tail == btnQueueHead) return 0;
+
+  event = btnQueue[tail];
+  btnQueueTail = (tail + 1) & BTN_QUEUE_MASK;
+  return event;
+}
+
+
+void ProcessButtonEvents (void)
+{
+// Routine called from the main loop to act on queued events. Push button presses are latched in pbenable until
+// the menu processes them (see IsPushed() and DiableButton()).  Encoder button push increases the frequency
+// increment by 10 and a long push resets the frequencies back to default
+  unsigned char event, button;
+
+  while ((event = PopButtonEvent ())) {
+    button = event & BTN_EVENT_BUTTON;
+
+    switch (event & BTN_EVENT_TYPE) {
+      case BTN_EVENT_PRESS:
+        if (button == BTN_ENC) {
+          frequency_mult *= 10;
+          if (frequency_mult > MAXIMUM_FREQUENCY_MULTIPLIER) frequency_mult = MINIMUM_FREQUENCY_MULTIPLIER;
+        } else {
+          pbenable |= button;
+        }
+        break;
+
+      case BTN_EVENT_LONG:
+        if (button == BTN_ENC) ResetFrequencies ();
+        break;
+
+      default:                          // Releases are not used
+        continue;
+    }
+
+    // Signal UpdateFrequencyData() to display the increment. encoderState is shared with Timer 1 ISR
+    if (button == BTN_ENC) {
+      cli();
+      encoderState |= 1;
+      sei();
+    }
+  }
+}
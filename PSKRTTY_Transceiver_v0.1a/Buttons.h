@@ -0,0 +1,38 @@
+#ifndef _BUTTONS_H_
+#define _BUTTONS_H_
+
+// Buttons (one bit each so all are debounced in parallel). Push buttons use the same bits as PBxENABLED
+#define BTN_PB1 0x1                     // Push button 1 (PBUTTON1)
+#define BTN_PB2 0x2                     // Push button 2 (PBUTTON2)
+#define BTN_PB3 0x4                     // Push button 3 (PBUTTON3)
+#define BTN_ENC 0x8                     // Encoder push button (ENC_PB)
+#define BTN_COUNT 4
+
+#define BTN_DEBOUNCE_POLLS 8            // 3 bit vertical counter. State changes after 8 polls (24 ms) at the new level
+#define BTN_LONG_POLLS 667              // Held this long (2 s) for a long press
+
+// Events. Type in top 4 bits and the button (BTN_xxx) in bottom 4 bits
+#define BTN_EVENT_PRESS 0x10
+#define BTN_EVENT_RELEASE 0x20
+#define BTN_EVENT_LONG 0x40
+#define BTN_EVENT_TYPE 0xF0
+#define BTN_EVENT_BUTTON 0x0F
+
+#define BTN_QUEUE_SIZE 8                // Number of pending events. Must be power of 2
+#define BTN_QUEUE_MASK (BTN_QUEUE_SIZE-1)
+
+typedef struct {
+  unsigned char state;                  // Debounced state. Bit set if pushed
+  unsigned char cnt0, cnt1, cnt2;       // Vertical counter (bit n of each is the count for button n)
+  unsigned char longSent;               // Long press event sent for this press
+  unsigned int hold[BTN_COUNT];         // Polls each button has been held
+} Debounce_def;
+
+// Button Routines
+void ResetButtons (void);
+void DebounceButtons (Debounce_def *db, unsigned char active);
+void PushButtonEvent (unsigned char event);
+unsigned char PopButtonEvent (void);
+void ProcessButtonEvents (void);
+
+#endif // _BUTTONS_H_
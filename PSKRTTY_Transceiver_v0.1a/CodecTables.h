@@ -0,0 +1,22 @@
+/*
+
+Defines used to build the Varicode and Baudot lookup tables at compile time.
+
+The tables are filled by constexpr functions (see PSK.cpp and RTTY.cpp) and stored in PROGMEM.
+The Arduino compiler is C++11 so a constexpr function can only be a single return statement and
+cannot fill an array by itself. The macros below simply repeat the generator function for each
+entry of the table (i.e. f(0), f(1), f(2), ...) so that every entry is computed by the compiler.
+
+The tables must be read with pgm_read_byte()/pgm_read_word() at run time. The constexpr functions
+must ONLY be used to initialize tables.  If called at run time they would read flash addresses from RAM.
+
+*/
+
+#ifndef _CODECTABLES_H_
+#define _CODECTABLES_H_
+
+#define CODEC_ROW8(f, n)    f((n)),     f((n)+1),   f((n)+2),   f((n)+3),   f((n)+4),   f((n)+5),   f((n)+6),   f((n)+7)
+#define CODEC_ROW32(f, n)   CODEC_ROW8(f, (n)),   CODEC_ROW8(f, (n)+8),   CODEC_ROW8(f, (n)+16),  CODEC_ROW8(f, (n)+24)
+#define CODEC_ROW128(f, n)  CODEC_ROW32(f, (n)),  CODEC_ROW32(f, (n)+32), CODEC_ROW32(f, (n)+64), CODEC_ROW32(f, (n)+96)
+
+#endif // _CODECTABLES_H_
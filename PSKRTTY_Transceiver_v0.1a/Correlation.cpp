@@ -165,3 +165,45 @@ unsigned char ScaleCorr (long value)
   return 0;
   
 }
+
+
+long GoertzelPower (volatile int *buff, int size, int coeff)
+{
+// This routine calculates the power of a single frequency in the buffer (i.e. a single DFT bin) using the Goertzel algorithm.
+// coeff is 2cos(2 x pi x frequency / sample rate) x 16384. 
+// The power is scaled to be the same units as the energy of the buffer (i.e. sum of samples squared) 
+
+  int i;
+  long s0, s1, s2;
+
+  s1 = s2 = 0;
+  for (i=0; i<size; i++) {
+    s0 = buff[i] + ((coeff * s1) >> 14) - s2;
+    s2 = s1;
+    s1 = s0;
+  }
+
+  // Scale down so that products fit into a long
+  s1 >>= GOERTZEL_SHIFT;
+  s2 >>= GOERTZEL_SHIFT;
+
+  // Power = s1^2 + s2^2 - coeff x s1 x s2. Convert to energy units (x 2/size and undo scaling)
+  s0 = s1 * s1 + s2 * s2 - ((coeff * s1) >> 14) * s2;
+  if (s0 < 0) s0 = 0;
+  return (s0 / size) << (2 * GOERTZEL_SHIFT + 1);
+}
+
+
+long BlockEnergy (volatile int *buff, int size)
+{
+// This routine returns the energy in the buffer (i.e. sum of samples squared)
+
+  int i;
+  long total;
+
+  total = 0;
+  for (i=0; i<size; i++) {
+    total += muls16x16_32(buff[i], buff[i]);
+  }
+  return total;
+}
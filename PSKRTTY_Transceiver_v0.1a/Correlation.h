@@ -12,5 +12,10 @@
 long CrossCorr (volatile int *buff1, volatile int *buff2, int corrsize,  int lag);
 unsigned char GetCorrPeak (unsigned int fbin, unsigned int ebin);
 unsigned char ScaleCorr (long value);
+long GoertzelPower (volatile int *buff, int size, int coeff);
+long BlockEnergy (volatile int *buff, int size);
+
+#define GOERTZEL_SHIFT 4                  // Scale Goertzel state before squaring (avoid overflow)
+#define GOERTZEL_SCALE 16384.0            // Coefficient scaling (Q14)
 
 #endif // _CORR_H_
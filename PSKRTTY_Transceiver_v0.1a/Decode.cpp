@@ -19,9 +19,20 @@ void DecodeLoop( void )
 {
 // This routine is the main loop for any Rx related activity such as decoding RTTY, PSK, displaying waterfall
 // or displaying raw ADC values captured.
+// RTTY and PSK have seperate buffers and flags (RTTYDONE and ADCDONE) so both can be decoded from the same samples
 
   unsigned int i;
   char currentChar;     // Current decode ASCII character
+  unsigned long start;  // Used to measure processing time
+  unsigned long busy;   // Time processing blocks (CPU budget)
+  unsigned char row;    // Spectrum row ready for display
+
+  busy = micros();
+
+  // RTTY block ready so decode it
+  if ((flags & RTTYDONE) && (flags & DECODERTTY)) {
+    DecodeRTTYBlock ();
+  }
 
   // ADC sample ready so process buffer captures
   if (flags & ADCDONE) {
@@ -47,9 +58,14 @@ void DecodeLoop( void )
       // This loop is executed continiously whenever ADC is finished sampling.  Timer3 is running at 32ms and 
       // signals DecodePSK() to decide if this was a 1 or 0 bit based on the samples processed to now.       
       // DecodePSK() also convertes received varicode to ASCII
+      // GetPhaseShift() skips the correlation search if the carrier detect gate is closed (i.e. no phase shift)
+      // Processing time is measured for open and closed (skipped) blocks
+      start = micros();
       i = (int) GetPhaseShift ();
       currentChar = DecodePSK ((unsigned char)i);
       flags |= PROCESSINGDONE;    // Signal ADC interupt that its ok to tranfer ADC raw buffer to correlation buffers
+      if (pskSquelch.hang) pskSquelch.openTime += micros() - start;
+      else pskSquelch.closedTime += micros() - start;
 
       // Can either display signal levels or display received characters.
       // Arduino does not have the horsepower to do both. Also the LCD screen is far
@@ -60,12 +76,23 @@ void DecodeLoop( void )
         LCDDisplayLevel ();
 
       // If character present and PSK appears to be synchronized, then display current character
+      // Characters decoded when carrier detect gate is closed are noise so not displayed
+      } else if (pskLocked && currentChar && !pskSquelch.hang) {
+        pskSquelch.blocked++;
+
       } else if (pskLocked && currentChar) {  // Display decoded character on LCD
 //        Serial1.print (currentChar);
+        pskSquelch.chars++;
         LCDDisplayCharacter(currentChar);
         LoadCallSign (currentChar);           // This is supposed to capture the call sign...work in progress
       } 
 
+      // Display signal quality of received characters (whether displayed or not). LCD is slow so not every character
+      if (currentChar && !(flags & DISPLAY_SIGNAL_LEVEL) && ++pskQualityCtr >= PSK_QUALITY_DISPLAY_COUNT) {
+        pskQualityCtr = 0;
+        LCDDisplayPSKQuality ();
+      }
+
       // Update threashold value base on the average correlation value for 0 delay. Should be negative
       // Cycle through various dividers (between MIN_THRESHDIVIDER and MAX_THRESHDIVIDER).  This give
       // more granulatity in identifing appropriate threshold value.
@@ -93,88 +120,44 @@ void DecodeLoop( void )
         }
       }
    
-    // Decode RTTY
-    } else if ( flags & DECODERTTY ) {
-      // GetFreqRange() Performs an autocorrelation between the delay valuses specified and defines the corrDly
-      // which identified the delay (x10) at which a correlation peak appears. The delay is x10 to account
-      // for decimal numbers.  
-      GetFreqRange (rttyMarkBin - 2, rttySpaceBin + 2);
-
-      currentChar = 0;
-
-      // Check if the delay value calculated by GetFreqRange() is close to the Mark or Space frequency
-      // The DecodeRTTY() function takes the bit and assembles the RTTY baudot code.  It used Timer4 which 
-      // signals DecodeRTTY() every 22ms to load the bit.  
-      // If a start bit, 5 data bits and at least 2 stop bits received, then DecodeRTTY() converts the 5 data bits 
-      // from baudot to ASCII and return it      
-      if (abs(corrDly - rttySpaceBin * 10) <= 10) {
-        currentChar = DecodeRTTY (0);
-      } else if ( abs(corrDly - rttyMarkBin * 10) <= 10) {
-        currentChar = DecodeRTTY (1);
-      } else {
-        currentChar = DecodeRTTY (RTTY_UNKNOWN);
-      }
-      flags &= ~ADCDONE;                // Signal the ADC samping interrupt to continue processing
-
-    
-      // Can either display signal levels or display received characters.
-      // Arduino does not have the horsepower to do both. Also the LCD screen is far
-      // to slow to allow updates such as this.  Since LCD using I2C, a faster Arduino may 
-      // make this possible but with 16Mhz arduino LCD updates are VERY slow!! 
-      if (flags & DISPLAY_SIGNAL_LEVEL) {
-        SignalLevel (corrRTTY, 'R');
-        LCDDisplayLevel ();
-
-      // If character present and RTTY appears to be synchronized, then display current character
-      } else if (rttyLocked && currentChar) {
-        LCDDisplayCharacter(currentChar);
-        LoadCallSign (currentChar);     // This is supposed to capture the call sign...work in progress
-      }
-
-      // Update threashold value base on the average correlation value for 0 delay. Should be positive
-      // Simply take 1/2 of the average RTTY correlation value.
-      if (flags & MEASURETHRESHOLD) {
-        magThresh = corrRTTY >> 2;
-        SignalLevel (corrRTTY, 'R');
-        LCDDisplayLevel ();
-        Serial1.print (corrRTTY);
-        Serial1.print (" ");
-        Serial1.println (magThresh);
-        flags &= ~MEASURETHRESHOLD;
-      } 
-
-
     // Display Waterfall - Perform DFT and dislay spectrum on LCD
-    // Since this is using an FFT much more data needs to be catured that for a correlation and hence
-    // this is executed much slower
+    // Sampling is not stopped. The ADC ISR publishes a window every FHT_N2 samples (50% overlap) and the FFTs
+    // are averaged into a row that is displayed at the display rate (see AverageFFT())
+    // The window is copied out of the sample ring first and the ISR can then publish the next one. If the ISR
+    // reused part of the ring before it was copied (main loop was late) the window is dropped
     } else if (flags & DOFHT) {
 
-      // Stop data acquisition and perform the FFT
-      StopSampling();         
-      PerformFFT();
-
-      // Check mode of display
-      if (flags & NARROW_WATERFALL) {
+      i = CopyFHTWindow ();
+      flags &= ~ADCDONE;
+      row = 0;
+      if (i) {
+        PerformFFT();
+        row = AverageFFT();
+      }
 
-        // Narrow band mode so disply FFT bins and correlation peak delays side by side for comparison
-        // Calculate delay for the correlation peak as if it were RTTY 
-        // Also display the Bin for the FFT peak
+      // Narrow band mode calculates delay for the correlation peak as if it were RTTY (corrbuff[] copied with the window)
+      if (row && (flags & NARROW_WATERFALL)) {
         magThresh = AUTOCORR_THRESHOLD;
         GetFreqRange (rttyMarkBin - 2, rttySpaceBin + 2);
-        LCDDisplayPassbandWaterfall (); 
-
-      // Regular wide band mode so display spectrum on LCD (VERY SLOW!!!)
-      } else {
-        LCDDisplayWaterFall (); 
-      }     
-      // Treat as if it were RTTY and calculate and display the signal levels
-      //SignalLevel() needs RTTY to be synchronized
-      SignalLevel (corrRTTY, 'R');
-      LCDDisplayLevel ();
+      }
 
-      // Enable capture of another sample and continue
-      flags &= ~ADCDONE;
-      StartSampling();
+      if (row) {
+        // Check mode of display
+        if (flags & NARROW_WATERFALL) {
+
+          // Narrow band mode so disply FFT bins and correlation peak delays side by side for comparison
+          // Also display the Bin for the FFT peak
+          LCDDisplayPassbandWaterfall ();
+
+        // Regular wide band mode so add the row to the scrolling waterfall
+        } else {
+          LCDDisplayWaterFall ();
+        }
+        // Treat as if it were RTTY and calculate and display the signal levels
+        //SignalLevel() needs RTTY to be synchronized
+        SignalLevel (corrRTTY, 'R');
+        LCDDisplayLevel ();
+      }
 
     } else if (flags & ADCMONITOR) {
       for (i = 0; i < FHT_N; i++) Serial1.println (fht_input[i]);
@@ -183,6 +166,9 @@ void DecodeLoop( void )
     }
   } // ADC DONE
 
+  // Measure the CPU load of decoding (PSK and RTTY blocks including display) against the budget
+  if (flags & (DECODEPSK | DECODERTTY)) CheckDecodeBudget (micros() - busy);
+
   // Completed all process and data is being captured by ADC, check if rotary encoder engaged to change frequency
   // If engaged, then update frequency data on display
   // Note since updating the LCD is slow, its required to stop data acquisition when updating the LCD
@@ -194,15 +180,16 @@ void DecodeLoop( void )
   // caused more OVERRUNS and PSK bascially stops working.  
   // I was using SignalError() which display the error on serial1 but this also has a negative effect on
   // PSK decoding. So for the time being, PSK errors are not displayed.
+  // When RTTY and PSK are decoded together, PSK overruns are counted and reported by CheckDecodeBudget()
   if (flags & DISPLAY_ERROR) {
-    if (flags & DECODERTTY ) LCDSignalError (errorCode);
+    if ((flags & DECODERTTY) && !(flags & DECODEPSK)) LCDSignalError (errorCode);
 //    else SignalError (errorCode);                       // Display PSK error on Serial1
     flags &= ~DISPLAY_ERROR;
 
   // This is used to autoclear the error message on the LCD otherwise you can't tell if a new
   // error code is present
   } else if (errorCode && LCDErrctr++ > LCD_CLEAR_ERROR_THRESHOLD) {
-    if (flags & DECODERTTY) LCDSignalError (0);
+    if (flags & DECODERTTY || errorCode == DECODE_BUDGET_EXCEEDED) LCDSignalError (0);
     errorCode = 0;
     LCDErrctr = 0;
   }
@@ -211,6 +198,78 @@ void DecodeLoop( void )
 }
 
 
+void DecodeRTTYBlock (void)
+{
+// This routine decodes a RTTY block (rttybuff) captured by the ADC interupt. 
+// Sampling is continuous (no Stop/Start per bit). Each block the Mark and Space power is measured (Goertzel)
+// and passed to the bit synchronizer (DPLL) in RTTYBitSync() with the number of samples since the last block.
+// RTTYBitSync() tracks the bit edges, decides each bit and calls DecodeRTTY() to frame the baudot character.
+// If a start bit, 5 data bits and a stop bit received, then the character is converted from baudot to ASCII and returned
+// First check the carrier detect gate. Power at the Mark and Space frequencies (Goertzel) is compared
+// to the out of band noise. If no carrier then the bit synchronizer sees no Mark or Space
+// When PSK is also being decoded, PSK owns the signal level display and the threshold
+
+  char currentChar;         // Current decode ASCII character
+  unsigned long start;      // Used to measure processing time
+  long markpwr, spacepwr;   // RTTY Mark and Space power in block
+  unsigned int elapsed;     // Samples since last RTTY block
+
+  start = micros();
+  elapsed = rttyBlockStamp - rttyLastStamp;
+  rttyLastStamp = rttyBlockStamp;
+  blockEnergy = BlockEnergy (rttybuff, CORRBUFFSZ);
+  corrRTTY = blockEnergy;
+  markpwr = GoertzelPower (rttybuff, CORRBUFFSZ, rttyMarkCoeff);
+  spacepwr = GoertzelPower (rttybuff, CORRBUFFSZ, rttySpaceCoeff);
+  blockSigPwr = markpwr + spacepwr;
+  flags &= ~RTTYDONE;               // Signal the ADC samping interrupt that rttybuff can be reused
+  
+  if (CarrierDetect (&rttySquelch, blockSigPwr, blockEnergy, RTTY_SQUELCH_RATIO, RTTY_SQUELCH_HANG)) {
+    currentChar = RTTYBitSync (markpwr, spacepwr, elapsed);
+    rttySquelch.openTime += micros() - start;
+
+  // No carrier so no Mark or Space (i.e. unknown bits)
+  } else {
+    if (!(flags & DECODEPSK)) corrDly = 0;
+    currentChar = RTTYBitSync (0, 0, elapsed);
+    rttySquelch.closedTime += micros() - start;
+  }
+
+  // Can either display signal levels or display received characters.
+  // Arduino does not have the horsepower to do both. Also the LCD screen is far
+  // to slow to allow updates such as this.  Since LCD using I2C, a faster Arduino may 
+  // make this possible but with 16Mhz arduino LCD updates are VERY slow!! 
+  if (flags & DISPLAY_SIGNAL_LEVEL) {
+    if (!(flags & DECODEPSK)) {
+      SignalLevel (corrRTTY, 'R');
+      LCDDisplayLevel ();
+    }
+
+  // If character present and RTTY appears to be synchronized, then display current character
+  // Characters decoded when carrier detect gate is closed are noise so not displayed
+  } else if (rttyLocked && currentChar && !rttySquelch.hang) {
+    rttySquelch.blocked++;
+
+  } else if (rttyLocked && currentChar) {
+    rttySquelch.chars++;
+    LCDDisplayCharacter(currentChar);
+    LoadCallSign (currentChar);     // This is supposed to capture the call sign...work in progress
+  }
+
+  // Update threashold value base on the average correlation value for 0 delay. Should be positive
+  // Simply take 1/2 of the average RTTY correlation value.
+  if ((flags & MEASURETHRESHOLD) && !(flags & DECODEPSK)) {
+    magThresh = corrRTTY >> 2;
+    SignalLevel (corrRTTY, 'R');
+    LCDDisplayLevel ();
+    Serial1.print (corrRTTY);
+    Serial1.print (" ");
+    Serial1.println (magThresh);
+    flags &= ~MEASURETHRESHOLD;
+  } 
+}
+
+
 void UpdateFrequencyData (unsigned char updateFrequency)
 {
 
@@ -220,31 +279,78 @@ void UpdateFrequencyData (unsigned char updateFrequency)
   // Arduino just does not have the horsepower
   if (encoderState & 0x1) {
     LCDDisplayFrequencyIncrement ();            // Update LCD with increment
-        encoderState &= ~0x1;                   // Clear the signal
+
+    // Clear the signal. encoderState is shared with Timer 1 ISR (rotation sets 0x2)
+    cli();
+    encoderState &= ~0x1;
+    sei();
   }
   
-  if (encoderState & 0x2) {
-    // Encoder was rotated to update the various frequencies used to Rx and Tx
-    rttyTransmitSpaceFreq = frequency_clk0 - RTTY_SHIFT_FREQUENCY + TX_FREQUENCY_OFFSET;
-    rttyTransmitMarkFreq = frequency_clk0 + TX_FREQUENCY_OFFSET;
+  // Encoder was rotated. Steps are accumulated and applied as a batch (at most every ENC_UPDATE_MS)
+  if ((encoderState & 0x2) && ApplyEncoderSteps ()) {
+    // Update the various frequencies used to Rx and Tx. RTTY Mark/Space registers are calculated when RTTY Tx starts
     frequency_clk0_tx = frequency_clk0 + TX_FREQUENCY_OFFSET;
 
+    // While transmitting the Tx timers key the Si5351 (see WorkQueue.cpp) so it is not retuned here. Only the dial
+    // changes and the new frequency is programmed when Tx stops (SetFrequency() after StopTransmitter())
     // If the receiver or the waterfall is running then change frequency
     // Updating the frequency takes some time (calculating Si5351 dividers and I2C communications) and
     // will cause RTTY/PSK decode errors. Arduino horsepower thing....
-    if (flags & REALTIME || flags & DOFHT) {
-      if (updateFrequency) SetFrequency (frequency_clk0);
+    // So while decoding small steps only move the decoder tones (see FineTune())
+    if (flags & TRANSMITPSK || flags & TRANSMITRTTY) {
+      // Dial only
+    } else if (flags & REALTIME || flags & DOFHT) {
+      if (updateFrequency && !FineTune ()) SetFrequency (frequency_clk0);
     } else {
       if (updateFrequency) SetFrequency (frequency_clk0_tx);
     }
 
-    // Finally update the frequency on the LCD and clear the signal
+    // Finally update the frequency on the LCD. Signal cleared by ApplyEncoderSteps()
     LCDDisplayFrequency ();
-    encoderState &= ~0x2;
   }
   
 }
 
+unsigned char FineTune (void)
+{
+// Routine to follow the dial (frequency_clk0) by moving the decoder tones when decoding and the dial is within
+// the window of the programmed Si5351 frequency. The audio tone of a signal moves up by the dial offset.
+// Returns 0 if the Si5351 must be retuned (outside window or not decoding). Tones are then set back to nominal
+  long offset;
+  int window;
+
+  window = 0;
+  if (flags & REALTIME) {
+    if (flags & DECODERTTY) window = TUNE_WINDOW_RTTY;
+    if (flags & DECODEPSK) window = TUNE_WINDOW_PSK;      // Narrower window also used for dual decode
+  }
+
+  offset = (long)frequency_clk0 - (long)clk0ctl.freq;
+  if (!clk0ctl.freq || offset > window || offset < -window) offset = 0;
+
+  // Coefficients use floating point so only update if changed
+  if (offset != tuneOffset) {
+    tuneOffset = offset;
+    SetRTTYTones (tuneOffset);
+    SetPSKTone (tuneOffset);
+  }
+
+  if (!offset && frequency_clk0 != clk0ctl.freq) return 0;
+
+  tuneSteps++;
+  return 1;
+}
+
+void EndFineTune (void)
+{
+// Routine to end fine tuning when decoding starts or stops. The Si5351 is retuned to the dial frequency (i.e. one
+// retune for all the steps followed by FineTune()) and the decoder tones are set back to nominal
+  if (tuneOffset) SetFrequency (frequency_clk0);
+  tuneOffset = 0;
+  SetRTTYTones (0);
+  SetPSKTone (0);
+}
+
 void SignalLevel (long rawlevel, char mode)
 {
 
@@ -357,6 +463,90 @@ void SignalLevel (long rawlevel, char mode)
 }
 
 
+unsigned char CarrierDetect (Squelch_def *sq, unsigned long sigpwr, unsigned long energy, unsigned char ratio, unsigned char hang)
+{
+// This routine is a cheap carrier detect (squelch) used to skip the correlation search when the band is empty.
+// The in band power (sigpwr) is compared to the out of band energy which is averaged to give an adaptive noise floor.
+// Out of band energy is used so that a strong signal does not raise the noise floor.
+// The gate is held open for "hang" blocks after the carrier is detected.  Returns 1 if open, 0 if closed
+// An open that closes again without a character displayed (sq->chars) is counted as a false open
+// Each decoder has its own gate (sq) so that RTTY and PSK can be decoded at the same time
+
+  long noise;
+
+  // Update noise floor (average out of band energy)
+  if (energy > sigpwr) noise = energy - sigpwr;
+  else noise = 0;
+  sq->noise += (noise - sq->noise) / SQUELCH_AVERAGE;
+
+  sq->total++;
+  if (sigpwr * SQUELCH_SCALE > (unsigned long)sq->noise * ratio) {
+    if (!sq->hang) {
+      sq->opens++;
+      sq->openChars = sq->chars;
+    }
+    sq->hang = hang;
+  } else if (sq->hang) {
+    if (!--sq->hang && sq->chars == sq->openChars) sq->falseOpens++;   // Noise opened the gate
+  }
+
+  if (!sq->hang) {
+    sq->closed++;
+    return 0;
+  }
+  return 1;
+}
+
+void ResetCarrierDetect (Squelch_def *sq)
+{
+// Routine to reset the carrier detect gate and its statistics
+  memset ((char *)sq, 0, sizeof(Squelch_def));
+}
+
+
+void CheckDecodeBudget (unsigned long busy)
+{
+// This routine measures the CPU load of decoding. busy is the time (us) spent processing blocks in the
+// current pass of DecodeLoop(). The load (%) is calculated over DECODE_BUDGET_WINDOW.  If the load is above
+// DECODE_BUDGET_LIMIT or blocks were dropped (overruns) then the budget is exceeded and its reported (once per window)
+// Only reported on the LCD for dual decode. PSK on its own has numerious overruns (see DISPLAY_ERROR in DecodeLoop())
+
+  unsigned long now, window, overruns;
+
+  decodeBusy += busy;
+  now = micros();
+  window = now - decodeWindowStart;
+  if (window < DECODE_BUDGET_WINDOW) return;
+
+  decodeLoad = (decodeBusy * 100) / window;
+  if (decodeLoad > decodeLoadMax) decodeLoadMax = decodeLoad;
+  overruns = (unsigned long)rttyOverruns + pskOverruns;
+
+  if (decodeLoad > DECODE_BUDGET_LIMIT || overruns != decodeOverrunsLast) {
+    decodeBudgetExceeded++;
+    if ((flags & DECODERTTY) && (flags & DECODEPSK)) {
+      errorCode = DECODE_BUDGET_EXCEEDED;
+      LCDSignalError (errorCode);
+    }
+  }
+
+  decodeOverrunsLast = overruns;
+  decodeBusy = 0;
+  decodeWindowStart = micros();
+}
+
+void ResetDecodeBudget (void)
+{
+// Routine to reset the decode CPU budget measurement
+  decodeBusy = 0;
+  decodeLoad = decodeLoadMax = 0;
+  decodeBudgetExceeded = 0;
+  rttyOverruns = pskOverruns = 0;
+  decodeOverrunsLast = 0;
+  decodeWindowStart = micros();
+}
+
+
 void RTTYControl (char function)
 {
 // This function is used to control RTTY Rx
@@ -365,6 +555,7 @@ void RTTYControl (char function)
   if (function == 'D') {
     DisableTimers (1);              // Timer 1 is for 5ms for Rotary
     StopSampling();
+    EndFineTune ();
     flags &= ~REALTIME;
     flags &= ~MEASURETHRESHOLD;
     flags &= ~DECODERTTY;
@@ -372,6 +563,8 @@ void RTTYControl (char function)
   // if no sub commands then start RTTY decode.
   } else {
     ResetRTTY();
+    ResetCarrierDetect(&rttySquelch);
+    ResetDecodeBudget();
     flags |= REALTIME;
     flags |= DECODERTTY;
     levelctr = 0;
@@ -391,6 +584,7 @@ void PSKControl (char function)
   if (function == 'D') {
     DisableTimers (1);              // Timer 1 is for 5ms for Rotary
     StopSampling();
+    EndFineTune ();
     flags &= ~MEASURETHRESHOLD;
     flags &= ~PROCESSINGDONE;
     flags &= ~REALTIME;
@@ -401,6 +595,8 @@ void PSKControl (char function)
   // if no sub commands then start dPSKecode.
   } else {
     ResetPSK();
+    ResetCarrierDetect(&pskSquelch);
+    ResetDecodeBudget();
     flags |= PROCESSINGDONE;
     flags |= REALTIME;
     flags |= DECODEPSK;
@@ -415,6 +611,37 @@ void PSKControl (char function)
 }
 
 
+void DualControl (char function)
+{
+// This function is used to control RTTY and PSK Rx at the same time (dual decode)
+// Both decoders work on the same samples.  RTTY uses rttybuff (RTTYDONE) and PSK uses corrbuff/corrbufflag (ADCDONE)
+
+  // Disable RTTY and PSK
+  if (function == 'D') {
+    RTTYControl ('D');
+    PSKControl ('D');
+
+  // if no sub commands then start RTTY and PSK decode.
+  } else {
+    ResetRTTY();
+    ResetPSK();
+    ResetCarrierDetect(&rttySquelch);
+    ResetCarrierDetect(&pskSquelch);
+    ResetDecodeBudget();
+    flags |= PROCESSINGDONE;
+    flags |= REALTIME;
+    flags |= DECODEPSK;
+    flags |= DECODERTTY;
+    flags &= ~BUFF1DONE;
+    flags &= ~CHECKPSKVALUE;
+    levelctr = 0;
+    maxCorrLevel = 0;
+    EnableTimers (1, TIMER3MS);         // Timer 1 is for Rotary 
+    StartSampling ();
+  }
+}
+
+
 void SignalError (unsigned long errorcode)
 {
 // Routine similar to LCD routine to display errors except error is displayed on Serial1
@@ -436,6 +663,10 @@ void SignalError (unsigned long errorcode)
       Serial1.println((char *)"PND");
       break;
 
+    case DECODE_BUDGET_EXCEEDED:
+      Serial1.println((char *)"CPU");
+      break;
+
     case FREQUENCY_BAD_CHANNEL:
       Serial1.println((char *)"BC");
       break;
@@ -6,16 +6,51 @@
 #define MAX_THRESHDIVIDER 11
 #define DEFAULT_THRESHDIVIDER 8
 
+// Carrier detect (squelch). Ratio is in band power vs out of band noise x16 (i.e. 16 is 1:1)
+#define SQUELCH_SCALE 16
+#define SQUELCH_AVERAGE 32                // Noise floor averaging (blocks)
+#define PSK_SQUELCH_RATIO 44              // 1Khz I/Q of two 13 sample blocks gets ~0.3 of receiver noise so open at ~2.75
+#define PSK_SQUELCH_HANG 48               // ~4 bits. PSK envelope goes to zero at each phase reversal (see HostTests/SquelchTest.cpp)
+#define RTTY_SQUELCH_RATIO 32             // Mark + Space bins of 40 samples get ~0.2 of receiver noise so noise averages ~4
+#define RTTY_SQUELCH_HANG 20              // ~4 bits. Open 0.4% on noise, held at 0 dB SNR (see HostTests/SquelchTest.cpp)
+
+// Dual RTTY/PSK decode CPU budget. Load is the % of time spent processing blocks (both decoders and display)
+#define DECODE_BUDGET_WINDOW 1000000UL     // Measurement window (us)
+#define DECODE_BUDGET_LIMIT 90            // Maximum load (%) before budget is exceeded
+
+// Fine tuning while decoding. Encoder steps within the window (Hz) of the programmed Si5351 frequency move the
+// decoder tones instead of retuning. PSK window is narrower as the phase shift delay search (0-8) assumes ~1Khz
+#define TUNE_WINDOW_RTTY 500
+#define TUNE_WINDOW_PSK 100
+
+// Carrier detect (squelch) state and statistics. One per decoder so that RTTY and PSK can be decoded at the same time
+typedef struct {
+  long noise;                             // Adaptive noise floor (average out of band energy)
+  unsigned char hang;                     // Number of blocks to hold gate open
+  unsigned long total, closed;            // Blocks processed and blocks skipped
+  unsigned long openTime, closedTime;     // Processing time (us) for open and skipped blocks
+  unsigned int chars, blocked;            // Characters displayed and characters blocked by gate
+  unsigned int opens, falseOpens;         // Times gate opened and times it closed again without a character displayed
+  unsigned int openChars;                 // Characters displayed when gate opened
+} Squelch_def;
 
 
 // Decoding Routines
 void DecodeLoop( void );
+void DecodeRTTYBlock (void);
 void RTTYControl (char function);
 void PSKControl (char function);
+void DualControl (char function);
+void CheckDecodeBudget (unsigned long busy);
+void ResetDecodeBudget (void);
 void SignalError (unsigned long errorcode);
 void DisplayLevel (void);
 void UpdateFrequencyData (unsigned char updateFrequency);
+unsigned char FineTune (void);
+void EndFineTune (void);
 void SignalLevel (long rawlevel, char mode);
 long fpRound (long value, int divisor);
+unsigned char CarrierDetect (Squelch_def *sq, unsigned long sigpwr, unsigned long energy, unsigned char ratio, unsigned char hang);
+void ResetCarrierDetect (Squelch_def *sq);
 
 #endif // _DECODE_H_
@@ -1,9 +1,14 @@
 #ifndef _ENCODER_H_
 #define _ENCODER_H_
 
+#define ENC_UPDATE_MS 50            // Minimum time between frequency updates (Si5351 and LCD) for accumulated steps
+#define ENC_ACCEL_TICKS 8           // Detents less than this many polls (3 ms) apart are accelerated
+#define ENC_ACCEL_FACTOR 4          // Steps per detent when accelerated
+#define ENC_COUNT_LIMIT 10000       // Maximum accumulated steps. Steps beyond this are dropped (counted in encoderDropped)
+
 // Encoder Routines
 int ReadEncoder(void);
-unsigned long ReadPBEncoder(void);
 void CheckEncoder (void);
+unsigned char ApplyEncoderSteps (void);
 
 #endif // _ENCODER_H_
@@ -10,10 +10,27 @@ Routines Written by Dave Rajnauth, VE3OOI to control and format the LCD display
 
 #include "AllExternVariables.h"
 
+
+// 16 bit (5/6/5) colour at compile time
+constexpr unsigned int LCDColor565 (unsigned char r, unsigned char g, unsigned char b)
+{
+  return ((unsigned int)(r & 0xF8) << 8) | ((unsigned int)(g & 0xFC) << 3) | (b >> 3);
+}
+
+// Waterfall palette. FFT level (fht_log_out[] scaled by WF_PALETTE_SCALE) to colour. Black (noise) to white (strong)
+constexpr unsigned int wfPalette[WF_PALETTE_SIZE] PROGMEM = {
+  LCDColor565 (0, 0, 0),      LCDColor565 (0, 0, 64),     LCDColor565 (0, 0, 128),    LCDColor565 (0, 0, 192),
+  LCDColor565 (0, 0, 255),    LCDColor565 (0, 96, 255),   LCDColor565 (0, 192, 255),  LCDColor565 (0, 255, 192),
+  LCDColor565 (0, 255, 64),   LCDColor565 (128, 255, 0),  LCDColor565 (255, 255, 0),  LCDColor565 (255, 192, 0),
+  LCDColor565 (255, 128, 0),  LCDColor565 (255, 0, 0),    LCDColor565 (255, 128, 128), LCDColor565 (255, 255, 255)
+};
+
+
 void LCDBlank (void) 
 {
 // Routine to disable or turn off LCD Screen
   ToggleSampling (0);     // LCD functions are slow and need to disable data sampling.
+  LCDStopWaterfallScroll ();
   tft.begin();
   tft.fillScreen(ILI9340_BLACK);
   ToggleSampling (1);
@@ -40,6 +57,7 @@ void LCDDisplaySetup()
   // Currently not used. All decode goes to LCD
   flags |= USE_LCD;
 
+  LCDStopWaterfallScroll ();
   tft.begin();     
   tft.fillScreen(ILI9340_BLACK);
 
@@ -62,7 +80,8 @@ void LCDDisplaySetup()
   // Populate the LCD with default values
   LCDDisplayFrequency ();
   LCDDisplayFrequencyIncrement ();
-  if (flags & DECODERTTY) LCDDisplayMode ((char *)"RTTY Rx");
+  if ((flags & DECODERTTY) && (flags & DECODEPSK)) LCDDisplayMode ((char *)"Dual Rx");
+  else if (flags & DECODERTTY) LCDDisplayMode ((char *)"RTTY Rx");
   else if (flags & DECODEPSK) LCDDisplayMode ((char *)"PSK Rx");
   else if (flags & TRANSMITPSK) LCDDisplayMode ((char *)"PSK Tx");
   else if (flags & TRANSMITRTTY) LCDDisplayMode ((char *)"RTTY Rx");
@@ -87,6 +106,7 @@ void LCDClearWaterfallWindow (void)
 { 
 // Routine to clear the waterfall/spectrum window
    
+  LCDStopWaterfallScroll ();
   tft.fillRect(MIN_X, WF_START_Y, MAX_X, WF_WIN_SIZE, ILI9340_RED);
   tft.setTextColor(ILI9340_WHITE); 
   tft.setTextSize(1);
@@ -102,21 +122,21 @@ void LCDDrawWaterfallWindowMarkers (unsigned char narrow)
   
   if (narrow) {
     // Draw Window divider between FFT and correlation
-    x1 = 120;
+    x1 = PB_WINDOW_WIDTH;
     x2 = WF_BIN_WIDTH-2;
     y1 = WF_START_Y;
     y2 = WF_WIN_SIZE;
     tft.fillRect(x1, y1, x2, y2, ILI9340_GREEN);   
 
-    marker = MARK_FREQUENCY_CBIN - (MARK_FREQUENCY_CBIN-2);
-    x1 = 120 + marker*PB_BIN_WIDTH + PB_BIN_WIDTH/2 - WF_BIN_WIDTH/2;
+    marker = rttyMarkCBin - (rttyMarkCBin-2);
+    x1 = PB_WINDOW_WIDTH + marker*rttyPBBinWidth + rttyPBBinWidth/2 - WF_BIN_WIDTH/2;
     x2 = WF_BIN_WIDTH/2;
     y1 = WF_START_Y;
     y2 = WF_WIN_SIZE;
     tft.fillRect(x1, y1, x2, y2, ILI9340_BLACK);
 
-    marker = SPACE_FREQUENCY_CBIN - (MARK_FREQUENCY_CBIN-2);
-    x1 = 120 + marker*PB_BIN_WIDTH + PB_BIN_WIDTH/2 - WF_BIN_WIDTH/2;
+    marker = rttySpaceCBin - (rttyMarkCBin-2);
+    x1 = PB_WINDOW_WIDTH + marker*rttyPBBinWidth + rttyPBBinWidth/2 - WF_BIN_WIDTH/2;
     x2 = WF_BIN_WIDTH/2;
     y1 = WF_START_Y;
     y2 = WF_WIN_SIZE;
@@ -124,15 +144,15 @@ void LCDDrawWaterfallWindowMarkers (unsigned char narrow)
 
   // Wideband mode so display the SPACE/MARK passband
   } else {
-    marker = MARK_FREQUENCY_BIN - (SPACE_FREQUENCY_BIN-2);
-    x1 = marker*PB_BIN_WIDTH + PB_BIN_WIDTH/2 - WF_BIN_WIDTH/2;
+    marker = rttyMarkFFTBin - (rttySpaceFFTBin-2);
+    x1 = marker*rttyPBBinWidth + rttyPBBinWidth/2 - WF_BIN_WIDTH/2;
     x2 = WF_BIN_WIDTH-3;
     y1 = WF_START_Y;
     y2 = WF_WIN_SIZE;
     tft.fillRect(x1, y1, x2, y2, ILI9340_BLACK);
 
-    marker = SPACE_FREQUENCY_BIN - (SPACE_FREQUENCY_BIN-2);
-    x1 = marker*PB_BIN_WIDTH + PB_BIN_WIDTH/2 - WF_BIN_WIDTH/2;
+    marker = rttySpaceFFTBin - (rttySpaceFFTBin-2);
+    x1 = marker*rttyPBBinWidth + rttyPBBinWidth/2 - WF_BIN_WIDTH/2;
     x2 = WF_BIN_WIDTH-3;
     y1 = WF_START_Y;
     y2 = WF_WIN_SIZE;
@@ -150,7 +170,7 @@ void LCDDisplayPassbandWaterfall (void)
 // Left half should the same for the correlation frequency prediction
       
   unsigned char sucess;
-  int i;
+  int i, cbin;
   volatile long height;
   unsigned int x1, x2, y1, y2;
   
@@ -164,8 +184,8 @@ void LCDDisplayPassbandWaterfall (void)
 
   // First display FFT bins 2 bins before Space frequency to 2 bin past Mark frequency
   // Define initial value
-  old = fht_log_out[ (SPACE_FREQUENCY_BIN-3)];
-  for (i=(SPACE_FREQUENCY_BIN-2); i<=(MARK_FREQUENCY_BIN+2); i++) {
+  old = fht_log_out[ (rttySpaceFFTBin-3)];
+  for (i=(rttySpaceFFTBin-2); i<=(rttyMarkFFTBin+2); i++) {
     fftval  = fht_log_out[i];         // FFT output value for bin i
 
     // Perform peak detection
@@ -213,14 +233,14 @@ void LCDDisplayPassbandWaterfall (void)
   LCDClearWaterfallWindow ();
   
 // Display FFT bin number in first half of display
-  if (peakbin >= (SPACE_FREQUENCY_BIN-2) && peakbin <= (MARK_FREQUENCY_BIN+2)) {
-    peakbin -= (SPACE_FREQUENCY_BIN-2);  // shift bins to start from 0
+  if (peakbin >= (rttySpaceFFTBin-2) && peakbin <= (rttyMarkFFTBin+2)) {
+    peakbin -= (rttySpaceFFTBin-2);  // shift bins to start from 0
 
     // Height is measured top down (i.e. 0,0 is top left corner)
     height = height * MAX_WF_HEIGHT / MAX_WF_VALUE;         
     if (height > MAX_WF_HEIGHT) height = MAX_WF_HEIGHT;
-    x1 = peakbin*PB_BIN_WIDTH;
-    x2 = PB_BIN_WIDTH-1;
+    x1 = peakbin*rttyPBBinWidth;
+    x2 = rttyPBBinWidth-1;
     y1 = WF_END_Y - height + 2;
     y2 = height;
     tft.fillRect(x1, y1, x2, y2, ILI9340_YELLOW);
@@ -232,14 +252,15 @@ void LCDDisplayPassbandWaterfall (void)
 
   // Display correlation bin number in second half of display
   // Same process as above except horizontal shift on LCD
-  if (corrDly <= (SPACE_FREQUENCY_CBIN+2) && corrDly >= (MARK_FREQUENCY_CBIN-2)) {
-    corrDly -= (MARK_FREQUENCY_CBIN-2);  // shift bins to start from 0
+  // Signed because corrDly is unsigned and rttyMarkCBin-2 is negative for a mark bin below 2
+  cbin = (int)corrDly - (rttyMarkCBin-2);     // shift bins to start from 0
+  if (cbin >= 0 && cbin <= rttySpaceCBin - rttyMarkCBin + 4) {
 
     // Height is measured top down (i.e. 0,0 is top left corner)
     height = height * MAX_WF_HEIGHT / MAX_WF_VALUE;
     if (height > MAX_WF_HEIGHT) height = MAX_WF_HEIGHT;
-    x1 = 120 + corrDly*PB_BIN_WIDTH;
-    x2 = PB_BIN_WIDTH-1;
+    x1 = PB_WINDOW_WIDTH + cbin*rttyPBBinWidth;
+    x2 = rttyPBBinWidth-1;
     y1 = WF_END_Y - height + 2;
     y2 = height;
     tft.fillRect(x1, y1, x2, y2, ILI9340_BLUE);
@@ -272,8 +293,117 @@ long fpRound (long value, int divisor)
 
 void LCDDisplayWaterFall (void)
 {
-// Routine to display FFT in wideband mode in Waterfall display window
-// Take the FFT output and scale
+// Routine to display FFT in wideband mode as a scrolling waterfall. Each row (fht_log_out[]) is one LCD line with
+// a colour for each bin.  The line is written with one address window and a burst of pixels (chip select is held
+// low) and the LCD scrolls the older rows.  wfRowTime is the time to draw the row
+
+  unsigned char i, j, level;
+  unsigned int color, marker;
+  unsigned long start;
+
+  if (!wfScrollLine) LCDStartWaterfallScroll ();
+
+  start = micros();
+
+  // Newest row goes on the line above the last one (wraps to bottom of scroll area)
+  if (wfScrollLine == WF_START_Y) wfScrollLine = WF_START_Y + WF_WIN_SIZE;
+  wfScrollLine--;
+
+  tft.setAddrWindow (MIN_X, wfScrollLine, MIN_X + WF_ROW_BINS * WF_BIN_WIDTH - 1, wfScrollLine);
+  PinHigh(TFT_DC);
+  PinLow(TFT_CS);
+  for (i=0; i<WF_ROW_BINS; i++) {
+    level = 0;
+    if (i >= 2) {                           // Skip DC bins
+      level = ((unsigned int)fht_log_out[i] * WF_PALETTE_SCALE) >> 8;
+      if (level >= WF_PALETTE_SIZE) level = WF_PALETTE_SIZE-1;
+    }
+    color = pgm_read_word (&wfPalette[level]);
+
+    // Last pixel of the Space and Mark bins is a marker
+    marker = color;
+    if (i == rttyMarkFFTBin || i == rttySpaceFFTBin) marker = WF_MARKER_COLOR;
+
+    for (j=0; j<WF_BIN_WIDTH-1; j++) {
+      SPI.transfer (color >> 8);
+      SPI.transfer (color);
+    }
+    SPI.transfer (marker >> 8);
+    SPI.transfer (marker);
+  }
+  PinHigh(TFT_CS);
+
+  LCDSetScrollStart (wfScrollLine);
+
+  wfRowTime = micros() - start;
+  if (wfRowTime > wfRowMaxTime) wfRowMaxTime = wfRowTime;
+}
+
+
+void LCDStartWaterfallScroll (void)
+{
+// Routine to clear the waterfall window and make it the LCD vertical scroll area
+
+  tft.fillRect(MIN_X, WF_START_Y, MAX_X, WF_WIN_SIZE, ILI9340_BLACK);
+
+  tft.writecommand (ILI9340_CMD_VSCRDEF);
+  tft.writedata (WF_START_Y >> 8);
+  tft.writedata (WF_START_Y & 0xFF);
+  tft.writedata (WF_WIN_SIZE >> 8);
+  tft.writedata (WF_WIN_SIZE & 0xFF);
+  tft.writedata (WF_SCROLL_BOTTOM >> 8);
+  tft.writedata (WF_SCROLL_BOTTOM & 0xFF);
+
+  wfScrollLine = WF_START_Y;
+  LCDSetScrollStart (wfScrollLine);
+}
+
+
+void LCDStopWaterfallScroll (void)
+{
+// Routine to stop scrolling so that the waterfall window can be drawn normally (e.g. menu, narrow display)
+// The window still has the waterfall and needs to be redrawn
+
+  if (!wfScrollLine) return;
+  LCDSetScrollStart (WF_START_Y);        // Scroll area shown unscrolled
+  wfScrollLine = 0;
+}
+
+
+void LCDSetScrollStart (unsigned int line)
+{
+// Routine to set the LCD line displayed at the top of the scroll area
+
+  tft.writecommand (ILI9340_CMD_VSCRSADD);
+  tft.writedata (line >> 8);
+  tft.writedata (line & 0xFF);
+}
+
+
+void LCDMeasureWaterfall (void)
+{
+// Routine to measure the time to draw a bar graph spectrum and a waterfall row (with a typical FFT level)
+// Displayed with ^Q.  The waterfall window is cleared after
+
+  unsigned long start;
+
+  memset (fht_log_out, MAX_WF_VALUE/2, sizeof(fht_log_out));
+
+  start = micros();
+  LCDDisplaySpectrum ();
+  wfBarTime = micros() - start;
+
+  LCDDisplayWaterFall ();
+
+  memset (fht_log_out, 0, sizeof(fht_log_out));
+  LCDClearWaterfallWindow ();
+}
+
+
+void LCDDisplaySpectrum (void)
+{
+// Routine to display FFT in wideband mode as a bar graph in Waterfall display window (VERY SLOW!!!)
+// Take the FFT output and scale. No longer used for display, LCDMeasureWaterfall() compares its time with the waterfall
 
   int i;
   unsigned int height;
@@ -297,13 +427,13 @@ void LCDDisplayWaterFall (void)
     tft.fillRect(x1, y1, x2, y2, ILI9340_YELLOW);
 
     // Display passband markers over spectrum for Space and Mark frequencies
-    if (i == MARK_FREQUENCY_BIN) {
+    if (i == rttyMarkFFTBin) {
       x1 = i*WF_BIN_WIDTH+2;
       x2 = WF_BIN_WIDTH-2;
       y1 = WF_START_Y;
       y2 = WF_WIN_SIZE;
       tft.fillRect(x1, y1, x2, y2, ILI9340_BLACK);
-    } else if (i == SPACE_FREQUENCY_BIN) {
+    } else if (i == rttySpaceFFTBin) {
       x1 = i*WF_BIN_WIDTH+2;
       x2 = WF_BIN_WIDTH-2;
       y1 = WF_START_Y;
@@ -332,6 +462,12 @@ void LCDDisplayInfo (void)
   tft.print (pskbinthresh);
   tft.print (" Thresh: ");
   tft.println (magThresh);
+  tft.print ("PSK SNR: ");
+  tft.print (pskSNR);
+  tft.print (" IMD: ");
+  tft.print (pskIMD);
+  tft.print (" Phase Err: ");
+  tft.println (pskPhaseErr);
 
   tft.print ("RTTY Space Freq: ");
   tft.print (rttySpaceFreq);
@@ -343,6 +479,12 @@ void LCDDisplayInfo (void)
   tft.println (rttyMarkBin);
   tft.print ("RTTY Thresh: ");
   tft.println (magThresh);
+  tft.print ("RTTY Baud: ");
+  tft.print (rttyBaud / 100);
+  tft.print (".");
+  tft.print (rttyBaud % 100);
+  tft.print (" Shift: ");
+  tft.println (rttyShift);
 
   tft.print ("Tx Freq Offset: ");
   tft.print (TX_FREQUENCY_OFFSET);
@@ -507,7 +649,7 @@ void LCDSignalError (unsigned long errorcode)
 
   // Display Txt assocaited with error code
   switch (errorcode) {
-    case NULL:
+    case 0:
       tft.print((char *)"----");
       break;
       
@@ -523,6 +665,10 @@ void LCDSignalError (unsigned long errorcode)
       tft.print((char *)"OVR");
       break;
 
+    case DECODE_BUDGET_EXCEEDED:
+      tft.print((char *)"CPU");
+      break;
+
     case FREQUENCY_BAD_CHANNEL:
       tft.print((char *)"BC");
       break;
@@ -576,6 +722,38 @@ void LCDDisplayLevel (void)
 }
 
 
+void LCDDisplayPSKQuality (void)
+{
+// Routine to display PSK signal quality (SNR, IMD and phase error) in the signal level area of the data window
+  
+  ToggleSampling (0);
+  
+  // clear all prior signal levels
+  tft.fillRect(135, DATA_START_Y+20, MAX_X, DATA_END_Y-DATA_START_Y-20, ILI9340_GREEN);
+
+  tft.setTextSize(1);
+  if (pskLocked) tft.setTextColor(ILI9340_BLACK); 
+  else tft.setTextColor(ILI9340_RED);               // Not locked so characters not displayed
+
+  tft.setCursor(135, DATA_START_Y+20);
+  tft.print("SNR ");
+  tft.print(pskSNR);
+  tft.print(" dB");
+
+  tft.setCursor(135, DATA_START_Y+30);
+  tft.print("IMD ");
+  tft.print(pskIMD);
+  tft.print(" dB");
+
+  tft.setCursor(135, DATA_START_Y+40);
+  tft.print("PHS ");
+  tft.print(pskPhaseErr);
+  
+  ToggleSampling (1);
+
+}
+
+
 void LCDDisplayTest(void) 
 {
 // Routine to test out the LCD display.
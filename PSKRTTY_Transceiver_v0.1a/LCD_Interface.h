@@ -27,23 +27,39 @@
 #define MAX_WF_VALUE 100       // Max FFT value
                
 #define WF_BIN_WIDTH 5
-#define PB_BIN_WIDTH 15  
+#define WF_ROW_BINS (MAX_X / WF_BIN_WIDTH)      // FFT bins across a waterfall row
+#define PB_BIN_WIDTH 15         // Maximum bin width for narrow waterfall. Actual width is rttyPBBinWidth (depends on RTTY shift)
+#define PB_WINDOW_WIDTH 120     // Narrow waterfall is split in 2 windows (FFT and correlation)
                    
 #define MAX_DECODE_CHARACTERS 190
 #define MAX_DECODE_X 228
 #define MAX_DECODE_Y 305
   
-#define SPACE_FREQUENCY_BIN 11
-#define MARK_FREQUENCY_BIN 13        // Bin for 1000 Hz  
-
-#define SPACE_FREQUENCY_CBIN 12
-#define MARK_FREQUENCY_CBIN 10       // Bin for 1000 Hz  
+// Space/Mark FFT bins and correlation delays depend on RTTY shift. See rttySpaceFFTBin, rttyMarkFFTBin, rttySpaceCBin and rttyMarkCBin
 
 #define SPACE_FREQUENCY_XVALUE 82
 #define MARK_FREQUENCY_XVALUE 96
 #define FREQUENCY_XWIDTH 2
 
 
+// Scrolling waterfall (wide mode). The waterfall window is the ILI9340 vertical scroll area. Each row is written to
+// one LCD line and the scroll start is moved so that the newest row is at the top. Old rows are never redrawn
+#define ILI9340_CMD_VSCRDEF 0x33        // Vertical scrolling definition (top fixed, scroll area, bottom fixed lines)
+#define ILI9340_CMD_VSCRSADD 0x37       // Vertical scrolling start address (line shown at top of scroll area)
+#define WF_SCROLL_BOTTOM (MAX_Y - WF_START_Y - WF_WIN_SIZE)     // Bottom fixed area
+#define WF_PALETTE_SIZE 16
+#define WF_PALETTE_SCALE ((256 * WF_PALETTE_SIZE) / MAX_WF_VALUE) // FFT value to palette index (x256)
+#define WF_MARKER_COLOR ILI9340_WHITE  // Space/Mark bins have a marker line
+
+// LCD chip select and data/command pins (see _cs and _dc) for burst pixel writes with PinHigh()/PinLow().
+// PORTL is not in the low I/O space so these are read/modify/write. No ISR writes PORTL
+#define TFT_CS_PORT   PORTL     // Pin 45 is PL4
+#define TFT_CS_PIN    PINL
+#define TFT_CS_BIT    4
+#define TFT_DC_PORT   PORTL     // Pin 49 is PL0
+#define TFT_DC_PIN    PINL
+#define TFT_DC_BIT    0
+
 #define LCD_UPDATE_THRESHOLD 100
 
 #define LCD_CLEAR_ERROR_THRESHOLD 10000
@@ -63,7 +79,13 @@ void LCDDisplayMode (char *mode);
 void LCDDisplayCharacter (char value);
 void LCDClearDisplayWindow (void);
 void LCDDisplayLevel (void);
+void LCDDisplayPSKQuality (void);
 void LCDDisplayWaterFall (void);
+void LCDDisplaySpectrum (void);
+void LCDStartWaterfallScroll (void);
+void LCDStopWaterfallScroll (void);
+void LCDSetScrollStart (unsigned int line);
+void LCDMeasureWaterfall (void);
 void LCDDisplayPassbandWaterfall (void);
 void LCDDrawWaterfallWindowMarkers (unsigned char narrow);
 void LCDClearWaterfallWindow (void);
@@ -0,0 +1,161 @@
+/*
+
+Memory channels stored in EEPROM (after the Si5351 correction and RTTY configuration).
+
+Each channel holds the Rx frequency, mode, RTTY baud rate/shift and decode threshold together with the Si5351
+register images for Rx, PSK Tx and RTTY Mark/Space.  The images are calculated when the channel is stored so
+recalling a channel only writes registers (only the bytes that differ, see Si5351UpdateRegisters()) and no
+dividers are calculated.  The output multisynth registers only depend on the frequency (the PLL is fixed at
+900 Mhz).  The PLL registers depend on the crystal correction so they are only used if the correction has not
+changed since the channel was stored.
+
+*/
+
+#include "Arduino.h"
+
+#include "AllIncludes.h"
+
+#include "AllExternVariables.h"
+
+
+static unsigned char MemoryChecksum (Memory_def *mem)
+{
+// Routine to calculate the checksum of a channel (all bytes except the checksum)
+  unsigned char i, sum;
+  unsigned char *p;
+
+  p = (unsigned char *)mem;
+  sum = MEMORY_CHECKSUM_SEED;
+  for (i = 0; i < sizeof(Memory_def) - 1; i++) sum += p[i];
+
+  return sum;
+}
+
+
+unsigned char ReadMemory (unsigned char channel, Memory_def *mem)
+{
+// Routine to read a channel from EEPROM. Returns 0 if the channel is empty or corrupt
+  if (channel >= MEMORY_CHANNELS) return 0;
+
+  eeprom_read_block ((void *)mem, (const void *)(EEPROM_MEMORY_BASE + channel * sizeof(Memory_def)), sizeof(Memory_def));
+
+  if (mem->checksum != MemoryChecksum (mem)) return 0;
+  if (mem->mode != MEMORY_MODE_PSK && mem->mode != MEMORY_MODE_RTTY && mem->mode != MEMORY_MODE_DUAL) return 0;
+
+  return 1;
+}
+
+
+unsigned char StoreMemory (unsigned char channel)
+{
+// Routine to store the current frequency, mode, RTTY baud rate/shift and threshold in a channel. The Si5351
+// registers are calculated here so that RecallMemory() does not need to. Returns 0 if the channel is not valid
+  Memory_def mem;
+  unsigned long freq;
+
+  if (channel >= MEMORY_CHANNELS) return 0;
+
+  if ((flags & DECODERTTY) && (flags & DECODEPSK)) mem.mode = MEMORY_MODE_DUAL;
+  else if ((flags & DECODERTTY) || (flags & TRANSMITRTTY)) mem.mode = MEMORY_MODE_RTTY;
+  else mem.mode = MEMORY_MODE_PSK;
+
+  mem.rttyConfig = rttyConfig;
+  mem.freq = frequency_clk0;
+  mem.magThresh = magThresh;
+  mem.correction = multisynth.correction;
+
+  // Mark/Space registers may be for an older baud rate/shift (e.g. ^A in PSK mode)
+  UpdateRTTYTxFrequencies ();
+  memcpy (mem.markRegs, rttyMarkRegs, SI_MSREGS);
+  memcpy (mem.spaceRegs, rttySpaceRegs, SI_MSREGS);
+
+  freq = multisynth.MS_Fout;                // CalculateMSRegisters() changes multisynth so restore after
+  CalculateMSRegisters (frequency_clk0, mem.rxRegs);
+  LoadPLLRegisters (mem.pllRegs);
+  CalculateMSRegisters (frequency_clk0 + TX_FREQUENCY_OFFSET, mem.pskTxRegs);
+  if (freq) CalculateDividers (freq);
+
+  mem.checksum = MemoryChecksum (&mem);
+  eeprom_update_block ((const void *)&mem, (void *)(EEPROM_MEMORY_BASE + channel * sizeof(Memory_def)), sizeof(Memory_def));
+
+  return 1;
+}
+
+
+unsigned char RecallMemory (unsigned char channel)
+{
+// Routine to tune to a channel and start Rx in the channel's mode. The Si5351 is programmed from the stored
+// register images (no divider calculations). memRecallTime is the time to program the Si5351 (compare with
+// siSetFreqTime for SetFrequency()). Returns 0 if the channel is empty
+  Memory_def mem;
+  unsigned long start;
+  unsigned char *pll;
+
+  if (!ReadMemory (channel, &mem)) return 0;
+
+// Stop all timers otherwise bad things may happen
+  StopSampling();
+  DisableTimers (4);              // Timer 4 is for 22ms for RTTY
+  DisableTimers (3);              // Timer 3 is for 32ms for PSK
+  DisableTimers (1);              // Timer 1 is for 5ms for Rotary
+  FlushSerialPorts();
+
+  if (flags & TRANSMITPSK || flags & TRANSMITRTTY) {    // Start decode on a seperate line
+    LCDDisplayCharacter(0xD);
+    LCDDisplayCharacter(0xA);
+  }
+  StopTransmitter();                  // Disable Tx and reset
+
+  start = micros();
+
+  frequency_clk0 = mem.freq;
+  frequency_clk0_tx = mem.freq + TX_FREQUENCY_OFFSET;
+  SetRTTYConfig (mem.rttyConfig);
+  magThresh = mem.magThresh;
+
+  // Tx registers are used by ResetRTTY() and TogglePSK() instead of calculating them
+  LoadRTTYTxRegisters (mem.markRegs, mem.spaceRegs);
+  memcpy (pskTxRegs, mem.pskTxRegs, SI_MSREGS);
+  pskTxRegsFreq = frequency_clk0_tx;
+
+  // PLL registers are only valid for the correction they were calculated with. Otherwise keep the current PLL
+  pll = 0;
+  if (mem.correction == multisynth.correction) pll = mem.pllRegs;
+  if (!LoadSi5351Registers (frequency_clk0, pll, mem.rxRegs)) SetFrequency (frequency_clk0);
+
+  memRecallTime = micros() - start;
+
+  ResetRTTY();
+  ResetPSK();
+  switch (mem.mode) {
+    case MEMORY_MODE_RTTY:
+      LCDDisplayMode ((char *)"RTTY Rx");
+      break;
+    case MEMORY_MODE_PSK:
+      LCDDisplayMode ((char *)"PSK Rx");
+      break;
+    default:
+      LCDDisplayMode ((char *)"Dual Rx");
+      break;
+  }
+  LCDDisplayCharacter ('R');
+  LCDDisplayCharacter ('x');
+  LCDDisplayCharacter(0xD);
+  LCDDisplayCharacter(0xA);
+  LCDDisplayFrequency ();
+  LCDDisplayMenu(RXMENU);                   // Display Rx menu
+
+  switch (mem.mode) {
+    case MEMORY_MODE_RTTY:
+      RTTYControl (0);                      // Turn on sampling and RTTY Rx
+      break;
+    case MEMORY_MODE_PSK:
+      PSKControl (0);                       // Turn on sampling and PSK Rx
+      break;
+    default:
+      DualControl (0);                      // Turn on sampling, RTTY and PSK Rx
+      break;
+  }
+
+  return 1;
+}
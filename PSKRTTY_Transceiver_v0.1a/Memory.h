@@ -0,0 +1,32 @@
+#ifndef _MEMORY_H_
+#define _MEMORY_H_
+
+#define MEMORY_CHANNELS 8               // Channels stored in EEPROM (see EEPROM_MEMORY_BASE)
+
+// Channel modes. Anything else is an empty channel (e.g. EEPROM never written is 0xFF)
+#define MEMORY_MODE_PSK  'P'
+#define MEMORY_MODE_RTTY 'R'
+#define MEMORY_MODE_DUAL 'D'
+
+#define MEMORY_CHECKSUM_SEED 0x5A       // Checksum of an all zero channel is not zero
+
+typedef struct {
+  unsigned char mode;                   // Rx mode to start (MEMORY_MODE_xxx)
+  unsigned char rttyConfig;             // RTTY baud rate and shift selection (see SetRTTYConfig())
+  unsigned long freq;                   // Rx frequency (frequency_clk0)
+  long magThresh;                       // Decode threshold
+  long correction;                      // Si5351 correction the PLL registers were calculated with
+  unsigned char pllRegs[SI_MSREGS];     // PLL A feedback multisynth (registers 26-33)
+  unsigned char rxRegs[SI_MSREGS];      // CLK0 output multisynth (registers 42-49) for Rx
+  unsigned char pskTxRegs[SI_MSREGS];   // CLK0 output multisynth for PSK Tx (Rx + TX_FREQUENCY_OFFSET)
+  unsigned char markRegs[SI_MSREGS];    // CLK0 output multisynth for RTTY Tx Mark and Space
+  unsigned char spaceRegs[SI_MSREGS];
+  unsigned char checksum;               // Sum of all bytes above plus MEMORY_CHECKSUM_SEED
+} Memory_def;
+
+// Memory Channel Routines
+unsigned char ReadMemory (unsigned char channel, Memory_def *mem);
+unsigned char StoreMemory (unsigned char channel);
+unsigned char RecallMemory (unsigned char channel);
+
+#endif // _MEMORY_H_
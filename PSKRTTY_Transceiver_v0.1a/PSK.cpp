@@ -21,7 +21,8 @@ Therefore the inter-character gap is marked as two phase reversals.
 
 // Varicode lookup table below is reversed to accomodate shifting LSB (i.e. LSB and MSB reversed)
 // Offset in the table is the ASCII code
-const unsigned int varicode[VARICODE_TABLE_SIZE] = {
+// The table is in flash (PROGMEM) and is also used by the compiler to generate the decoding trie and length tables below
+constexpr unsigned int varicode[VARICODE_TABLE_SIZE] PROGMEM = {
   0x0355,  // 0 NUL
   0x036d,  // 1 SOH
   0x02dd,  // 2 STX
@@ -157,47 +158,184 @@ const unsigned int varicode[VARICODE_TABLE_SIZE] = {
 
 
 
+/*
+Varicode decoding trie
+
+Varicode characters start and end with a 1 bit and never have two 0 bits in a row. So "00" always marks the end of
+a character.  The bits received so far can only be one of the strings that start with 1 and don't have "00".
+There are 1, 2, 3, 5, 8,... (Fibonacci) of these strings with 1, 2, 3, 4, 5... bits. That's 231 strings up to 10 bits plus the root.
+
+The nodes are numbered level by level (level = number of bits received). Within a level, nodes that end with a 1 bit
+come first (in the same order as the level above), then the nodes that end with a 0 bit (in the same order as the 
+level above nodes that end in 1). So for node "i" at level "n":
+  - the node ends with a 1 bit if i < VaricodeLevelSize(n-1)
+  - receiving a 1 bit moves to node i at level n+1
+  - receiving a 0 bit moves to node VaricodeLevelSize(n) + i at level n+1 (only if node ends with a 1)
+  - receiving a 0 bit on a node that ends with a 0 is the "00" terminator, the character is complete
+
+The compiler walks every node back to the root to get the bits (LSB first, same as the varicode table) and searches 
+the varicode table for the character. The search is done once at compile time and not for every character received.
+*/
+
+constexpr unsigned int VaricodeLevelSize (unsigned int level)
+{
+  return level < 2 ? 1 : VaricodeLevelSize (level - 1) + VaricodeLevelSize (level - 2);
+}
+
+constexpr unsigned int VaricodeLevelBase (unsigned int level)
+{
+  return level ? VaricodeLevelBase (level - 1) + VaricodeLevelSize (level - 1) : 0;
+}
+
+constexpr unsigned int VaricodeNodeLevel (unsigned int node, unsigned int level = 0)
+{
+  return node < VaricodeLevelBase (level + 1) ? level : VaricodeNodeLevel (node, level + 1);
+}
+
+constexpr unsigned int VaricodeNodeBits (unsigned int level, unsigned int pos)
+{
+  return !level ? 0 :
+         pos < VaricodeLevelSize (level - 1) ? VaricodeNodeBits (level - 1, pos) | (1 << (level - 1)) :
+                                               VaricodeNodeBits (level - 1, pos - VaricodeLevelSize (level - 1));
+}
+
+constexpr unsigned char VaricodeSearch (unsigned int code, unsigned int ascii = 0)
+{
+  return ascii >= VARICODE_TABLE_SIZE ? VARICODE_INVALID :
+         varicode[ascii] == code ? ascii : VaricodeSearch (code, ascii + 1);
+}
+
+constexpr unsigned char VaricodeNext1 (unsigned int node)
+{
+  return node >= VARICODE_SINK1 ? (node <= VARICODE_SINK0 ? VARICODE_SINK1 : VARICODE_ROOT) :
+         VaricodeNodeLevel (node) == VARICODE_MAX_BITS ? VARICODE_SINK1 :
+         VaricodeLevelBase (VaricodeNodeLevel (node) + 1) + node - VaricodeLevelBase (VaricodeNodeLevel (node));
+}
+
+constexpr unsigned char VaricodeNext0 (unsigned int node)
+{
+  return node == VARICODE_ROOT ? VARICODE_ROOT :
+         node == VARICODE_SINK1 ? VARICODE_SINK0 :
+         node == VARICODE_SINK0 ? VARICODE_EMIT :
+         node > VARICODE_SINK0 ? VARICODE_ROOT :
+         node - VaricodeLevelBase (VaricodeNodeLevel (node)) >= VaricodeLevelSize (VaricodeNodeLevel (node) - 1) ? VARICODE_EMIT :
+         VaricodeNodeLevel (node) == VARICODE_MAX_BITS ? VARICODE_SINK0 :
+         VaricodeLevelBase (VaricodeNodeLevel (node) + 1) + VaricodeLevelSize (VaricodeNodeLevel (node)) + 
+                                                                node - VaricodeLevelBase (VaricodeNodeLevel (node));
+}
+
+constexpr unsigned char VaricodeAscii (unsigned int node)
+{
+  return node == VARICODE_ROOT ? 0 :
+         node >= VARICODE_SINK1 ? VARICODE_INVALID :
+         VaricodeSearch (VaricodeNodeBits (VaricodeNodeLevel (node), node - VaricodeLevelBase (VaricodeNodeLevel (node))));
+}
+
+constexpr unsigned char VaricodeBits (unsigned int code)
+{
+  return code ? 1 + VaricodeBits (code >> 1) : 0;
+}
+
+typedef struct {
+  unsigned char next0;      // Node for a 0 bit (phase reversal) or VARICODE_EMIT if this is the "00" terminator
+  unsigned char next1;      // Node for a 1 bit (no phase reversal)
+  unsigned char ascii;      // Character if the bits received so far are a complete varicode character
+} VaricodeNode;
+
+#define VARICODE_TRIE_NODE(n)   { VaricodeNext0 (n), VaricodeNext1 (n), VaricodeAscii (n) }
+#define VARICODE_LENGTH(n)      VaricodeBits (varicode[n])
+
+constexpr VaricodeNode varicodeTrie[VARICODE_TRIE_SIZE] PROGMEM = {
+  CODEC_ROW128 (VARICODE_TRIE_NODE, 0),
+  CODEC_ROW32 (VARICODE_TRIE_NODE, 128),
+  CODEC_ROW32 (VARICODE_TRIE_NODE, 160),
+  CODEC_ROW32 (VARICODE_TRIE_NODE, 192),
+  CODEC_ROW8 (VARICODE_TRIE_NODE, 224),
+  CODEC_ROW8 (VARICODE_TRIE_NODE, 232)
+};
+
+// Number of bits of each varicode character.  Offset is the ASCII code
+constexpr unsigned char varicodeLength[VARICODE_TABLE_SIZE] PROGMEM = {
+  CODEC_ROW128 (VARICODE_LENGTH, 0)
+};
+
+// Walk the trie with the bits of a varicode character and check that the character is found.
+constexpr unsigned char VaricodeWalk (unsigned int node, unsigned int code)
+{
+  return code ? VaricodeWalk (code & 1 ? varicodeTrie[node].next1 : varicodeTrie[node].next0, code >> 1) : node;
+}
+
+constexpr bool VaricodeTrieCheck (unsigned int ascii = 0)
+{
+  return ascii >= VARICODE_TABLE_SIZE ? true :
+         varicodeTrie[VaricodeWalk (VARICODE_ROOT, varicode[ascii])].ascii == ascii &&
+         varicodeTrie[varicodeTrie[VaricodeWalk (VARICODE_ROOT, varicode[ascii])].next0].next0 == VARICODE_EMIT &&
+         varicodeLength[ascii] <= VARICODE_MAX_BITS && VaricodeTrieCheck (ascii + 1);
+}
+
+static_assert (VaricodeLevelBase (VARICODE_TRIE_LEVELS) == VARICODE_SINK1, "Varicode trie levels do not match VARICODE_SINK1");
+static_assert (VARICODE_SINK0 < VARICODE_TRIE_SIZE && VARICODE_TRIE_SIZE < VARICODE_EMIT, "Varicode trie too big for byte nodes");
+static_assert (VaricodeTrieCheck (), "Varicode trie does not decode every character");
+
+
 unsigned int LookupVaricode (char code)
 {
 // Routine to convert ASCII code to varicode. Return varicode
 
-  return (varicode[(unsigned char)code]);
+  return pgm_read_word (&varicode[(unsigned char)code]);
 }
 
-unsigned int ConvertVaricode (unsigned int code)
+unsigned char LookupVaricodeLength (char code)
 {
-// Routine to lookup the varicode and return the ascii code
-// need to search the table entry by entry
+// Routine to return the number of bits assocatied with varicode
+// This is required to know how many bit to transmit.
 
-  unsigned int i;
+  return pgm_read_byte (&varicodeLength[(unsigned char)code]);
+}
 
-  // Search the varicode table
-  for (i=0; i<VARICODE_TABLE_SIZE; i++) {
-    if (varicode[i] == code) {
-      return i;
-    }
-  }
+unsigned char VaricodeDecodeBit (unsigned char bit)
+{
+// Routine to move to the next node in the varicode trie for a received bit.
+// Returns the ascii character when the "00" terminator is received, VARICODE_INVALID if the bits
+// received are not a varicode character, otherwise 0 (i.e. character not complete)
 
-  return 0xFF;  // Return error
+  return VaricodeNextNode (&pskNode, bit);
 }
 
-unsigned char numbits (unsigned int in)
+unsigned char VaricodeNextNode (unsigned char *trieNode, unsigned char bit)
 {
-// Routine to identify the number of bits assocatied with varicode
-// This is required to know how many bit to transmit.
+// Same as VaricodeDecodeBit() for a decoder that keeps its own trie node (VARICODE_ROOT to start) instead of pskNode
+// (e.g. the host multi-channel decoder, HostTests/BandBrowser.cpp)
 
+  unsigned char node;
 
-  unsigned char i;
-  unsigned int temp;
-  temp = in;      // Destructive manipulation of varicode so use a local temp variable
+  node = *trieNode;
 
-  // Varicode starts and ends with 1 so each bit shift must be non zero unil last bit shifted out
-  for (i=0; temp; i++) {
-    temp >>= 1;
+  // 1 bit (no phase reversal)
+  if (bit) {
+    *trieNode = pgm_read_byte (&varicodeTrie[node].next1);
+    return 0;
   }
-  
-  return i;     // Return the number of shift i.e. number of bits.
-  
+
+  // 0 bit (phase reversal). If the last bit was also a 0 then the character is complete
+  *trieNode = pgm_read_byte (&varicodeTrie[node].next0);
+  if (*trieNode != VARICODE_EMIT) return 0;
+
+  *trieNode = VARICODE_ROOT;
+  return pgm_read_byte (&varicodeTrie[node].ascii);
+}
+
+unsigned char VaricodeFlush (void)
+{
+// Routine to end the current character when the start condition (i.e. "00") is found from the phase shift timing
+// Returns the character for the bits received so far, VARICODE_INVALID if not a varicode character or 0 if no bits received
+
+  unsigned char node;
+
+  node = pskNode;
+  pskNode = VARICODE_ROOT;
+
+  return pgm_read_byte (&varicodeTrie[node].ascii);
 }
 
 
@@ -215,6 +353,7 @@ char DecodePSK (unsigned char phase)
 // DecodePSK() also convertes received varicode to ASCII
 
   char decodedcar;
+  unsigned char vcode;
 
   decodedcar = 0;
 
@@ -244,15 +383,14 @@ char DecodePSK (unsigned char phase)
       DisableTimers (3);
 //      Serial1.println ("S");        // Used for debug 
 
-      // If a start condition received and varicode received then, varicode transmission is complete
+      // If a start condition received and varicode bits received then, varicode transmission is complete
       // Note that a start condition also acts as a stop condition
-      if (pskVaricode) {
-//        Serial1.println (pskVaricode, BIN);     // Used for debug
-        pskVaricode = ConvertVaricode (pskVaricode);      // Convert varicode to ascii
+      // Normally the "00" was already received by the trie and its back at the root
+      if (pskNode != VARICODE_ROOT) {
+        decodedcar = VaricodeFlush ();                    // Get ascii for the bits received
         
-        if (pskVaricode <= VARICODE_TABLE_SIZE) {         // Check if lookup was sucessful
-          decodedcar = (char) pskVaricode;
-          pskLocked = true;
+        if (decodedcar != (char)VARICODE_INVALID) {       // Check if lookup was sucessful
+          pskLocked = PSKQualityCharacter ();             // Lock is based on signal quality of the character
         } else {                                          // Not valid varicode, do dump character (i.e. return 0 as character) and restart
           pskLocked = false;
           decodedcar = 0;
@@ -264,9 +402,7 @@ char DecodePSK (unsigned char phase)
       pskState = PSK_DATA;
       flags &= ~CHECKPSKVALUE;
       decodePhaseChange = false;      // Reset Phase to detect phase shift
-      pskVaricode = 0;                // The variable that will contain the bits received
-      bitpos = 0;                     // Bitpos is the location of the current bit to be loaded into pskVaricode
-      EnableTimers (3, TIMER32MS);    // Enable Timer 3 for bit time.  Timer sets the CHECKPSKVALUE flag to signal to check and load bit
+      EnableBaudClock (3, &pskClock); // Enable Timer 3 for bit time.  Timer sets the CHECKPSKVALUE flag to signal to check and load bit
       break;
 
       
@@ -276,17 +412,27 @@ char DecodePSK (unsigned char phase)
 //        Serial1.print ("D");          // Used for debug
 //        Serial1.print (bitpos);
 
-        // No phase shift so load 1
+        // No phase shift so 1 bit. Phase shift so 0 bit
+        // Each bit moves one node in the varicode trie. The character is returned as soon as "00" is received
         if ( !decodePhaseChange ) {     
-          pskVaricode |= (1<<bitpos);     // Load "1" bit into position bitpos (i.e. the number of shifts to load the bit)
+          vcode = VaricodeDecodeBit (1);
+          PSKQualityBit (1);
 //         Serial1.println (" 1");        // Used for debug
 
-        // Phase shift so 0 bit, not need to load it because the pskVaricode variable is zero. Just need to set the "1" bits
         } else {                          
           decodePhaseChange = false;
+          vcode = VaricodeDecodeBit (0);
+          PSKQualityBit (0);
 //          Serial1.println (" 0");       // Used for debug
         }
-        bitpos++;                         // increment bit counter for next bit
+
+        // Lock is based on the signal quality (SNR and phase error) measured over the character
+        if (vcode == VARICODE_INVALID) {      // Not valid varicode so dump character
+          pskLocked = false;
+        } else if (vcode) {                   // Character complete
+          decodedcar = (char) vcode;
+          pskLocked = PSKQualityCharacter ();
+        }
       }
 
       break;
@@ -305,6 +451,15 @@ unsigned char GetPhaseShift (void)
 
 //  corr0  = CrossCorr (corrbuff, corrbufflag, CROSSCORRSZ, 0);   // Not used anymore, using GetCorrPeak instead
 
+  // Measure signal quality (SNR, IMD and phase error). This also gives the 1Khz power used for carrier detect
+  PSKQualityBlock ();
+
+  // No carrier so skip the correlation search. No phase shift
+  if (!CarrierDetect (&pskSquelch, blockSigPwr, blockEnergy, PSK_SQUELCH_RATIO, PSK_SQUELCH_HANG)) {
+    pskLocked = false;
+    return pskPhase;
+  }
+
   // GetCorrPeak() is used to perform the cross correlation between the buffers and 
   // return the delay for the peak.  The routine only searches between delay 0 and 8. If delay > 8 its not a 1000 hz carrier
   // The routine also sets the corr0 value (correlation sum at delay 0).  Ideally corr0 should be positive if both buffers in phase
@@ -391,6 +546,246 @@ unsigned char GetPhaseShift (void)
 }
 
 
+/*
+PSK signal quality
+
+Each block pair (corrbufflag[] then corrbuff[], contiguous samples) is mixed with a 1Khz reference to get an I/Q vector 
+for each block.  The reference phase runs continously over both blocks so that the angle between the two vectors is the 
+phase change over 13 samples.  This should be 0 degrees (1 bit) or 180 degrees (0 bit, phase reversal).
+The following is calculated using integer math:
+1. Phase error - angle away from 0 or 180 degrees for the strongest block in each bit.  Averaged per character
+2. SNR - power of 1Khz component (from I/Q) vs the rest of the energy in the block.  Summed per character
+3. IMD - PSK31 idle (continuous reversals) is 2 tones with a cosine envelope.  Ratio of average to peak envelope 
+   is 2/pi for a perfect signal. 3rd order products (IMD) flatten (or sharpen) the envelope.  For a 3rd order product e
+   relative to the tones, ratio r = (2 - 2e/3) / (pi(1+e)) so e = (2 - r.pi)/(r.pi + 2/3)
+*/
+
+// 1/4 wave repeated sine table for 1Khz reference. 127 x sin(i x 11.25 degrees)
+const signed char pskSine[PSK_SINE_TABLE_SIZE] PROGMEM = {
+  0, 25, 49, 71, 90, 106, 117, 125, 127, 125, 117, 106, 90, 71, 49, 25,
+  0, -25, -49, -71, -90, -106, -117, -125, -127, -125, -117, -106, -90, -71, -49, -25
+};
+
+unsigned int PhaseAngle (long x, long y)
+{
+// Routine to return the angle (0 to 180 degrees) of vector x,y. Sign of y ignored
+// Uses atan(z) = 45z + 15.6z(1-z) degrees for z <= 1
+
+  unsigned long ax, ay, z;
+  unsigned int angle;
+
+  ax = (x < 0) ? -x : x;
+  ay = (y < 0) ? -y : y;
+  if (!ax && !ay) return 0;
+
+  // Scale down so that z calculation fits into a long
+  while (ax > 0x7FFF || ay > 0x7FFF) {
+    ax >>= 1;
+    ay >>= 1;
+  }
+
+  // Calculate angle for first octant and then reflect
+  if (ay <= ax) {
+    z = (ay << 8) / ax;                                 // z x 256
+    angle = (45 * z + ((16 * z * (256 - z)) >> 8)) >> 8;
+  } else {
+    z = (ax << 8) / ay;
+    angle = 90 - ((45 * z + ((16 * z * (256 - z)) >> 8)) >> 8);
+  }
+
+  if (x < 0) angle = 180 - angle;                       // Second quadrant
+  return angle;
+}
+
+int PowerRatiodB (unsigned long num, unsigned long den)
+{
+// Routine to return 10log10(num/den) using integer math
+// Uses log2 with 8 bit fraction (linear between powers of 2). Each power of 2 is 3.01 dB
+
+  int lognum, logden, bits;
+
+  if (!num) return -PSK_MAX_DB;
+  if (!den) return PSK_MAX_DB;
+
+  // log2 x 256 for numerator
+  bits = 0;
+  while (num >= 512) { num >>= 1; bits++; }
+  while (num < 256) { num <<= 1; bits--; }
+  lognum = bits * 256 + (int)(num - 256);
+
+  // log2 x 256 for denominator
+  bits = 0;
+  while (den >= 512) { den >>= 1; bits++; }
+  while (den < 256) { den <<= 1; bits--; }
+  logden = bits * 256 + (int)(den - 256);
+
+  bits = (int)(((long)(lognum - logden) * 301) / 25600);       // 10log10(2) = 3.01
+  return constrain (bits, -PSK_MAX_DB, PSK_MAX_DB);
+}
+
+void PSKQualityBlock (void)
+{
+// Routine called for each block pair to measure I/Q and energy.  Results are accumulated for the current bit and character
+
+  unsigned char i, idx;
+  unsigned int phase;
+  int s, c, sn;
+  long i1, q1, i2, q2, dr, di;
+  unsigned long energy, sigpwr, mag, ai, aq;
+
+  i1 = q1 = i2 = q2 = 0;
+  energy = 0;
+  phase = 0;
+
+  // Mix first (older) block with reference
+  for (i = 0; i < CROSSCORRSZ; i++) {
+    s = corrbufflag[i] >> 2;                            // 8 bit sample so that products fit into an int
+    idx = (phase >> PSK_SINE_SHIFT) & (PSK_SINE_TABLE_SIZE - 1);
+    sn = (signed char)pgm_read_byte (&pskSine[idx]);
+    c = (signed char)pgm_read_byte (&pskSine[(idx + PSK_COSINE_OFFSET) & (PSK_SINE_TABLE_SIZE - 1)]);
+    i1 += s * c;
+    q1 -= s * sn;
+    energy += s * s;
+    phase += pskNcoInc;
+  }
+
+  // Mix second block. Reference phase continues from first block
+  for (i = 0; i < CROSSCORRSZ; i++) {
+    s = corrbuff[i] >> 2;
+    idx = (phase >> PSK_SINE_SHIFT) & (PSK_SINE_TABLE_SIZE - 1);
+    sn = (signed char)pgm_read_byte (&pskSine[idx]);
+    c = (signed char)pgm_read_byte (&pskSine[(idx + PSK_COSINE_OFFSET) & (PSK_SINE_TABLE_SIZE - 1)]);
+    i2 += s * c;
+    q2 -= s * sn;
+    energy += s * s;
+    phase += pskNcoInc;
+  }
+
+  i1 >>= PSK_IQ_SHIFT;
+  q1 >>= PSK_IQ_SHIFT;
+  i2 >>= PSK_IQ_SHIFT;
+  q2 >>= PSK_IQ_SHIFT;
+
+  // SNR - Signal is the power of the 1Khz component and noise is everthing else
+  sigpwr = (unsigned long)(i1 * i1 + q1 * q1 + i2 * i2 + q2 * q2) / PSK_SIGNAL_SCALE;
+  if (sigpwr > energy) sigpwr = energy;
+  blockSigPwr = sigpwr;                                 // Used for carrier detect
+  blockEnergy = energy;
+  pskSigPwr += sigpwr;
+  pskNoisePwr += energy - sigpwr;
+  if (pskSigPwr > 0x40000000 || pskNoisePwr > 0x40000000) {    // Long gap between characters. Keep ratio and avoid overflow
+    pskSigPwr >>= 1;
+    pskNoisePwr >>= 1;
+  }
+
+  // Envelope of newest block. Magnitude = max + min/2 (close enough, no square root)
+  ai = (i2 < 0) ? -i2 : i2;
+  aq = (q2 < 0) ? -q2 : q2;
+  mag = (ai > aq) ? ai + (aq >> 1) : aq + (ai >> 1);
+  if (mag > 0xFFFF) mag = 0xFFFF;
+  if (mag > pskEnvPeak) pskEnvPeak = mag;
+  pskEnvSum += mag;
+  pskEnvCnt++;
+
+  // Phase change between blocks. D = z2 x conjugate(z1)
+  dr = i2 * i1 + q2 * q1;
+  di = q2 * i1 - i2 * q1;
+
+  // Keep phase error for strongest block in this bit
+  if (mag >= PSK_MIN_MAGNITUDE && mag > pskBitMag) {
+    pskBitMag = mag;
+    pskBitPhaseErr = PhaseAngle (dr, di);
+    if (pskBitPhaseErr > 90) pskBitPhaseErr = 180 - pskBitPhaseErr;         // Reversal, error from 180 degrees
+  }
+}
+
+void PSKQualityBit (unsigned char bit)
+{
+// Routine called by DecodePSK() when a bit is loaded. Aggregate the measurements for the bit
+
+  unsigned long ratio;
+  long eps, num, den;
+
+  // Phase error of strongest block in the bit
+  if (pskBitMag) {
+    pskPhaseErrSum += pskBitPhaseErr;
+    pskPhaseErrCnt++;
+  }
+
+  // IMD only measured on idle (i.e. consecutive reversals, two 0 bits in a row)
+  if (!bit && !pskLastBit && pskEnvCnt) {
+    pskImdMean += pskEnvSum / pskEnvCnt;
+    pskImdPeak += pskEnvPeak;
+
+    if (++pskImdCnt >= PSK_IMD_BITS) {
+      if (pskImdPeak) {
+        ratio = (pskImdMean * 1000) / pskImdPeak;       // r x 1000
+        num = 2000 - (long)(ratio * 3142) / 1000;       // 2 - r.pi (x1000)
+        den = (long)(ratio * 3142) / 1000 + 667;        // r.pi + 2/3 (x1000)
+        eps = (num * 1000) / den;                       // e x 1000
+        if (eps < 0) eps = -eps;
+        
+        // IMD dB is 20log(e) which is 10log(e^2)
+        if (eps) pskIMD = PowerRatiodB ((unsigned long)(eps * eps), 1000000UL);
+        else pskIMD = PSK_BEST_IMD;
+        if (pskIMD < PSK_BEST_IMD) pskIMD = PSK_BEST_IMD;
+      }
+      pskImdMean = pskImdPeak = 0;
+      pskImdCnt = 0;
+    }
+  }
+  pskLastBit = bit;
+
+  // Reset for next bit
+  pskBitMag = pskBitPhaseErr = 0;
+  pskEnvPeak = pskEnvCnt = 0;
+  pskEnvSum = 0;
+}
+
+boolean PSKQualityCharacter (void)
+{
+// Routine called by DecodePSK() when a character is complete. Calculate SNR and phase error for the 
+// character and return true if good enough to be displayed (i.e. PSK locked)
+
+  pskSNR = PowerRatiodB (pskSigPwr, pskNoisePwr);
+  if (pskPhaseErrCnt) pskPhaseErr = pskPhaseErrSum / pskPhaseErrCnt;
+  else pskPhaseErr = 90;                                // No carrier found so worst phase error
+
+  pskSigPwr = pskNoisePwr = 0;
+  pskPhaseErrSum = 0;
+  pskPhaseErrCnt = 0;
+
+  return (pskSNR >= PSK_LOCK_SNR && pskPhaseErr <= PSK_LOCK_PHASE_ERROR);
+}
+
+void ResetPSKQuality (void)
+{
+// Routine to reset PSK quality measurements
+  pskSigPwr = pskNoisePwr = 0;
+  pskPhaseErrSum = 0;
+  pskPhaseErrCnt = 0;
+  pskBitMag = pskBitPhaseErr = 0;
+  pskEnvPeak = pskEnvCnt = 0;
+  pskEnvSum = 0;
+  pskImdMean = pskImdPeak = 0;
+  pskImdCnt = 0;
+  pskLastBit = 1;
+  pskSNR = -PSK_MAX_DB;
+  pskIMD = 0;
+  pskPhaseErr = 90;
+  pskQualityCtr = 0;
+}
+
+
+void SetPSKTone (int offset)
+{
+// Routine to set the PSK reference (NCO) used for carrier detect and signal quality. offset (Hz) moves the
+// reference from 1Khz when the dial is fine tuned without retuning the Si5351 (see FineTune()).
+// The phase shift detection (GetCorrPeak()) has no reference. Its delay threshold follows binMax (see DecodeLoop())
+  pskNcoInc = PSK_NCO_INCREMENT (PSK_CARRIER_FREQUENCY + offset);
+}
+
+
 void ResetPSK (void)
 {
 // Routine to reset PSK variables
@@ -407,9 +802,11 @@ void ResetPSK (void)
 
   pskPhase = 0;
 
-  pskVaricode = 0;
+  pskNode = VARICODE_ROOT;
   bitpos = 0;
 
+  ResetPSKQuality ();
+
   pskChanged = false;
   pskLocked = false;
   decodePhaseChange = false;
@@ -430,6 +827,7 @@ void ResetPSK (void)
 
   // Set default parameters
   pskbinthresh = PSK_BIN_THRESHOLD;
+  EndFineTune ();                 // Reference at 1Khz and Si5351 at the dial frequency
 
   // Keep the prior thresholds unless they are obviously incorrect, then reset to default
   if (magThresh <= 0) magThresh = PSK_CORRELATION_THRESHOLD;
@@ -442,6 +840,9 @@ void ResetPSK (void)
 
   pskSwap = 1;
 
+  // Timer 3 baud clock for bit time (31.25 baud is exactly 8000 ticks so no fraction)
+  SetBaudClock (&pskClock, PSK_BAUD_X100);
+
   frequency_clk0_tx = frequency_clk0 + TX_FREQUENCY_OFFSET;
 
   // Reset PSK flags
@@ -2,6 +2,17 @@
 #define _PSK_H_
 
 #define VARICODE_TABLE_SIZE 128           // PSK Varicode table size
+#define VARICODE_MAX_BITS 10              // Longest varicode character (excluding the "00" terminator)
+
+// Varicode decoding trie. Each received bit moves to the next node.  The nodes are numbered level by level
+// (level is the number of bits received). Level 0 is the root and level 10 is the longest character (see PSK.cpp)
+#define VARICODE_TRIE_SIZE 240            // 232 trie nodes (levels 0 to 10) + 2 overflow nodes, padded to table macro size
+#define VARICODE_TRIE_LEVELS 11           // Levels 0 to VARICODE_MAX_BITS
+#define VARICODE_ROOT 0                   // Root node. i.e. no bits received (between characters)
+#define VARICODE_SINK1 232                // More than 10 bits received and last bit was a 1. Wait for "00"
+#define VARICODE_SINK0 233                // More than 10 bits received and last bit was a 0. Next 0 ends garbage
+#define VARICODE_EMIT 0xFF                // Next node value to signal "00" received and character is complete
+#define VARICODE_INVALID 0xFF             // Bits received are not a varicode character
 
 #define CROSSCORRSZ 13                    // Number of samples to cross correlate. For 1Khz signal 13 samples cause correcation
                                           // between consecutive samples to give a large negative lag(0) value
@@ -11,13 +22,13 @@
 #define PSK_CORRELATION_THRESHOLD -600    // Biggest value for lag(0) which indicates a phase shift. Orig 600
 #define PSK_RESET_COUNT 1                 // 3 non phase samples will reset phase change detection. Orig 3
 
-#define PSK_NO_LOCK_THRESHOLD 60         // Was 121, i.e. 11 sample buffers without a phase shift means no PSK present (i.e. 11 buffers per baud cycle x 11 buffers = 121)
+// PSK_NO_LOCK_THRESHOLD (Was 121) blocks without a phase shift means no PSK present. See TimingConfig.h
 
 #define PSK_LEVEL_RESET_COUNT 90
 
-#define PSK_DECODE_START 11               // Sampling at 9615 and 13 sample correlation, at least 11 non phase shifts between a 00
-                                          // But loose one count when phase changes so counter 12 (i.e. from 0 its 11)
-#define PSK_DECODE_NOSTART 14             // A number greater than the start phase threshold
+// PSK_DECODE_START: Sampling at 9615 and 13 sample correlation, at least 11 non phase shifts between a 00
+// But loose one count when phase changes so counter 12 (i.e. from 0 its 11)
+// PSK_DECODE_NOSTART is a number greater than the start phase threshold. Both calculated in TimingConfig.h
 
 #define PSK_INIT 0xF0
 #define PSK_IDLE 0x0
@@ -30,11 +41,37 @@
 #define PSK_IDLE_COUNT 10                     // number of baud timeperiods for continious phase reversals
 #define PSK_CHAR_GAP_COUNT 3                  // number of continious phase reversals between characters
 
-unsigned int ConvertVaricode (unsigned int code);
+// PSK signal quality. Measured on the correlation buffers using a 1Khz reference (integer math)
+#define PSK_CARRIER_FREQUENCY 1000            // PSK Rx carrier is at 1000 Hz in audio passband
+#define PSK_NCO_INCREMENT(f) ((65536UL * (f)) / F_SAMPLE)   // 16 bit phase increment per sample for reference at f Hz (see SetPSKTone())
+#define PSK_SINE_TABLE_SIZE 32                // Sine table entries (i.e. 11.25 degree steps)
+#define PSK_SINE_SHIFT 11                     // Shift 16 bit phase to get table index
+#define PSK_COSINE_OFFSET 8                   // Cosine is sine + 90 degrees (i.e. 1/4 of table)
+#define PSK_IQ_SHIFT 6                        // Scale down I/Q sums so that products fit in a long
+#define PSK_SIGNAL_SCALE 26                   // I/Q power to sample energy. Power / (127^2 x CROSSCORRSZ / 2) x 2^(2 x PSK_IQ_SHIFT)
+#define PSK_MIN_MAGNITUDE 4                   // Ignore blocks with very small I/Q vector (no carrier) for phase error
+#define PSK_IMD_BITS 16                       // Number of idle bits (continuous phase reversals) used to estimate IMD
+#define PSK_MAX_DB 99                         // Limit dB values for display
+#define PSK_BEST_IMD -40                      // Smallest IMD value reported (i.e. too small to measure)
+#define PSK_LOCK_SNR -3                       // Minimum SNR (dB) for a character to be displayed
+#define PSK_LOCK_PHASE_ERROR 25               // Maximum average phase error (degrees) for a character to be displayed
+#define PSK_QUALITY_DISPLAY_COUNT 8           // Update quality on LCD every 8 characters (LCD is slow)
+
+void PSKQualityBlock (void);
+void PSKQualityBit (unsigned char bit);
+boolean PSKQualityCharacter (void);
+void ResetPSKQuality (void);
+unsigned int PhaseAngle (long x, long y);
+int PowerRatiodB (unsigned long num, unsigned long den);
+
+unsigned char VaricodeDecodeBit (unsigned char bit);
+unsigned char VaricodeNextNode (unsigned char *trieNode, unsigned char bit);
+unsigned char VaricodeFlush (void);
 unsigned int LookupVaricode (char code);
-unsigned char numbits (unsigned int in);
+unsigned char LookupVaricodeLength (char code);
 unsigned char GetPhaseShift (void); 
 char DecodePSK (unsigned char phase);
+void SetPSKTone (int offset);
 void ResetPSK (void);
 
 
@@ -152,6 +152,7 @@ void setup() {
   ResetFrequencies ();
   Reset();
   TestLEDS();
+  MeasurePinIO();
 
   // This is used for testing.  Can toggle this pins to measure timing using scope
   // Pin 2 is DDE4, DDE5 is pin 3 and DDG5 is pin 4
@@ -167,6 +168,8 @@ void setup() {
 void loop()
 {
 
+  RunDeferredWork ();             // Tx keying queued by timer interupts. Do this first
+
   StatusLED();
 
   ProcessSerialTerminal ();
@@ -177,31 +180,27 @@ void StatusLED (void)
 {
   if (statusLEDctr++ > BLINKCOUNT) {
     statusLEDctr = 0;
-    if (digitalRead(OKLED)) {
-      digitalWrite(OKLED, LOW);         // LED Off
-    } else {
-      digitalWrite(OKLED, HIGH);        // LED On
-    }
+    PinToggle(OKLED);                   // LED On/Off
   }
 
 //  if ( !(TermFlags & DISP_WATERFALL) &&  !(TermFlags & DISP_NARROW_WATERFALL) ) {
     if (pskLocked || rttyLocked) {
-      digitalWrite (LOCKLED, HIGH);
+      PinHigh(LOCKLED);
     } else {
-      digitalWrite (LOCKLED, LOW);
+      PinLow(LOCKLED);
     }
 //  }
 
   if ( (flags & TRANSMITRTTY) || (flags & TRANSMITPSK) ) {
-    digitalWrite (TXLED, HIGH);
+    PinHigh(TXLED);
   } else {
-    digitalWrite (TXLED, LOW);
+    PinLow(TXLED);
   }
 
   if (flags & CLIPPING) {
-    digitalWrite(OKLED, HIGH);          // LED On continiousl to indicate clipping
-    digitalWrite (LOCKLED, HIGH);       // LED Onm continiously to indicate clipping
-    digitalWrite (TXLED, HIGH);
+    PinHigh(OKLED);                     // LED On continiousl to indicate clipping
+    PinHigh(LOCKLED);                   // LED Onm continiously to indicate clipping
+    PinHigh(TXLED);
   }
 
 }
@@ -231,7 +230,7 @@ void Reset (void)
   TCCR0B = 0;
   TIMSK0 = 0;
 
-  digitalWrite(TxEnable, LOW);          // Disable transmit
+  PinLow(TxEnable);                     // Disable transmit
   digitalWrite(RxMute, HIGH);           // Unmute receiver
   noTone(SideTone);                     // turn off SideTone
 
@@ -242,18 +241,17 @@ void Reset (void)
   errorCode = 0;
   encoderVal = 0xFF;
   encoderState = 0;
-  pbstate = 0;
-  pbreset = 0;
 
-  pb1ctr = pb2ctr = pb3ctr = pbenable = 0;
-  pbreusectr = 0;
+  ResetButtons ();
 
   ResetSi5351 (SI_CRY_LOAD_8PF);
   EEPROMReadCorrection();
+  EEPROMReadRTTYConfig();
 
   RestoreTimerRegisters();
 
   LCDDisplaySetup();
+  LCDMeasureWaterfall();
   ResetPButtonMenu ();
 
   Serial1.println (HEADER_MESSAGE);   // Banner defined in main.h
@@ -286,6 +284,28 @@ void TestLEDS (void)
 
 }
 
+void MeasurePinIO (void)
+{
+// Routine to measure the CPU cycles of a digitalWrite() compared to PinLow()/PinHigh() (CBI/SBI) using the OK LED.
+// Includes loop overhead. Displayed with ^Q.  LED is left on as TestLEDS() does
+  unsigned int i;
+  unsigned long start;
+
+  start = micros();
+  for (i = 0; i < PIN_IO_CALLS; i++) {
+    digitalWrite(OKLED, LOW);
+    digitalWrite(OKLED, HIGH);
+  }
+  pinSlowCycles = ((micros() - start) * (F_CPU / 1000000UL)) / (2 * PIN_IO_CALLS);
+
+  start = micros();
+  for (i = 0; i < PIN_IO_CALLS; i++) {
+    PinLow(OKLED);
+    PinHigh(OKLED);
+  }
+  pinFastCycles = ((micros() - start) * (F_CPU / 1000000UL)) / (2 * PIN_IO_CALLS);
+}
+
 //////////////////////////////////
 //
 //////////////////////////////////
@@ -318,6 +338,18 @@ void EEPROMReadCorrection(void)
   multisynth.correction = eeprom_read_dword((const uint32_t*)0);
 }
 
+void EEPROMWriteRTTYConfig(void)
+// write the RTTY baud rate and shift selection to Arduino eeprom
+{
+  eeprom_update_byte((uint8_t*)EEPROM_RTTY_CONFIG, rttyConfig);
+}
+
+void EEPROMReadRTTYConfig(void)
+// read the RTTY baud rate and shift selection from Arduino eeprom. Invalid values select the default
+{
+  SetRTTYConfig (eeprom_read_byte((const uint8_t*)EEPROM_RTTY_CONFIG));
+}
+
 
 
 
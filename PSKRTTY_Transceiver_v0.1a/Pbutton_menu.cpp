@@ -123,6 +123,7 @@ void LCDDisplayMenuLevel ( char menutxt[][MAXMENU_LEN] )
 // The menu is displayed in the waterfall window
 
   // Clear the waterfall window and define colour and size for text
+  LCDStopWaterfallScroll ();
   tft.fillRect(MIN_X, WF_START_Y, MAX_X, WF_WIN_SIZE, ILI9340_RED);
   tft.setTextColor(ILI9340_BLACK); 
   tft.setTextSize(2);
@@ -391,15 +392,15 @@ unsigned char IsPushed (unsigned char button)
 {
 // Routine to check if a button has been pressed.  If the button is disabled ignore. 
 // Buttom must be enabled in order for it to be returned
-// pbenable is set by CheckPushButtons ()
+// pbenable is set by ProcessButtonEvents () for a debounced press (see DebounceButtons())
   
-  if (button == PBUTTON1 && pbenable & PB1ENABLED && flags & PBUTTON1_PUSHED) {
+  if (button == PBUTTON1 && pbenable & PB1ENABLED) {
     return PB1ENABLED;
     
-  } else if (button == PBUTTON2 && pbenable & PB2ENABLED && flags & PBUTTON2_PUSHED) {
+  } else if (button == PBUTTON2 && pbenable & PB2ENABLED) {
     return PB2ENABLED;
     
-  } else if (button == PBUTTON3 && pbenable & PB3ENABLED && flags & PBUTTON3_PUSHED) {
+  } else if (button == PBUTTON3 && pbenable & PB3ENABLED) {
     return PB3ENABLED;
     
   } else {
@@ -426,77 +427,4 @@ void DiableButton (unsigned char button)
   }
 }
 
-void CheckPushButtons (void)
-{
-// This routine is called by Timer 1 (3 ms duty cycle) to detect pushbutton activity and debounce
-// Pushbutton pins have weakpullup so default state is high (i.e. 1) and when pushed its grounded and state is 0 (Low)
-
-  // This is used if a button can be push 2 times in a row
-  // Not currently used.
-  if (flags & PBUTTON_REUSED) {
-    if (pbreusectr++ > BUTTON_REUSE) {
-      pbreusectr = 0;
-      flags &= ~PBUTTON_REUSED;
-    }
-  }
-
-  // If pushbutton is disabled, then ignore detection and debounce
-  if (! (pbenable & PB1ENABLED)) {
-
-    // Check button state
-    if (digitalRead(PBUTTON1)) {
-
-      // Debounce button (if pushed) only if button was not previously pushed
-      if ( !(flags & PBUTTON1_PUSHED) ) {
-        if (pb1ctr >= PBDEBOUNCE) {           // Check if debounce counter exceed debounce threshold
-          flags |= PBUTTON1_PUSHED;           // Set push flag
-          pbenable |= PB1ENABLED;             // Disable push button. This is reset after button has been processed
-        } else {
-          pb1ctr++;
-        } 
-      }   
-      
-    // Button already pushed so allow a relaxation period (i.e. idle period where button ignored)
-    // After relaxation period enable button (i.e. clear pushed flag)
-    } else {
-      if (pb1ctr) pb1ctr--;               // Decrement relaxation coutter
-      else flags &= ~PBUTTON1_PUSHED;     // if counter is zero, then reset push flag
-    }
-  }
-
-  // Repeate the above for button 2
-  if (! (pbenable & PB2ENABLED)) {
-    if (digitalRead(PBUTTON2)) {
-      if ( !(flags & PBUTTON2_PUSHED) ) {
-        if (pb2ctr >= PBDEBOUNCE) {
-          flags |= PBUTTON2_PUSHED;
-          pbenable |= PB2ENABLED;
-        } else {
-          pb2ctr++;
-        }    
-      }   
-    } else {
-      if (pb2ctr) pb2ctr--;
-      else flags &= ~PBUTTON2_PUSHED;
-    }
-  }
-
-  // Repeate the above for button 3
-  if (! (pbenable & PB3ENABLED)) {
-    if (digitalRead(PBUTTON3)) {
-      if ( !(flags & PBUTTON3_PUSHED) ) {
-        if (pb3ctr >= PBDEBOUNCE) {
-          flags |= PBUTTON3_PUSHED;
-          pbenable |= PB3ENABLED;
-        } else {
-          pb3ctr++;
-        }    
-      }   
-    } else {
-      if (pb3ctr) pb3ctr--;
-      else flags &= ~PBUTTON3_PUSHED;
-    }
-  }
-}
-
 
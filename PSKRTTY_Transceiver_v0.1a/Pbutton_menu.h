@@ -11,13 +11,10 @@
 #define MENU_ROW2_Y 60
 #define MENU_ROW3_Y 80
 
-#define PBDEBOUNCE 30
 #define PB1ENABLED 0x1
 #define PB2ENABLED 0x2
 #define PB3ENABLED 0x4
 
-#define BUTTON_REUSE 500
-
 #define MAXMENU_ITEMS 8
 #define MAXMENU_LEN 11
 
@@ -32,7 +29,6 @@
 #define TXMENU 2
 
 // Push Button Routines
-void CheckPushButtons (void);
 unsigned char IsPushed (unsigned char button); 
 void DiableButton (unsigned char button);
 char PButtonMenu (void);
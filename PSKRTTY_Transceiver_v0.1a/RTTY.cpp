@@ -14,16 +14,128 @@ Program Written by Dave Rajnauth, VE3OOI to perform various RTTY Rx and Tx proce
 // Baudot lookup tables. Offset is the baudot code and the contents is the ascii character
 // Baudot is 5 bits and uses 2 tables with 32 entries (i.e. 2^5). One table for letters (i.e. alphabetic characters))
 // and another table for figures (i.e. numbers and special characters)  
-const char figures[BAUDOT_TABLE_SIZE] = {0x0,'3',0xA,'-',' ',0x7,'8','7',0xD,'$','4',0x27,',','!',':','(','5',
+// The tables are in flash (PROGMEM) and are also used by the compiler to generate the ascii to baudot table below
+constexpr char figures[BAUDOT_TABLE_SIZE] PROGMEM = {0x0,'3',0xA,'-',' ',0x7,'8','7',0xD,'$','4',0x27,',','!',':','(','5',
                   '\"',')','2','#','6','0','1','9','?','&',0x0,'.','/',';',0x0,0x0};
                       
-const char letters[BAUDOT_TABLE_SIZE] = {0x0,'E',0xA,'A',' ','S','I','U',0xD,'D','R','J','N','F','C','K','T','Z','L',
+constexpr char letters[BAUDOT_TABLE_SIZE] PROGMEM = {0x0,'E',0xA,'A',' ','S','I','U',0xD,'D','R','J','N','F','C','K','T','Z','L',
                   'W','H','Y','P','Q','O','B','G',0x0,'M','X','V',0x0,0x0};
 
 // Baudot using the LTRS and FIGRS code to switch between tables 
 // #define RTTY_FIGURES 27       //11011 bin
 // #define RTTY_LETTERS 31       //11111 bin
 
+// ASCII to baudot table.  Offset is the ascii code and the contents is the baudot code (bits 0-4) plus flags
+// to say if the code is in the letters table (BAUDOT_IN_LETTERS), figures table (BAUDOT_IN_FIGURES) or both (e.g. space, CR, LF)
+// The compiler searches the letters and figures tables once for each ascii character.
+constexpr unsigned char BaudotSearch (const char *table, char c, unsigned char i = 0)
+{
+  return i >= BAUDOT_TABLE_SIZE - 1 ? BAUDOT_NOT_FOUND : table[i] == c ? i : BaudotSearch (table, c, i + 1);
+}
+
+constexpr unsigned char BaudotEntry (unsigned char c)
+{
+  return (BaudotSearch (letters, c) != BAUDOT_NOT_FOUND ? (BaudotSearch (letters, c) | BAUDOT_IN_LETTERS) : 0) |
+         (BaudotSearch (figures, c) != BAUDOT_NOT_FOUND ? (BaudotSearch (figures, c) | BAUDOT_IN_FIGURES) : 0);
+}
+
+#define BAUDOT_ENTRY(n)   BaudotEntry (n)
+
+constexpr unsigned char asciiBaudot[ASCII_BAUDOT_TABLE_SIZE] PROGMEM = {
+  CODEC_ROW128 (BAUDOT_ENTRY, 0)
+};
+
+// Check that characters in both tables (space, CR, LF) have the same baudot code in both tables
+constexpr bool BaudotTableCheck (unsigned char c = 0)
+{
+  return c >= ASCII_BAUDOT_TABLE_SIZE ? true :
+         ( BaudotSearch (letters, c) == BAUDOT_NOT_FOUND || BaudotSearch (figures, c) == BAUDOT_NOT_FOUND ||
+           BaudotSearch (letters, c) == BaudotSearch (figures, c) ) && BaudotTableCheck (c + 1);
+}
+
+static_assert (BaudotTableCheck (), "Baudot letters and figures tables have different codes for the same character");
+
+// Supported baud rates (x100) and shifts (Hz). Selected with ^A or RTTY Cfg menu and saved in EEPROM
+// Timing (timer counts, blocks per bit) is checked at compile time for the slowest/fastest baud rate (see TimingConfig.h)
+constexpr unsigned int rttyBaudRates[RTTY_BAUD_RATES] PROGMEM = {4545, 5000, 7500};
+constexpr unsigned int rttyShifts[RTTY_SHIFTS] PROGMEM = {170, 425, 850};
+
+static_assert (rttyBaudRates[0] == RTTY_SLOWEST_BAUD_X100 && rttyBaudRates[RTTY_BAUD_RATES - 1] == RTTY_FASTEST_BAUD_X100, 
+               "RTTY baud rates do not match TimingConfig.h");
+static_assert (rttyShifts[RTTY_SHIFTS - 1] == RTTY_WIDEST_SHIFT, "RTTY shifts do not match TimingConfig.h");
+
+
+void SetRTTYConfig (unsigned char config)
+{
+// Routine to select the RTTY baud rate and shift. Low nibble of config is the baud rate index and high nibble is the shift index
+// Unknown values (e.g. EEPROM never written) select 45.45 baud and 170 Hz shift 
+// Values derived from baud rate and shift (frequencies, bins, timer count) are calculated in ResetRTTY()
+
+  if ((config & RTTY_CONFIG_BAUD_MASK) >= RTTY_BAUD_RATES || (config >> RTTY_CONFIG_SHIFT_POS) >= RTTY_SHIFTS) {
+    config = RTTY_DEFAULT_CONFIG;
+  }
+  rttyConfig = config;
+  rttyBaud = pgm_read_word (&rttyBaudRates[config & RTTY_CONFIG_BAUD_MASK]);
+  rttyShift = pgm_read_word (&rttyShifts[config >> RTTY_CONFIG_SHIFT_POS]);
+}
+
+void NextRTTYConfig (void)
+{
+// Routine to step to the next baud rate. After the last baud rate, step to next shift. 
+// i.e. 45.45/170, 50/170, 75/170, 45.45/425, ....
+
+  unsigned char baud, shift;
+
+  baud = (rttyConfig & RTTY_CONFIG_BAUD_MASK) + 1;
+  shift = rttyConfig >> RTTY_CONFIG_SHIFT_POS;
+  if (baud >= RTTY_BAUD_RATES) {
+    baud = 0;
+    if (++shift >= RTTY_SHIFTS) shift = 0;
+  }
+  SetRTTYConfig ((shift << RTTY_CONFIG_SHIFT_POS) | baud);
+}
+
+void UpdateRTTYTxFrequencies (void)
+{
+// Routine to define the Tx frequencies. Space is fixed and Mark is Space + shift
+// There is a small shift to make the frequency appear as the Space/Mark frequency on receiver's waterfall
+// The Si5351 multisynth registers for Mark and Space are calculated here (when RTTY Tx starts or a memory is stored)
+// so that keying in TxRTTYbit() only needs to write the registers. Registers are calculated into a temporary buffer and 
+// copied with interrupts disabled because Timer 4 may be keying.
+// Nothing is calculated if the registers are already for these frequencies (e.g. loaded from a memory channel)
+
+  unsigned char mark[SI_MSREGS], space[SI_MSREGS];
+  unsigned long freq;
+
+  rttyTransmitSpaceFreq = frequency_clk0 - RTTY_SHIFT_FREQUENCY + TX_FREQUENCY_OFFSET;
+  rttyTransmitMarkFreq = rttyTransmitSpaceFreq + rttyShift;
+  if (rttyTransmitSpaceFreq == rttyRegsSpaceFreq && rttyTransmitMarkFreq == rttyRegsMarkFreq) return;
+
+  freq = multisynth.MS_Fout;                // CalculateDividers() changes multisynth so restore after
+  CalculateMSRegisters (rttyTransmitSpaceFreq, space);
+  CalculateMSRegisters (rttyTransmitMarkFreq, mark);
+  if (freq) CalculateDividers (freq);
+
+  LoadRTTYTxRegisters (mark, space);
+}
+
+void LoadRTTYTxRegisters (unsigned char *mark, unsigned char *space)
+{
+// Routine to load Mark and Space registers calculated for the current frequency and shift (see UpdateRTTYTxFrequencies())
+// Copied with interrupts disabled because Timer 4 may be keying.
+
+  rttyTransmitSpaceFreq = frequency_clk0 - RTTY_SHIFT_FREQUENCY + TX_FREQUENCY_OFFSET;
+  rttyTransmitMarkFreq = rttyTransmitSpaceFreq + rttyShift;
+
+  cli();
+  memcpy (rttyMarkRegs, mark, SI_MSREGS);
+  memcpy (rttySpaceRegs, space, SI_MSREGS);
+  sei();
+
+  rttyRegsSpaceFreq = rttyTransmitSpaceFreq;
+  rttyRegsMarkFreq = rttyTransmitMarkFreq;
+}
+
 
 char Baudot( char c, unsigned char alpha)
 {
@@ -31,19 +143,16 @@ char Baudot( char c, unsigned char alpha)
 // Used to translate ASCII to Baudot.  The "alpha" variable
 // is used to identify the table to be use (i.e. 0 use figures, 1 use letters)
  
-  unsigned char i;
+  unsigned char entry;
 
-  // Search baudot table
-  for (i=0; i<BAUDOT_TABLE_SIZE; i++) {
-    if (alpha) {                        // Search letters table
-      if (letters[i] == c) {            // ASCII code found
-        return i;                       // Return offset which is baudot code
-      }
-    } else {                            // Search letters table
-      if (figures[i] == c) {            // Same as above
-        return i;
-      }
-    }
+  if ((unsigned char)c >= ASCII_BAUDOT_TABLE_SIZE) return 0;      // Not ascii so nothing found
+
+  // Direct lookup. The flags identify which table has the character
+  entry = pgm_read_byte (&asciiBaudot[(unsigned char)c]);
+  if (alpha) {
+    if (entry & BAUDOT_IN_LETTERS) return (entry & BAUDOT_CODE_MASK);       // Found in letters table
+  } else {
+    if (entry & BAUDOT_IN_FIGURES) return (entry & BAUDOT_CODE_MASK);       // Found in figures table
   }
   
   return 0;                             // nothing found so return 0 (error)
@@ -52,21 +161,28 @@ char Baudot( char c, unsigned char alpha)
 
 void TxRTTYbit (unsigned char b) 
 {
-// Routine used by timer 4 to transmit a single RTTY bit.
+// Routine used to transmit a single RTTY bit. Queued by timer 4 and called from the main loop (see WorkQueue.cpp)
 // If bit is 1 turn of MARK frequency, if bit is 0 turn on SPACE frequency
 // Timer 4 is executes ever 22 ms (duty cycle for RTTY 45) and carrier will be adjusted
 // for next bit or if stop bits needed
 
+  unsigned long start;
+
   // Don't bother changing frequency if bit state has not changed
   // if if last bit was 0 and this bit is 0, no need to turn on SPACE frequency again.  Unecessary processing...the arduino is stretched as it is.
+  // Mark/Space multisynth registers are precalculated (see UpdateRTTYTxFrequencies()) so only the registers that differ are written
+  // No divider calculation and no PLL reset so this takes well under 1 ms
   if (b != rttyPriorState) {
-    digitalWrite(TxEnable, LOW);                // Diable Tranmitter to allow carrier to drop. This is a primitive form of key click filtering. ie envelope is a raised cosine
+    start = micros();
+    PinLow(TxEnable);                           // Diable Tranmitter to allow carrier to drop. This is a primitive form of key click filtering. ie envelope is a raised cosine
     if (b) {                                    // Enable MARK/SPACE frequency based on bit value
-      SetFrequency (rttyTransmitMarkFreq);
+      WriteMSRegisters (rttyMarkRegs);
     } else {
-      SetFrequency (rttyTransmitSpaceFreq);
+      WriteMSRegisters (rttySpaceRegs);
     }
-    digitalWrite(TxEnable, HIGH);               // Turn on tranmitter.
+    i2cFlush();                                 // Registers must be written before carrier is turned on
+    PinHigh(TxEnable);                          // Turn on tranmitter.
+    rttyKeyTime = micros() - start;             // Time to change frequency (displayed with ^Q)
   }
 
   rttyPriorState = b;                           // Save current bit state for next iteration
@@ -157,121 +273,201 @@ Where 11 are the stop bits, 0 is the start bit and xxxxx are the actual baudot d
 
 
 
+char RTTYBitSync (long markpwr, long spacepwr, unsigned int elapsed)
+{
+// Routine to recover RTTY bits from continuous sampling using a digital PLL (DPLL) bit synchronizer.
+// Called for every block with the Mark and Space power and the number of samples since the last block.
+// The DPLL phase (16 bits) wraps once per bit. Mark minus Space power is summed (integrated) over each bit
+// and the bit is decided when the phase wraps (dump).  
+// Bit edges (Mark/Space changes) are used to correct the phase:
+//   - Waiting for a start bit: Mark to Space edge resets the phase (i.e. start of start bit)
+//   - Within a character: phase is nudged towards the edge (proportional correction)
+// An edge is a sign change between clear Mark or Space blocks. The block that straddles the edge is a mix of
+// Mark and Space (not clear) so one unclear block is allowed between them and its mix locates the edge
+// Returns the ascii character from DecodeRTTY() once the stop bit is received, otherwise 0
+
+  long d, lastd, mag, a, b;
+  unsigned long step, newphase;
+  unsigned int since, frac;
+  uint16_t edgephase;                     // 16 bits so that the phase wraps once per bit
+  int16_t err;
+  char decoded;
+  unsigned char bitvalue;
+  boolean clear;
+
+  decoded = 0;
+  d = markpwr - spacepwr;                 // Positive for Mark, negative for Space
+  mag = markpwr + spacepwr;
+  clear = labs(d) * RTTY_EDGE_RATIO > mag;          // Clear Mark or Space (i.e. not noise or a block with an edge)
+  lastd = rttyLastD;                                // Last clear block
+
+  // Samples lost (e.g. LCD update or overrun) so bit timing lost. Wait for next start bit
+  if (elapsed > RTTY_MAX_BLOCK_GAP) {
+    rttyBitSum = 0;
+    rttyBitMag = 0;
+    rttyLocked = false;
+    rttyState = RTTY_IDLE;
+    return 0;
+  }
+
+  // Phase increment is fractional (RTTY_PHASE_FRAC_BITS). Carry the fraction so the average bit rate is exact
+  step = (unsigned long)elapsed * rttyPhaseInc + rttyPhaseFrac;
+  rttyPhaseFrac = step & RTTY_PHASE_FRAC_MASK;
+  step >>= RTTY_PHASE_FRAC_BITS;
+  newphase = rttyDpllPhase + step;
+
+  // Check for bit edge. Both blocks must be a clear Mark or Space (i.e. not noise)
+  if (clear && ((d > 0 && lastd < 0) || (d < 0 && lastd > 0))) {
+
+    // Edge in the unclear block between. Part of that block after the edge (x256) is (1 - x)/2 where x is its
+    // Mark-Space difference over its power in the direction of the last clear block (+1 all before, -1 all after)
+    // Scale values down so that x256 does not overflow
+    if (rttyEdgeSamples) {
+      a = rttyEdgeMag - (lastd > 0 ? rttyEdgeD : -rttyEdgeD);     // (1 - x) x power
+      b = 2 * rttyEdgeMag;
+      while (b > 0x7FFFFFL) {
+        a >>= 1;
+        b >>= 1;
+      }
+      frac = b ? (unsigned int)(a * 256 / b) : 128;           // No power (gate closed) so assume the middle
+      since = (elapsed >> 1) + (((unsigned long)frac * rttyEdgeSamples) >> 8);   // Samples since the edge
+
+    // Edge between last block and this block (x256). Linear interpolation of zero crossing 
+    } else {
+      a = labs(lastd);
+      b = labs(d);
+      while (a + b > 0x7FFFFFL) {
+        a >>= 1;
+        b >>= 1;
+      }
+      frac = (unsigned int)(a * 256 / (a + b));
+      since = ((unsigned long)(256 - frac) * elapsed) >> 8;          // Samples since the edge
+    }
+    edgephase = (uint16_t)newphase - (uint16_t)((since * rttyPhaseInc) >> RTTY_PHASE_FRAC_BITS);     // DPLL phase at the edge. Should be 0 (bit boundary)
+
+    // Mark to Space edge when waiting for start bit. Start bit starts at edge
+    if (d < 0 && rttyState == RTTY_IDLE) {
+      newphase = ((unsigned long)since * rttyPhaseInc) >> RTTY_PHASE_FRAC_BITS;
+      rttyBitSum = 0;
+      rttyBitMag = 0;
+      rttyState = RTTY_START;
+
+    // Within a character, correct phase towards the edge
+    } else if (rttyState != RTTY_IDLE) {
+      err = (int16_t)edgephase;                     // Phase error is signed (i.e. early or late)
+      newphase -= err >> RTTY_DPLL_SHIFT;
+      rttyDpllErr = err;
+    }
+  }
+
+  // Keep last clear block. Only one unclear block (the edge) allowed between clear blocks
+  if (clear) {
+    rttyLastD = d;
+    rttyEdgeSamples = 0;
+  } else if (!rttyEdgeSamples) {
+    rttyEdgeD = d;
+    rttyEdgeMag = mag;
+    rttyEdgeSamples = elapsed;
+  } else {
+    rttyLastD = 0;
+  }
+
+  // Bit boundary crossed in this block. Block is in neither bit. With selective fading the tone of one bit can be
+  // much stronger than the other so part of a block could outweigh the whole of the weaker bit
+  if (newphase >= RTTY_PHASE_BIT && newphase < 2 * RTTY_PHASE_BIT) {
+
+    // Bit decision. If the Mark/Space difference is small then its unknown (i.e. not RTTY)
+    if (labs(rttyBitSum) * RTTY_DECISION_RATIO < rttyBitMag || !rttyBitMag) bitvalue = RTTY_UNKNOWN;
+    else if (rttyBitSum > 0) bitvalue = 1;
+    else bitvalue = 0;
+    decoded = DecodeRTTY (bitvalue);
+    rttyBits++;
+
+    rttyBitSum = 0;
+    rttyBitMag = 0;
+    newphase -= RTTY_PHASE_BIT;
+
+  // Phase moved backwards over the bit boundary (phase correction). Bit already decided so start of bit
+  } else if (newphase >= 2 * RTTY_PHASE_BIT) {
+    newphase = 0;
+    rttyBitSum += d;
+    rttyBitMag += mag;
+    
+  } else {
+    rttyBitSum += d;
+    rttyBitMag += mag;
+  }
+
+  rttyDpllPhase = (unsigned int)newphase;
+  return decoded;
+}
+
+
 char DecodeRTTY (unsigned char bitvalue)
 {
-// Routine to load and frame RTTY character
+// Routine to frame RTTY character from the bits recovered by RTTYBitSync() (one call per bit)
 // Process is 
-//    IDLE  =>  START =>  DATA  =>  STOP    =>  GOTO START
-//    >7xM      1S        5 bits    1.5-2M  
-// Manually search for 7 iterations with Mark frequency if so, then in idle state.
-// If in idle state and a start bit received, then start Timer 4 (22 ms duty cycle) to check for bits
-// receive 5 bits and then search for 2 stop bits.  If 2 stop bits then start searching for start bit again  (rinse and repeat)
-// The bitvalue variable is 0 for space frequency (i.e. space bit), 1 for mark frequency (i.e. mark bit) or 0xFF for unknown 
+//    IDLE  =>  START =>  DATA  =>  STOP    =>  GOTO IDLE
+//    Mark      1S        5 bits    1.5-2M  
+// In idle state, RTTYBitSync() is waiting for a Mark to Space edge (i.e. start of start bit) and moves to start state
+// Start bit must be a space, then 5 data bits are loaded and the stop bit must be a mark.  
+// The bitvalue variable is 0 for space frequency (i.e. space bit), 1 for mark frequency (i.e. mark bit) or RTTY_UNKNOWN 
 
   // Process RTTY state
   switch (rttyState) {
 
-    // Init state is first time running, idle is already running
-    // Init state could also be after an error
-    // Search for 5 mark bit. i.e. Mark frequency is turned on for letters threshold
-    // Note in idle state LTRS code is sent
+    // Idle. Mark bits or waiting for start bit. 
     case RTTY_IDLE:
     case RTTY_INIT:
-      // Check if mark frequency is present for threshold
-      if (bitvalue == 1 && rttyMark++ >= RTTY_LTRS_THRESHOLD) {       // LTRS code found so in idle state so move to next state (Start state)
-        // Reset all RTTY variable used to bit detection and character framing
-        rttyMark = 0;                   // Mark frequency detected counter..uses for LTRS and Stop bit detection                             
-        rttySpace = 0;                  // Space frequency detected counter
-        bitpos = 0;                     // bit location that is loaded in rttyChar variable
-        rttyChar = 0;                   // Variable that holds the received rtty bits
-        rttyLocked = false;             // Lock flag is disabled. Enabled when start, data and stop bits received
-        rttyIdle = 0;                   // Idle counter. Used to detect idle condition regardless of state.  Allows state to be reset back to idle
-        nortty = 0;                     // Counter to detect if no mark or space frequency detected. Allows state to be reset back to init
-        rttyFigures = 1;                // Assume FIGRS received. Will be set to 0 if LTRS code received. This variable is use to identify which rtty table to use
-        rttyState = RTTY_START;         // Move to Start state
-      } 
+      rttyState = RTTY_IDLE;
       break;
 
-    // Start State. Search for start bit
+    // Start State. Bit must be a Space otherwise edge was a glitch
     case RTTY_START:
-      // Check if mark frequency is present for start bit threshold
-      if (!bitvalue && rttySpace++ >= RTTY_START_THRESHOLD) {         // Space bit found so move to data state i.e. enable timer and load bits
-        DisableTimers (4);              // Reset RTTY timer   
-
-        // So...a start bit received and 22 ms later the first data bit will be encoutered  
-        // To improve chances of detecting Mark/Spec bit reset ADC and timer.  i.e. 22 ms from this point should be well within bit duty cycle and less likly 
-        // to have detection fall outside of the bit duty cycle 
-        // Sampling is turned on by timer 3 (22ms after this point).  In data state after bit is loaded timer 3 is enabled and sampling again started 22 ms later.  
-        // Once ADC has loaded a sample, a signal is sent to processed the buffer and this routine is called to load the bit            
-        StopSampling();       
-        aCtr = 0;                       // Reset ADC to mark this boundary
-        flags &= ~ADCDONE;
-        flags &= ~REALTIME;
-        EnableTimers (4, TIMER22MS);
-
-        // Reset RTTY framing and character loading variables
-        rttyMark = 0;
-        rttySpace = 0;
-        nortty = 0;
+      if (!bitvalue) {
         bitpos = 0;
         rttyChar = 0;
         rttyState = RTTY_DATA;          // Change to data state. i.e. load 5 rtty data bite
+      } else {
+        rttyState = RTTY_IDLE;
       }
-
       break;
 
     // In data state so receive 5 data bits
     // Rtty character could be LTRS or FIGRS code or a real rtty character
     case RTTY_DATA:
-    
-      // Makesure bit is 0 or 1
-      if (bitvalue != RTTY_UNKNOWN) {
-        if (bitvalue) rttyChar |= (1<<bitpos);      // load "1" bit, don't need to load a "0" bit since rttyChar was initialized to be zero prior to processing
-        bitpos++;
-
-        // Received all 5 bits so start realtime stamping to look for STOP bits.
-        // Start realtime sampling ASAP to detect number of bits.
-        if (bitpos >= BAUDOT_BITS) {
-          // Disable timer to start ADC and switch to realtime samping 
-          DisableTimers (4);
-          flags |= REALTIME;
-          StartSampling ();
-          rttyMark = 0;                             // Reset variable to detect stop bit
-          rttySpace = 0;
-          nortty = 0;
-          bitpos = 0;
-          rttyState = RTTY_STOP;                    // Switch to Stop state
-        }
-      } 
+      if (bitvalue == 1) rttyChar |= (1<<bitpos);   // load "1" bit, don't need to load a "0" bit since rttyChar was initialized to be zero prior to processing
+      bitpos++;
+      if (bitpos >= BAUDOT_BITS) {
+        bitpos = 0;
+        rttyState = RTTY_STOP;                      // Switch to Stop state
+      }
       break;
 
-    // Stop state. Search for stop bits
+    // Stop state. Bit must be a Mark
     case RTTY_STOP:
-      // Check if mark frequency is present for stop bits (i.e. 2 bits) threshold
-      if (bitvalue == 1 && rttyMark++ >= RTTY_STOP_THRESHOLD) {
-        
-        // Reset all RTTY variables used for start bit detection 
-        rttyMark = 0;
-        nortty = 0;
-        rttySpace = 0;
-        bitpos = 0;
-        rttyState = RTTY_START;       // Return to start state
-        rttyLocked = true;            // RTTY is being decoded so set lock flag
-
-        // Process RTTY code received
-        // Switch between characters and numbers (figures)
-        if (rttyChar == RTTY_FIGURES) {
-          rttyFigures = 1;
-        } else if (rttyChar == RTTY_LETTERS) {
-          rttyFigures = 0; 
-
-        // Not LTRS or FIGRS code so check if value within table and do a lookup
-        } else if (rttyChar < BAUDOT_TABLE_SIZE) {
-          if (rttyFigures) rttyChar = figures[rttyChar];    // Note Baudot code is offset in table. So ASCII character is the value at the offset (i.e. array index)
-          else rttyChar = letters[rttyChar];
-          return rttyChar;                                  // Return ascii character
-        } else rttyLocked = false;   
-      } 
+      rttyState = RTTY_IDLE;          // Wait for next start bit
+      
+      if (bitvalue != 1) {            // Framing error
+        rttyFrameErrors++;
+        rttyLocked = false;
+        break;
+      }
+      rttyLocked = true;              // RTTY is being decoded so set lock flag
+
+      // Process RTTY code received
+      // Switch between characters and numbers (figures)
+      if (rttyChar == RTTY_FIGURES) {
+        rttyFigures = 1;
+      } else if (rttyChar == RTTY_LETTERS) {
+        rttyFigures = 0; 
+
+      // Not LTRS or FIGRS code so check if value within table and do a lookup
+      } else if (rttyChar < BAUDOT_TABLE_SIZE) {
+        if (rttyFigures) rttyChar = pgm_read_byte (&figures[rttyChar]);    // Note Baudot code is offset in table. So ASCII character is the value at the offset (i.e. array index)
+        else rttyChar = pgm_read_byte (&letters[rttyChar]);
+        return rttyChar;                                  // Return ascii character
+      } else rttyLocked = false;   
       break;
       
     default:
@@ -279,27 +475,15 @@ char DecodeRTTY (unsigned char bitvalue)
 
   }
 
-  // These checks are used to reset the state at any point in time. i.e. check for persistence of an incorrect state
-  
-  // If a string of not Mark or not Space, then reset back to initial state
-  if (bitvalue == RTTY_UNKNOWN && nortty++ >= RTTY_NULL_THRESHOLD) {
-    rttyLocked = false;
-    rttyFigures = 1;
-    rttyIdle = 0;
-    nortty = 0;
-    rttyState = RTTY_INIT;
-
-  // Check for a string of mark bits that indicated an idle condition 
-  } else if (bitvalue == 1 && rttyIdle++ >= RTTY_LTRS_THRESHOLD) {
-    rttyIdle = 0;
-    rttyLocked = false;
-    nortty = 0;
-    rttyFigures = 1;
-    rttyState = RTTY_START;
-
-  // If at least one space bit received reset idle detection. i.e. RTTY may be present  
-  } else if (bitvalue == 0) {
-    rttyIdle = 0;
+  // If a string of not Mark or not Space bits, then no RTTY 
+  if (bitvalue == RTTY_UNKNOWN) {
+    if (nortty++ >= RTTY_NULL_THRESHOLD) {
+      rttyLocked = false;
+      rttyFigures = 1;
+      nortty = 0;
+      rttyState = RTTY_IDLE;
+    }
+  } else {
     nortty = 0;
   } 
 
@@ -390,6 +574,31 @@ unsigned char GetFreqRange (unsigned int fbin, unsigned int ebin)
 
 
 
+void SetRTTYTones (int offset)
+{
+// Routine to set the Rx Mark/Space tones (Goertzel coefficients, correlation delays and waterfall markers).
+// offset (Hz) moves both tones when the dial is fine tuned without retuning the Si5351 (see FineTune())
+  // Define the Rx frequencies and delay values. Space frequency is fixed and Mark frequency moves up with the shift
+  rttySpaceFreq = RTTY_SPACE_FREQUENCY + offset;
+  rttyMarkFreq = RTTY_SPACE_FREQUENCY + rttyShift + offset;
+  rttyMarkBin = F_SAMPLE / rttyMarkFreq;          // Expected delay is a function of sample rate and frequency (similar to FFT)
+  rttySpaceBin = F_SAMPLE / rttySpaceFreq;
+
+  // FFT bins and rounded correlation delays for the waterfall markers
+  // Narrow waterfall shows 2 bins either side of Space/Mark so bin width on LCD is reduced for wider shifts
+  rttySpaceFFTBin = ((unsigned long)rttySpaceFreq * FHT_N + F_SAMPLE / 2) / F_SAMPLE;
+  rttyMarkFFTBin = ((unsigned long)rttyMarkFreq * FHT_N + F_SAMPLE / 2) / F_SAMPLE;
+  rttySpaceCBin = (F_SAMPLE + rttySpaceFreq / 2) / rttySpaceFreq;
+  rttyMarkCBin = (F_SAMPLE + rttyMarkFreq / 2) / rttyMarkFreq;
+  rttyPBBinWidth = PB_WINDOW_WIDTH / (max (rttyMarkFFTBin - rttySpaceFFTBin, rttySpaceCBin - rttyMarkCBin) + 5);
+  if (rttyPBBinWidth > PB_BIN_WIDTH) rttyPBBinWidth = PB_BIN_WIDTH;
+
+  // Goertzel coefficients (2cos(2 x pi x f / Fs) x 16384) used for carrier detect 
+  rttyMarkCoeff = (int)(2.0 * cos (2.0 * PI * (double)rttyMarkFreq / (double)F_SAMPLE) * GOERTZEL_SCALE);
+  rttySpaceCoeff = (int)(2.0 * cos (2.0 * PI * (double)rttySpaceFreq / (double)F_SAMPLE) * GOERTZEL_SCALE);
+}
+
+
 void ResetRTTY (void)
 {
   // Routine to reset all RTTY variables
@@ -407,33 +616,42 @@ void ResetRTTY (void)
   rttyFigures = 1; 
   rttyChar = 0; 
   bitpos = 0; 
-  rttyMark = 0; 
-  rttySpace = 0; 
   rttyState = RTTY_INIT;        // Initial RTTY state
-  rttyIdle = 0;
   nortty = 0;
   rttyLocked = false;
 
+  // Reset bit synchronizer (DPLL). Phase increment per sample is 65536 x baud / sample rate with 8 bits of fraction
+  // Whole part and fraction calculated seperately so that 32 bits does not overflow
+  rttyPhaseInc = ((RTTY_PHASE_BIT * rttyBaud) / (F_SAMPLE * 100UL)) << RTTY_PHASE_FRAC_BITS;
+  rttyPhaseInc += ((((RTTY_PHASE_BIT * rttyBaud) % (F_SAMPLE * 100UL)) << RTTY_PHASE_FRAC_BITS) + F_SAMPLE * 50UL) / (F_SAMPLE * 100UL);
+  rttyPhaseFrac = 0;
+  rttyDpllPhase = 0;
+  rttyBitSum = 0;
+  rttyBitMag = 0;
+  rttyLastD = 0;
+  rttyEdgeD = rttyEdgeMag = 0;
+  rttyEdgeSamples = 0;
+  rttyDpllErr = 0;
+  rttyBits = rttyFrameErrors = 0;
+  rttyOverruns = 0;
+  rttyLastStamp = adcSampleCtr;
+
   clipctr = clipctrrst = 0;
    
   rttySpaceMag = 0;
   rttyMarkMag = 0;
 
-  // Define the Rx frequencies and delay values
-  rttySpaceFreq = RTTY_SPACE_FREQUENCY;
-  rttyMarkFreq = RTTY_MARK_FREQUENCY;
-  rttyMarkBin = F_SAMPLE / rttyMarkFreq;          // Expected delay is a function of sample rate and frequency (similar to FFT)
-  rttySpaceBin = F_SAMPLE / rttySpaceFreq;
+  // Rx tones at their nominal frequencies and Si5351 at the dial frequency
+  EndFineTune ();
+
+  // Timer 4 baud clock for Tx bit time. Fractional so the average bit time is exact (e.g. 22.0022 ms for 45.45 baud)
+  // No Tx overhead since keying only writes registers
+  SetBaudClock (&rttyClock, rttyBaud);
 
   // Define default threshold for decode
   if (magThresh <= 0) magThresh = AUTOCORR_THRESHOLD;
   ThreshDivider = 8;
 
-  // Define default Tx frequencies
-  // There is a small shift to make the frequency appear as 1000 Hz on receiver's waterfall
-  rttyTransmitSpaceFreq = frequency_clk0 - RTTY_SHIFT_FREQUENCY + TX_FREQUENCY_OFFSET;
-  rttyTransmitMarkFreq = frequency_clk0 + TX_FREQUENCY_OFFSET;
-
   // Reset variables to switch between LTRS and FIGRS 
   rttyPriorState = 0xF;
   rttyLTRSSwitch = 0;
@@ -442,6 +660,7 @@ void ResetRTTY (void)
   flags &= ~TRANSMITRTTY;
   flags &= ~REALTIME;
   flags &= ~DECODERTTY;
+  flags &= ~RTTYDONE;
   flags &= ~PROCESSINGDONE;
   flags &= ~REALTIME;
   flags &= ~BUFF1DONE;
@@ -3,6 +3,12 @@
 
 unsigned char GetFreqRange (unsigned int fbin, unsigned int ebin);
 char DecodeRTTY (unsigned char bitvalue);
+char RTTYBitSync (long markpwr, long spacepwr, unsigned int elapsed);
+void SetRTTYConfig (unsigned char config);
+void NextRTTYConfig (void);
+void UpdateRTTYTxFrequencies (void);
+void LoadRTTYTxRegisters (unsigned char *mark, unsigned char *space);
+void SetRTTYTones (int offset);
 void ResetRTTY (void);
 void Pause (int dly);
 
@@ -30,7 +36,7 @@ int roundUp(int number, int fixedBase);
 //#define AUTOCORR_THRESHOLD  300000    // No filtering 150000
 #define AUTOCORR_THRESHOLD  5000    // Assume around S5 Signal Level to Start
 
-#define F_SAMPLE 9615
+// F_SAMPLE (9615 Hz) is calculated from F_CPU and the ADC prescaler in TimingConfig.h
 #define CORRECTION_DELAY 31     // Correction delay in us when using analog read;
 
 
@@ -52,17 +58,22 @@ int roundUp(int number, int fixedBase);
 
 #define BAUDOT_BITS 5
 #define BAUDOT_TABLE_SIZE 33
-
-// Free running is about 4.3ms and about 5 samples per bit.   
-// Depending where sample starts it may be 4,5,6 samples. Need to accomodate.  
-// For 1 bit (e.g. START bit, look for less than 4 sample to ensure detection)
-// Counts below start at 0 and value must be 1 less that actual value
-#define RTTY_TIMEOUT 5          // Number of samples to reset detection
-#define RTTY_NULL_THRESHOLD 5   // Number of Null RTTY bits to reset detection.
-#define RTTY_IDLE_THRESHOLD 35  // Idle is long string of MARK bits.
-#define RTTY_LTRS_THRESHOLD 31  // Letters Code.  Need at least 5 mark bit + 2 stop bits = 7 Mark bits. Look for 7 MARK bits (7x5 = 35, need 35 MARK bits)
-#define RTTY_STOP_THRESHOLD 1   // 3 Need to find 1.5 stop bits, look for 7 (1.5x5) MARK bits. Leave time to find next Start bit so look for 4 MARK bit 
-#define RTTY_START_THRESHOLD 1  // 2 Need to find 1 SPACE bit, Need 5 sample but look for 3 SPACE to be in the middle of the bit.
+#define ASCII_BAUDOT_TABLE_SIZE 128     // ASCII to baudot lookup table size
+#define BAUDOT_CODE_MASK 0x1F           // Baudot code in ASCII to baudot table
+#define BAUDOT_IN_LETTERS 0x20          // Character is in letters table
+#define BAUDOT_IN_FIGURES 0x40          // Character is in figures table
+#define BAUDOT_NOT_FOUND 0xFF
+
+// RTTY bit synchronizer (DPLL). ADC samples continuously and a block of 40 samples is about 4.2ms (about 5 blocks per bit)
+// The DPLL phase is 16 bits and wraps once per bit. Phase increment per sample is 65536 x baud / sample rate
+#define RTTY_PHASE_BIT 65536UL        // DPLL phase for one bit
+#define RTTY_PHASE_FRAC_BITS 8        // Fraction bits of DPLL phase increment (exact average bit rate)
+#define RTTY_PHASE_FRAC_MASK 0xFF
+#define RTTY_DPLL_SHIFT 2             // Phase correction at bit edge is error/4
+#define RTTY_EDGE_RATIO 4             // Mark-Space difference must be > 1/4 of Mark+Space power to be an edge
+#define RTTY_DECISION_RATIO 4         // Bit is unknown if Mark-Space difference over bit < 1/4 of Mark+Space power
+// RTTY_MAX_BLOCK_GAP (over 2 blocks of samples missed so bit timing lost) is in TimingConfig.h
+#define RTTY_NULL_THRESHOLD 5         // Number of Null RTTY bits to reset detection.
 
 #define RTTY_MODE 0
 #define PSK_MODE 1
@@ -73,15 +84,15 @@ int roundUp(int number, int fixedBase);
 #define RTTY_DIGIT 0
 
 #define RTTY_SPACE_FREQUENCY 830    // Mark Frequency is 1000 Hz, Space Frequency is 830 Hz, Mid Frequency is 915Hz
-#define RTTY_MARK_FREQUENCY 1000    // Mark Frequency is 1000 Hz, Space Frequency is 830 Hz, Mid Frequency is 915Hz
+#define RTTY_MARK_FREQUENCY 1000    // Mark Frequency for 170 Hz shift. Mark is Space + shift (see SetRTTYConfig())
 #define RTTY_SHIFT_FREQUENCY 170    // Shift of 170 Hz. This is the shift to make the frequency appear as 1000 Hz on receiver's waterfall
 
-#define RTTY_BAUD_DELAY 22                    // 22 ms per bit. i.e. Baud is 45.45 and bit time is 1/45.45=22 ms 
-#define RTTY_BAUD_OVERHEAD_DELAY 16           // 22 ms per bit but 6 ms overhead for frequency change so is 16ms
-#define RTTY_STOPBIT_DELAY 33                 // 33 ms for stop bit. i.e 1.5 stop bits which is 22ms + 11 ms = 33ms. With 6 ms overhead, its 28ms 
-#define RTTY_STOPBIT_OVERHEAD_DELAY 28        // 33 ms for stop bit. With 6 ms overhead, its 28ms 
-#define RTTY_IDLE_DELAY 352                   // assume 500ms for rtty receiver to lock onto signal
-#define RTTY_STOP_COUNT 1
-#define RTTY_IDLE_COUNT 15
+// Runtime baud rate and shift (see SetRTTYConfig()). Config byte is baud rate index (low nibble) and shift index (high nibble)
+#define RTTY_BAUD_RATES 3           // 45.45, 50, 75 baud
+#define RTTY_SHIFTS 3               // 170, 425, 850 Hz
+#define RTTY_CONFIG_BAUD_MASK 0x0F
+#define RTTY_CONFIG_SHIFT_POS 4
+#define RTTY_DEFAULT_CONFIG 0       // 45.45 baud, 170 Hz shift
+#define RTTY_MIN_BLOCKS_PER_BIT 3   // Bit synchronizer needs at least 3 blocks per bit
 
 #endif // _RTTY_H_
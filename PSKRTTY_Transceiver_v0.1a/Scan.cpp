@@ -0,0 +1,134 @@
+/*
+
+Band activity scanner.  The receiver is stepped across a range of frequencies and at each step one or two FFTs
+are done (short dwell) to measure the strongest peak in the audio passband.  The peak level (above the average
+of the passband) and bin of each step is stored in a compact activity table (scanTable[]).  After the scan the
+most active steps are sorted into scanList[] so that they can be listed and tuned to.
+
+Nothing is displayed on the LCD while scanning.  Steps are no larger than SI_RETUNE_MAX so the Si5351 is retuned
+with the fast path (see CalculateDividers()) and only the multisynth registers that change are written.  Scan
+speed is therefore the settle time (SCAN_SETTLE_US) plus SCAN_FFTS FFTs per step.  The first FFT needs FHT_N
+samples and the rest FHT_N2 samples each (overlapped windows, see ADC ISR).
+
+*/
+
+#include "Arduino.h"
+
+#include "AllIncludes.h"
+
+#include "AllExternVariables.h"
+
+
+unsigned char ScanBand (unsigned long start, unsigned long stop, unsigned int step)
+{
+// Routine to scan from start to stop in steps and fill the activity table. A character received on Serial1
+// stops the scan. Returns the number of steps scanned. scanStepsPerSec is the scan speed (x10)
+  unsigned char i, n;
+  unsigned long freq, stamp, elapsed;
+  ScanEntry_def entry;
+
+  memset (scanTable, 0, sizeof(scanTable));
+  scanStart = start;
+  scanStep = step;
+  scanSteps = 0;
+
+  setupFFT();
+  flags |= DOFHT;                     // ADC interupt fills FFT buffer
+  stamp = millis();
+
+  for (freq = start, i = 0; freq <= stop && i < SCAN_MAX_STEPS; freq += step, i++) {
+    if (Serial1.available()) break;
+
+    StopSampling();
+    SetFrequency (freq);
+    i2cFlush ();                      // Registers written
+    delayMicroseconds (SCAN_SETTLE_US);
+    StartSampling();                  // Discard samples taken before settling
+
+    for (n = 0; n < SCAN_FFTS; n++) {
+      if (!ScanMeasure (&entry)) break;
+      if (entry.level > scanTable[i].level) scanTable[i] = entry;
+    }
+    scanSteps++;
+  }
+
+  StopSampling();
+  flags &= ~DOFHT;
+  flags &= ~ADCDONE;
+
+  elapsed = millis() - stamp;
+  scanStepsPerSec = 0;
+  if (elapsed) scanStepsPerSec = ((unsigned long)scanSteps * 10000UL) / elapsed;
+
+  SortScanList ();
+
+  return scanSteps;
+}
+
+
+unsigned char ScanMeasure (ScanEntry_def *entry)
+{
+// Routine to wait for FHT_N samples, do an FFT and find the largest peak in the audio passband.
+// Level is the peak above the average of the passband. Returns 0 if no samples (timeout)
+  unsigned char i;
+  unsigned int avg;
+  unsigned long stamp;
+
+  stamp = micros();
+  while (!(flags & ADCDONE)) {
+    if (micros() - stamp > SCAN_FFT_TIMEOUT_US) return 0;
+  }
+
+  PerformFFT();
+  flags &= ~ADCDONE;                  // Capture next block while this one is measured
+
+  // Average level (noise floor) of the passband
+  avg = 0;
+  for (i = CARRIER_MIN_BIN; i <= CARRIER_MAX_BIN; i++) avg += fht_log_out[i];
+  avg /= (CARRIER_MAX_BIN - CARRIER_MIN_BIN + 1);
+
+  entry->level = 0;
+  entry->bin = 0;
+  for (i = CARRIER_MIN_BIN; i <= CARRIER_MAX_BIN; i++) {
+    if (fht_log_out[i] > avg && fht_log_out[i] - avg > entry->level) {
+      entry->level = fht_log_out[i] - avg;
+      entry->bin = i;
+    }
+  }
+
+  return 1;
+}
+
+
+void SortScanList (void)
+{
+// Routine to list the steps with the largest peaks (at least CARRIER_MARGIN above average) in scanList[].
+// Largest first. Insertion sort as the list is short
+  unsigned char i, j, k;
+
+  scanListCount = 0;
+  for (i = 0; i < scanSteps; i++) {
+    if (scanTable[i].level < CARRIER_MARGIN) continue;
+
+    // Find position in list
+    for (j = 0; j < scanListCount; j++) {
+      if (scanTable[i].level > scanTable[scanList[j]].level) break;
+    }
+    if (j >= SCAN_LIST_SIZE) continue;
+
+    // Make room
+    if (scanListCount < SCAN_LIST_SIZE) scanListCount++;
+    for (k = scanListCount - 1; k > j; k--) scanList[k] = scanList[k - 1];
+    scanList[j] = i;
+  }
+}
+
+
+unsigned long ScanTuneFrequency (unsigned char entry)
+{
+// Routine to return the frequency that puts the peak of a scanList[] entry at 1Khz (i.e. where the PSK decoder expects it)
+  unsigned char i;
+
+  i = scanList[entry];
+  return scanStart + (unsigned long)i * scanStep + binFreq[scanTable[i].bin] - PSK_CARRIER_FREQUENCY;
+}
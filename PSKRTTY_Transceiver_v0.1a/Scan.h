@@ -0,0 +1,23 @@
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+#define SCAN_MAX_STEPS 160              // Size of activity table (300 Khz band in 2 Khz steps is 150)
+#define SCAN_DEFAULT_STEP 2000          // Step (Hz). Passband searched is 300-3000 Hz so steps overlap
+#define SCAN_MAX_STEP SI_RETUNE_MAX     // Larger steps would not use the fast retune path (see CalculateDividers())
+#define SCAN_FFTS 2                     // FFTs per step. Peak is the largest of these
+#define SCAN_SETTLE_US 3000             // Si5351 and receiver audio settle time after retuning
+#define SCAN_FFT_TIMEOUT_US 50000       // Give up waiting for FFT samples (FHT_N samples is 13 ms)
+#define SCAN_LIST_SIZE 8                // Most active frequencies listed after the scan
+
+typedef struct {
+  unsigned char level;                  // Peak above passband average (fht_log_out units, 16 = 6 dB)
+  unsigned char bin;                    // FFT bin of peak
+} ScanEntry_def;
+
+// Band Scanner Routines
+unsigned char ScanBand (unsigned long start, unsigned long stop, unsigned int step);
+unsigned char ScanMeasure (ScanEntry_def *entry);
+void SortScanList (void);
+unsigned long ScanTuneFrequency (unsigned char entry);
+
+#endif // _SCAN_H_
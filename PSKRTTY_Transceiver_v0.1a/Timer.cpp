@@ -13,19 +13,55 @@ Program Written by Dave Rajnauth, VE3OOI to control and service timer interupts
 
 //////////////////////////////////
 // Timer1 ISR - used for encoder and pushbutton polling. It runs at 3ms
+// Control pins are read once. If nothing changed and the controls are idle (released and debounce/relaxation
+// periods over) the ISR returns straight away. TCNT1 at exit is the time in the ISR (4 us ticks) since the compare
 //////////////////////////////////
 ISR(TIMER1_COMPA_vect)
 {
+  unsigned char h, e, b, active;
+
+  h = ENC_PORT & CTL_PINH_MASK;
+  e = ENC_PBPORT & CTL_PINE_MASK;
+  b = PBUTTON_PORT & CTL_PINB_MASK;
+  ctlPolls++;
+
+  // A debounced button that is held keeps the controls active (long press timing)
+  if (h != ctlPinH || e != ctlPinE || b != ctlPinB || buttons.state) {
+    ctlPinH = h;
+    ctlPinE = e;
+    ctlPinB = b;
+    ctlHold = CTL_HOLD_POLLS;
+  } else if (ctlHold) {
+    ctlHold--;
+  } else {
+    ctlIsrTicks += TCNT1;
+    return;
+  }
+
+  ctlActivePolls++;
   CheckEncoder();
-  CheckPushButtons ();
+
+  // Buttons that are pushed. Push buttons read high when pushed and the encoder button low
+  active = 0;
+  if (h & PBUTTON1_BIT) active |= BTN_PB1;
+  if (b & PBUTTON2_BIT) active |= BTN_PB2;
+  if (b & PBUTTON3_BIT) active |= BTN_PB3;
+  if (!(e & ENC_PB_BIT)) active |= BTN_ENC;
+  DebounceButtons (&buttons, active);
+  ctlIsrTicks += TCNT1;
 }
 
 
 //////////////////////////////////
 // Timer3 ISR - used for PSK decode. It runs at 31.25 baud or 32 ms duty cycle
+// Period is set each bit by the PSK baud clock (pskClock)
 //////////////////////////////////
 ISR(TIMER3_COMPA_vect)
 {
+  unsigned long start;
+  
+  start = micros();
+  OCR3A = NextBaudCount (&pskClock);     // Period of the next bit. CTC counter has restarted so applies now
 
   // For decode send signal to check signal for phase change.  
   if (flags & DECODEPSK) {
@@ -33,54 +69,103 @@ ISR(TIMER3_COMPA_vect)
     
   // For Tx, transmit a bit  
   } else if (flags & TRANSMITPSK) {
-    if (! (flags & TRANSMIT_CHAR_DONE) ) {            // Check if all bits transmitted
-      if (  !(pskVcode & (1 << bitpos++)) ) {         // Check bit value and invert clock for 0 bit.  Clock inversion is same as 180 degree phase shift)
-        digitalWrite(TxEnable, LOW);                  // Turn off transmitter, power output decreases. helps reduce harmonics when carrier phase changed.  Phase changed for "0" bit
-        InvertClk (pskSwap);                          // Invert carrier 
-        digitalWrite(TxEnable, HIGH);                 // Enable transmitter, power ouput increases
-        if (!pskSwap) pskSwap = 1;                    // Set phase change variable
-        else pskSwap = 0;
-      }
-      
-      // If all bits transmitted, then signal character done
-      // pskVcodeLen is increased by 2 to allow 2 "0" bit to be transmitted (stop condition)
-      if (bitpos >= pskVcodeLen) {                    
-        flags |= TRANSMIT_CHAR_DONE;
-      }
-     
+    // If all bits of current symbol transmitted, get next symbol from Tx queue. 
+    // Symbol includes the "0" bits for the intercharacter gap. If queue is empty a "0" bit (idle) is sent
+    if (bitpos >= txSymbolLen) {
+      PullTxSymbol (TX_PSK_IDLE_BITS);
+    }
+
+    // Check bit value and invert clock for 0 bit.  Clock inversion is same as 180 degree phase shift)
+    // Inverting the clock is I2C so its deferred to the main loop (see WorkQueue.cpp)
+    if (  !(txSymbol & (1 << bitpos++)) ) {
+      PushWork (WORK_PSK_INVERT, pskSwap);            // Invert carrier 
+      if (!pskSwap) pskSwap = 1;                      // Set phase change variable
+      else pskSwap = 0;
     }
     
+    start = micros() - start;
+    if (start > txISRMaxTime) txISRMaxTime = start;
   }
 
 }
 
 //////////////////////////////////
-// Timer4 ISR - used for RTTY decode. It run at 45.45 baud or 22 ms
+// Timer4 ISR - used for RTTY transmit. It run at 45.45 baud or 22 ms
+// RTTY Rx samples continuously and bit timing is recovered by RTTYBitSync() so Timer4 not used for Rx
+// Period is set each bit by the RTTY baud clock (rttyClock)
 //////////////////////////////////
 ISR(TIMER4_COMPA_vect)
 {
-  // For RTTY Rx, disable realtime acquisition (i.e. ADC free running mode) and sample every 22ms
-  if (flags & DECODERTTY) {
-    flags &= ~REALTIME;
-    StartSampling ();
-
+  unsigned long start;
+  
+  start = micros();
+  OCR4A = NextBaudCount (&rttyClock);    // Period of the next bit
   // Transmitt RTTY bit
-  } else if (flags & TRANSMITRTTY) {
-    if (! (flags & TRANSMIT_CHAR_DONE) ) {      // Check if all bits transmitted.    
-      if (rttyChar & (1 << bitpos++)) {         // if a "1" bit send MARK frequency and if 0 bit send space bit
-        TxRTTYbit(1);                           // Transmit a 1 bit
-      } else {    
-        TxRTTYbit(0);                           // Transmit a 0 bit
-      }
-
-      // Check is all 8 bits sent.
-      // Note that start bit and 2 stop bits padded to 5 bit baudot code
-      if (bitpos > 7) {     
-        flags |= TRANSMIT_CHAR_DONE;
-      }
-      
+  if (flags & TRANSMITRTTY) {
+    // If all bits of current symbol transmitted, get next symbol from Tx queue.
+    // Note that start bit and 2 stop bits padded to 5 bit baudot code. If queue is empty a MARK bit (idle) is sent
+    if (bitpos >= txSymbolLen) {
+      PullTxSymbol (TX_RTTY_IDLE_BITS);
     }
+
+    // if a "1" bit send MARK frequency and if 0 bit send space bit
+    // Changing frequency is I2C so its deferred to the main loop (see WorkQueue.cpp)
+    if (txSymbol & (1 << bitpos++)) {
+      PushWork (WORK_RTTY_KEY, 1);              // Transmit a 1 bit
+    } else {    
+      PushWork (WORK_RTTY_KEY, 0);              // Transmit a 0 bit
+    }
+
+    start = micros() - start;
+    if (start > txISRMaxTime) txISRMaxTime = start;
+  }
+}
+
+
+//////////////////////////////////
+// Fractional baud clock - next timer period
+//////////////////////////////////
+unsigned int NextBaudCount (BaudClock_def *bc)
+{
+// Called from the timer ISR at the start of each symbol. Returns the compare value for the symbol.
+// The fraction of a tick is accumulated and when it exceeds 1 tick (i.e. baud) the period is one tick longer
+  
+  bc->symbols++;
+  bc->acc += bc->rem;
+  if (bc->acc >= bc->baud) {
+    bc->acc -= bc->baud;
+    return bc->count;                           // One tick longer (CTC period is count + 1)
   }
+  return bc->count - TIMER_CTC_ADJUST;
+}
+
+//////////////////////////////////
+// Fractional baud clock - set baud rate
+//////////////////////////////////
+void SetBaudClock (BaudClock_def *bc, unsigned int baud)
+{
+// baud is x100 (e.g. 4545 for 45.45 baud). Symbol time is TIMER_64_HZ x 100 / baud ticks which is split 
+// into whole ticks (count) and the remainder (rem/baud). Lowest baud is 3.82 so that count fits in 16 bits
+
+  bc->baud = baud;
+  bc->count = (TIMER_64_HZ * 100) / baud;
+  bc->rem = (TIMER_64_HZ * 100) % baud;
+  bc->acc = 0;
+  bc->symbols = 0;
+  bc->start = 0;
+}
+
+//////////////////////////////////
+// Fractional baud clock - enable timer
+//////////////////////////////////
+void EnableBaudClock (unsigned char timer, BaudClock_def *bc)
+{
+// Start the baud clock on Timer 3 or 4. The accumulator is reset so that the first symbol starts on a whole tick
+
+  bc->acc = 0;
+  bc->symbols = 0;
+  bc->start = micros();
+  EnableTimers (timer, bc->count - TIMER_CTC_ADJUST);
 }
 
 
@@ -191,10 +276,11 @@ void EnableTimers (unsigned char timer, unsigned int count)
       TCCR3B = 0;     // TCCRxB turns off timer
       TCNT3 = 0;      // Zero out counter
 
-      // Set match register to 500  for 32ms (or 31.25 Hz or Baud) with /1024 prescaller
+      // Set match register to 7999  for 32ms (or 31.25 Hz or Baud) with /64 prescaller
+      // The baud clock (see EnableBaudClock()) updates the match register each bit 
       OCR3A = count;                            // set compare match register for interval
       TCCR3B |= (1 << WGM32);                   // turn on CTC mode
-      TCCR3B |= (1 << CS30) | (1 << CS32);      // Set CSx0/CSx2 for /1024 prescaler
+      TCCR3B |= (1 << CS30) | (1 << CS31);      // Set CSx0/CSx1 for /64 prescaler
       TIFR3 |= (1 << ICF3) | (1 << OCF3A) | (1 << OCF3B) | (1 << OCF3C);    // Clear Interrupt Flags (write 1)
       TIMSK3 |= (1 << OCIE3A);                  // enable timer compare interrupt:
       break;
@@ -204,10 +290,11 @@ void EnableTimers (unsigned char timer, unsigned int count)
       TCCR4B = 0;     // TCCRxB turns off timer
       TCNT4 = 0;      // Zero out counter
 
-      // Set match register to 344  for 22ms (or 45.45 Hz or Baud) with /1024 prescaller
+      // Set match register to 5499  for 22ms (or 45.45 Hz or Baud) with /64 prescaller
+      // The baud clock (see EnableBaudClock()) updates the match register each bit 
       OCR4A = count;                            // set compare match register for interval
       TCCR4B |= (1 << WGM42);                   // turn on CTC mode
-      TCCR4B |= (1 << CS40) | (1 << CS42);      // Set CSx0/CSx2 for /1024 prescaler
+      TCCR4B |= (1 << CS40) | (1 << CS41);      // Set CSx0/CSx1 for /64 prescaler
       TIMSK4 |= (1 << OCIE4A);                  // enable timer compare interrupt:
       break;
 
@@ -1,14 +1,26 @@
 #ifndef _TIMER_H_
 #define _TIMER_H_
 
-#define TIMER22MS  340         // Counter for 22 ms, default 344
-#define TIMER32MS  500         // Counter for 32 ms, default 500
-#define TIMER5MS   1250        // Counter for 5 ms, default 1250
-#define TIMER1MS   250         // Counter for 1 ms, default 250
-#define TIMER3MS   750         // Counter for 3 ms, default 750
+// Timer 1 count (TIMER3MS) and the baud clock timer clock (TIMER_64_HZ) are calculated in TimingConfig.h
+#define TIMER_CTC_ADJUST 1     // CTC mode period is count + 1
+
+// Fractional baud clock. The timer period (ticks) for a symbol is rarely a whole number (e.g. 45.45 baud is 5500.55 ticks)
+// Each symbol the fraction (rem/baud) is added to a phase accumulator and the period is one tick longer when it overflows
+// The average symbol rate is exact and the error never exceeds one tick (4 us)
+typedef struct {
+  unsigned int count;          // Whole timer ticks per symbol
+  unsigned int rem;            // Fraction of a tick per symbol (rem/baud)
+  unsigned int baud;           // Baud rate x100
+  unsigned int acc;            // Phase accumulator for the fraction
+  unsigned long symbols;       // Symbols clocked since enabled (used to measure the rate)
+  unsigned long start;         // Time (us) clock enabled
+} BaudClock_def;
 
 // Timer Control Routines
 void EnableTimers (unsigned char timer, unsigned int count);
+void SetBaudClock (BaudClock_def *bc, unsigned int baud);
+void EnableBaudClock (unsigned char timer, BaudClock_def *bc);
+unsigned int NextBaudCount (BaudClock_def *bc);
 void DisableTimers (unsigned char timer);
 void Pause (int dly);
 void DisableTimer0 (void);
@@ -0,0 +1,115 @@
+/*
+
+Timing configuration calculated at compile time from the CPU clock (F_CPU), timer/ADC prescalers, sample rate,
+block sizes and baud rates.
+
+The Arduino compiler is C++11 so the constexpr functions below are a single return statement. The values are
+constexpr constants so there is no runtime cost (same as the hand calculated #defines they replace).
+The static_asserts check that counts fit the timer registers and that rounding errors are small.
+To use a different clock or sample rate only the base values at the top need to be changed.
+
+*/
+
+#ifndef _TIMINGCONFIG_H_
+#define _TIMINGCONFIG_H_
+
+// Base values
+#ifndef F_CPU
+#define F_CPU 16000000UL              // Set by Arduino IDE for the board
+#endif
+#define CFG_ADC_PRESCALER 128         // ADC clock prescaler (see EnableADC())
+#define CFG_ADC_CYCLES 13             // ADC clocks per conversion in free running mode
+#define CFG_TIMER1_PRESCALER 64       // Timer 1 (encoder/push buttons)
+#define CFG_BAUD_PRESCALER 64         // Timer 3 and 4 (baud clocks)
+#define CFG_MAX_ERROR_PPM 1000        // Maximum rounding error of a derived value (0.1%)
+
+#define PSK_BAUD_X100  3125           // PSK31 baud rate x100
+#define RTTY_SLOWEST_BAUD_X100 4545   // Slowest and fastest RTTY baud rates (see rttyBaudRates[])
+#define RTTY_FASTEST_BAUD_X100 7500
+#define RTTY_WIDEST_SHIFT 850         // Widest RTTY shift (see rttyShifts[])
+
+#define PSK_BLOCK_SAMPLES (2 * CROSSCORRSZ)   // PSK block is two back to back correlation buffers
+#define RTTY_BLOCK_SAMPLES CORRBUFFSZ
+
+
+// Calculations
+constexpr unsigned long CfgDivRound (unsigned long long num, unsigned long long den)
+{
+  return (num + den / 2) / den;
+}
+
+constexpr unsigned long CfgAbsDiff (unsigned long long a, unsigned long long b)
+{
+  return a > b ? a - b : b - a;
+}
+
+// Error (ppm) of an integer value compared to the exact value num/den
+constexpr unsigned long CfgErrorPPM (unsigned long value, unsigned long long num, unsigned long long den)
+{
+  return CfgAbsDiff ((unsigned long long)value * den, num) * 1000000ULL / num;
+}
+
+// Timer compare value for a period (us) in CTC mode (period is count + 1)
+constexpr unsigned int CfgTimerCount (unsigned long prescaler, unsigned long us)
+{
+  return CfgDivRound ((unsigned long long)F_CPU * us, (unsigned long long)prescaler * 1000000ULL) - 1;
+}
+
+// Error (ppm) of a timer compare value for a period (us)
+constexpr unsigned long CfgTimerErrorPPM (unsigned long prescaler, unsigned long us)
+{
+  return CfgErrorPPM (CfgTimerCount (prescaler, us) + 1, (unsigned long long)F_CPU * us, (unsigned long long)prescaler * 1000000ULL);
+}
+
+// Timer ticks per symbol (whole ticks) for a baud rate x100
+constexpr unsigned long CfgBaudTicks (unsigned long prescaler, unsigned long baud)
+{
+  return (F_CPU / prescaler) * 100 / baud;
+}
+
+// Sample blocks per bit for a baud rate x100 (rounded down)
+constexpr unsigned int CfgBlocksPerBit (unsigned long baud, unsigned int samples)
+{
+  return (unsigned long long)F_CPU * 100 / ((unsigned long long)CFG_ADC_PRESCALER * CFG_ADC_CYCLES * baud * samples);
+}
+
+// Sample blocks in a number of bits (rounded up)
+constexpr unsigned int CfgBlocksInBits (unsigned int bits, unsigned long baud, unsigned int samples)
+{
+  return ((unsigned long long)F_CPU * 100 * bits + (unsigned long long)CFG_ADC_PRESCALER * CFG_ADC_CYCLES * baud * samples - 1) /
+         ((unsigned long long)CFG_ADC_PRESCALER * CFG_ADC_CYCLES * baud * samples);
+}
+
+
+// Derived values
+constexpr int F_SAMPLE = CfgDivRound (F_CPU, (unsigned long)CFG_ADC_PRESCALER * CFG_ADC_CYCLES);   // 9615 Hz
+
+constexpr unsigned long TIMER_64_HZ = F_CPU / CFG_BAUD_PRESCALER;       // Baud clock timer clock (250 Khz)
+
+constexpr unsigned int TIMER3MS = CfgTimerCount (CFG_TIMER1_PRESCALER, 3000);     // Counter for 3 ms
+
+// PSK blocks between phase reversals for a "00" (i.e. one bit). Lose one count when phase changes (see DecodePSK())
+constexpr unsigned char PSK_DECODE_START = CfgBlocksPerBit (PSK_BAUD_X100, PSK_BLOCK_SAMPLES);      // 11
+constexpr unsigned char PSK_DECODE_NOSTART = PSK_DECODE_START + 3;                                  // Greater than start threshold
+constexpr unsigned char PSK_NO_LOCK_THRESHOLD = CfgBlocksInBits (5, PSK_BAUD_X100, PSK_BLOCK_SAMPLES);   // No phase shift for 5 bits (60)
+
+// RTTY bit synchronizer timing lost if more than 2.5 blocks of samples missed
+constexpr unsigned int RTTY_MAX_BLOCK_GAP = RTTY_BLOCK_SAMPLES * 5 / 2;
+
+
+// Checks
+static_assert (CfgErrorPPM (F_SAMPLE, F_CPU, (unsigned long)CFG_ADC_PRESCALER * CFG_ADC_CYCLES) < CFG_MAX_ERROR_PPM, "F_SAMPLE rounding error too large");
+static_assert (TIMER3MS > 0 && TIMER3MS <= 0xFFFF, "Timer 1 count out of range. Change CFG_TIMER1_PRESCALER");
+static_assert (CfgTimerErrorPPM (CFG_TIMER1_PRESCALER, 3000) < CFG_MAX_ERROR_PPM, "Timer 1 rounding error too large");
+static_assert (CfgBaudTicks (CFG_BAUD_PRESCALER, PSK_BAUD_X100) <= 0xFFFF, "PSK baud clock count does not fit Timer 3");
+static_assert (CfgBaudTicks (CFG_BAUD_PRESCALER, RTTY_SLOWEST_BAUD_X100) <= 0xFFFF, "RTTY baud clock count does not fit Timer 4");
+static_assert (1000000UL / CfgBaudTicks (CFG_BAUD_PRESCALER, RTTY_FASTEST_BAUD_X100) < CFG_MAX_ERROR_PPM, "Baud clock jitter (1 tick) too large");
+static_assert (PSK_DECODE_START >= 4 && PSK_NO_LOCK_THRESHOLD < 0xFF, "PSK block size does not suit sample rate");
+static_assert (CfgBlocksPerBit (RTTY_FASTEST_BAUD_X100, RTTY_BLOCK_SAMPLES) >= RTTY_MIN_BLOCKS_PER_BIT, "Too few RTTY blocks per bit at fastest baud rate");
+static_assert ((PSK_CARRIER_FREQUENCY + TUNE_WINDOW_PSK) * 2 < F_SAMPLE && (RTTY_SPACE_FREQUENCY + RTTY_WIDEST_SHIFT + TUNE_WINDOW_RTTY) * 2 < F_SAMPLE, "Tone frequency (including fine tuning) above Nyquist");
+static_assert (RTTY_SPACE_FREQUENCY > TUNE_WINDOW_RTTY && PSK_CARRIER_FREQUENCY > TUNE_WINDOW_PSK, "Fine tuning window moves tone below 0 Hz");
+static_assert (FHT_N == 2 * FHT_N2 && !(FHT_N & (FHT_N - 1)), "FFT sample ring needs FHT_N a power of 2 and FHT_N2 half of it");
+static_assert (FHT_ROW_MAX_FFTS * 255UL <= 0xFFFF && FHT_ROW_MAX_FFTS <= 0xFF, "fhtRowSum[] or fhtRowFFTs can overflow");
+static_assert (WF_ROW_BINS <= FHT_N2 && WF_START_Y + WF_WIN_SIZE <= MAX_Y, "Waterfall row or scroll area does not fit");
+
+#endif // _TIMINGCONFIG_H_
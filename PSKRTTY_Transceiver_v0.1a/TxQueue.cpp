@@ -0,0 +1,131 @@
+/*
+
+Routines to pre-encode characters to be transmitted into a queue of symbols.
+
+The main loop converts text in rbuff into symbols (Varicode bits plus intercharacter gap for PSK or
+Baudot frames with LTRS/FIGRS switch codes for RTTY) ahead of time.  Timer3 (PSK) and Timer4 (RTTY) pull
+the next symbol directly from the queue once the current symbol is sent.  This way character timing
+does not depend on how long the main loop takes (e.g. LCD echo or serial processing).
+
+*/
+
+#include "Arduino.h"
+
+#include "AllIncludes.h"
+
+#include "AllExternVariables.h"
+
+
+void ResetTxQueue (void)
+{
+// Routine to empty the queue and the symbol being transmitted
+  txQueueHead = txQueueTail = 0;
+  txSymbol = 0;
+  txSymbolLen = 0;
+  bitpos = 0;
+}
+
+
+unsigned char TxQueueCount (void)
+{
+// Return number of symbols waiting to be transmitted
+  return (unsigned char)(txQueueHead - txQueueTail) & TX_QUEUE_MASK;
+}
+
+
+unsigned char TxQueueSpace (void)
+{
+// Return number of free symbols. One entry is always left empty to tell full from empty
+  return (TX_QUEUE_SIZE - 1) - TxQueueCount ();
+}
+
+
+void PushTxSymbol (unsigned int bits, unsigned char len)
+{
+// Routine to add a symbol to the queue. Caller must check for space using TxQueueSpace()
+// The head is only updated after the entry is filled so the timer ISR never sees a partial entry
+  unsigned char head;
+
+  head = txQueueHead;
+  txQueue[head].bits = bits;
+  txQueue[head].len = len;
+  txQueueHead = (head + 1) & TX_QUEUE_MASK;
+}
+
+
+void PullTxSymbol (unsigned int idlebits)
+{
+// Routine called by the Tx timer ISR when all bits of the current symbol are sent.
+// Load the next symbol from the queue. If queue is empty then send a 1 bit idle symbol and
+// signal the main loop (TRANSMIT_CHAR_DONE) that the transmitter is idle
+  unsigned char tail;
+
+  tail = txQueueTail;
+  if (tail != txQueueHead) {
+    txSymbol = txQueue[tail].bits;
+    txSymbolLen = txQueue[tail].len;
+    txQueueTail = (tail + 1) & TX_QUEUE_MASK;
+    flags &= ~TRANSMIT_CHAR_DONE;
+  } else {
+    txSymbol = idlebits;
+    txSymbolLen = TX_IDLE_BIT_LEN;
+    flags |= TRANSMIT_CHAR_DONE;
+  }
+  bitpos = 0;
+}
+
+
+void EncodeTxQueue (void)
+{
+// Routine used to convert characters in rbuff to symbols and fill the queue.  Called from the main loop
+// Characters are echoed on the LCD when they are encoded (i.e. slightly ahead of the actual transmission)
+  char temp;
+  unsigned char baudot;
+
+  if (flags & TRANSMITRTTY) {
+
+    // Transmitter turned on for the first time, so send 3 idle code to synchronize the receiver
+    while (idle < RTTY_PREAMBLE_COUNT && TxQueueSpace ()) {
+      PushTxSymbol (0xFF, RTTY_FRAME_BITS);         // Send idle (i.e. constant mark) for 3 characters
+      idle++;
+    }
+    if (idle < RTTY_PREAMBLE_COUNT) return;
+
+    // Need room for Letters/Figures switch code and character
+    while (rbuff[0] && TxQueueSpace () >= 2) {
+      temp = SerialTerminalPop();                   // Pop a character from rbuff 
+      LCDDisplayCharacter(temp);              
+      baudot = setupRTTYChar (temp);                // Need to convert ASCII char to Baudot using Letters/Figures tables. 
+
+      // setupRTTYChar() signals when a Letters/Figures switch is needed.  Send it ahead of the character
+      if (rttyLTRSSwitch) {
+        PushTxSymbol (rttyFigures, RTTY_FRAME_BITS);
+        rttyLTRSSwitch = 0;
+      }
+      PushTxSymbol (baudot, RTTY_FRAME_BITS);
+    }
+
+    // Nothing to be transmitted so keep sending LTRS code
+    if (!TxQueueCount ()) {
+      baudot = setupRTTYChar (0);
+      PushTxSymbol (baudot, RTTY_FRAME_BITS);
+    }
+
+  } else if (flags & TRANSMITPSK) {
+
+    // Transmitter turned on for the first time, so send 10 idle codes to synchronize the receiver (for PSK this is consecutive phase shifts)
+    if (!idle) {
+      PushTxSymbol (0, PSK_IDLE_COUNT);
+      idle++;
+    }
+
+    // Nothing to be transmitted the timer sends idle (phase shifts) on its own
+    while (rbuff[0] && TxQueueSpace ()) {
+      temp = SerialTerminalPop();
+      LCDDisplayCharacter(temp);         
+
+      // Varicode is variable length. Add consecutive 0 bits for intercharacter gap (i.e. phase shifts for Synchronization)
+      PushTxSymbol (LookupVaricode(temp), LookupVaricodeLength(temp) + PSK_CHAR_GAP_COUNT);
+    }
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef _TXQUEUE_H_
+#define _TXQUEUE_H_
+
+// Transmit Symbol Queue Routines
+void ResetTxQueue (void);
+unsigned char TxQueueSpace (void);
+unsigned char TxQueueCount (void);
+void PushTxSymbol (unsigned int bits, unsigned char len);
+void PullTxSymbol (unsigned int idlebits);
+void EncodeTxQueue (void);
+
+#define TX_QUEUE_SIZE 16                // Number of pre-encoded symbols. Must be power of 2
+#define TX_QUEUE_MASK (TX_QUEUE_SIZE-1)
+
+#define TX_IDLE_BIT_LEN 1               // Idle symbol sent by timer when queue empty is 1 bit long
+#define TX_PSK_IDLE_BITS 0              // PSK idle is a "0" bit (i.e. phase reversal)
+#define TX_RTTY_IDLE_BITS 1             // RTTY idle is a "1" bit (i.e. mark frequency)
+
+#define RTTY_FRAME_BITS 8               // Start bit + 5 Baudot bits + 2 Stop bits
+#define RTTY_PREAMBLE_COUNT 3           // Number of idle characters (constant mark) sent when Tx starts
+
+typedef struct {
+  unsigned int bits;                    // Bits to send. LSB first
+  unsigned char len;                    // Number of bits to send
+} TxSymbol_def;
+
+#endif // _TXQUEUE_H_
@@ -77,6 +77,7 @@ void DisplayHelp (unsigned char serialport)
 
   if (serialport) {
     Serial1.println ("\r\n");
+    Serial1.println ("^A - RTTY Baud/Shift");
     Serial1.println ("^B - Toggle HEX Display");
     Serial1.println ("^C - Clear LCD");
     Serial1.println ("^D - Capture Call Sign");
@@ -98,8 +99,12 @@ void DisplayHelp (unsigned char serialport)
     Serial1.println ("^W - Enable Waterfall");
     Serial1.println ("^X - Dump ADC Samples");
     Serial1.println ("^Z - Reset");
+    Serial1.println ("^\\ - Dual RTTY/PSK Rx");
+    Serial1.println ("^] - Memory Channels");
+    Serial1.println ("^^ - Band Scan");
   } else {
     Serial2.println ("\r\n");
+    Serial2.println ("^A - RTTY Baud/Shift");
     Serial2.println ("^B - Toggle HEX Display");
     Serial2.println ("^C - Clear LCD");
     Serial2.println ("^D - Capture Call Sign");
@@ -121,6 +126,9 @@ void DisplayHelp (unsigned char serialport)
     Serial2.println ("^W - Enable Waterfall");
     Serial2.println ("^X - Dump ADC Samples");
     Serial2.println ("^Z - Reset");
+    Serial2.println ("^\\ - Dual RTTY/PSK Rx");
+    Serial2.println ("^] - Memory Channels");
+    Serial2.println ("^^ - Band Scan");
   }
   
 }
@@ -128,7 +136,7 @@ void DisplayHelp (unsigned char serialport)
 
 void ProcessSerialTerminal ( void )
 // This routing is called to check is there is serial input and store the input into the serial buffer
-// If a specific control code (binary 0x01 to 0x1A) is found then process the code otherwise 
+// If a specific control code (binary 0x01 to 0x1C) is found then process the code otherwise 
 // complete process appropriate to the current mode (e.g. receiver, transmit, waterfall spectrum, etc
 
 // When in transmit mode any character entered will be stored in the serial buffer then 
@@ -213,6 +221,9 @@ void ProcessSerialTerminal ( void )
     }
   } 
 
+  // Act on debounced button events (latches push button presses for the menu below)
+  ProcessButtonEvents ();
+
   // Push buttom menu code below will copy control codes and/or messages to rbuff  which is processed downstream
   if (IsPushed (PBUTTON1) || IsPushed (PBUTTON2) || IsPushed (PBUTTON3)) {
     temp = PButtonMenu ();
@@ -274,85 +285,19 @@ void ProcessSerialTerminal ( void )
     }
   }
 
-  // Transmitting RTTY. Transmit next character in rbuff. 
+  // Transmitting RTTY. Encode characters in rbuff into Tx queue. Tx timer pulls the symbols from the queue 
   if ( flags & TRANSMITRTTY ) {
+    // Frequency display not updated when rotary switch turned. Updating LCD is slow but Tx timing is not affected because queue is filled ahead of time
+    UpdateFrequencyData (0);           // Update frequency display and DON'T change frequency of OSC.  Tx timer changes Mark/Space frequency based on bit value
+    EncodeTxQueue ();
 
-    // Character transmission done (flag set by Tx Timer) so send next character or continue to send idle code (for RTTY this is Mark frequency)
-    if (flags & TRANSMIT_CHAR_DONE) {
-      // Frequency display not updated when rotary switch turned.  Updating frequency data on LCD is slow and will result in syncronization error.
-      UpdateFrequencyData (0);           // Update frequency display and DON'T change frequency of OSC.  Tx timer changes Mark/Space frequency based on bit value
-
-      // Transmitter turned on for the first time, so send 2 idle code to synchronize the receiver
-      if (idle < 3) {                   // Send idle (i.e. constant mark) for 3 characters
-        rttyChar = 0xFF;
-        bitpos = 0;
-        flags &= ~TRANSMIT_CHAR_DONE;
-        idle++;
-
-      // Check for character and transmit it. If no character then send idle code
-      } else {
-
-        // Need to switch between Letters and Figures depending of character to be transmitted. rttyLTRSSwitch signal when we need to do a switch
-        // This is used to define where a Letters/Figures switch is needed (i.e. transmit switch characters and not transmit character)
-        if (!rttyLTRSSwitch) {
-          temp = SerialTerminalPop();       // Pop a character from rbuff 
-          if (temp) {                       // Echo character on LCD
-            LCDDisplayCharacter(temp);              
-          }
-          rttyChar = setupRTTYChar (temp);  // Need to convert ASCII char to Baudot using Letters/Figures tables. 
-          
-          if (rttyLTRSSwitch) {             // If a switch is needed (setupRTTYchar signals switch), then setup to transmit it on the next loop
-            rttyLTRSSwitch = rttyChar;
-            rttyChar = rttyFigures;
-          }
-          bitpos = 0;                       // Bitpos is used by the Rx Tx Timer to know what bit to transmit in to character to be transmitted
-          flags &= ~TRANSMIT_CHAR_DONE;     // Signal Tx time to start sending bits.  After all bits transmitted, timer sets character done flag
-
-        // Transmit Letters/Figures switch character
-        } else {
-          rttyChar = rttyLTRSSwitch;
-          rttyLTRSSwitch = 0;
-          bitpos = 0;
-          flags &= ~TRANSMIT_CHAR_DONE;
-        }
-      }        
-    }
-
-  // Transmitting PSK. Transmit next character in rbuff.  
+  // Transmitting PSK. Encode characters in rbuff into Tx queue.
   } else if (flags & TRANSMITPSK) {
-
-    // Character transmission done (flag set by Tx Timer) so send next character or continue to send idle code (for PSK this is consecutive phase shifts)
+    // Only change frequency of OSC when queue is empty (i.e. timer sending idle phase shifts) so that a character is not corrupted
     if (flags & TRANSMIT_CHAR_DONE) {
       UpdateFrequencyData (1);        // Update frequency display and change frequency of OSC. PSK only changes phase of alreay running carrier
-
-      // Transmitter turned on for the first time, so send 10 idle codes to synchronize the receiver (for PSK this is consecutive phase shifts)
-      if (!idle) {                    // Send idle (i.e. constant mark) for 3 characters
-        pskVcode = 0;
-        pskVcodeLen = 10;
-        bitpos = 0;
-        flags &= ~TRANSMIT_CHAR_DONE;
-        idle++;
-
-      // Check for character and transmit it. If no character then send idle code
-       } else if (rbuff[0]) {
-        temp = SerialTerminalPop();
-        if (temp) {
-          LCDDisplayCharacter(temp);         
-        }
-        pskVcode = LookupVaricode(temp);         // Convert ASCI to PSK Varicode
-        pskVcodeLen = numbits (pskVcode);        // Varicode is variable length and need to define number of bits to Tx
-        pskVcodeLen += PSK_CHAR_GAP_COUNT;       // Add consecutive 0 bits for intercharacter gap (i.e. send predefined consecutive phase shifts for Synchronization)
-        bitpos = 0;                              // Start sending first bit. This counter is used by Tx Timer
-        flags &= ~TRANSMIT_CHAR_DONE;            // Signal Tx Timer to start sending bits
-
-       // Nothing to be transmitted so send idle code (i.e. at least 2 consecutive phase shifts)
-       } else {
-        pskVcode = 0;
-        pskVcodeLen = 2;
-        bitpos = 0;
-        flags &= ~TRANSMIT_CHAR_DONE;
-       }
     }
+    EncodeTxQueue ();
 
   // Not Transmitting so must be receiving so run decode engine.
   } else {
@@ -366,7 +311,8 @@ void ProcessControlCharacter ( char code )
 {
    
     switch (code) {
-      case CTL_A:                       // TBD - Undefined
+      case CTL_A:                       // Step to next RTTY baud rate/shift and save in EEPROM
+        ConfigureRTTY ();
         break;
       
       case CTL_B:                       // Enable Hex Display of Control Characters
@@ -580,6 +526,18 @@ void ProcessControlCharacter ( char code )
         }
         break;
 
+      case CTL_BSLASH:                  // Decode RTTY and PSK at the same time
+        StartDualDecode ();
+        break;
+
+      case CTL_RBRACKET:                // Store or recall a memory channel
+        MemoryChannels ();
+        break;
+
+      case CTL_CARET:                   // Scan band for activity
+        BandScan ();
+        break;
+
       case CTL_Z:                       // Reset System
         StopSampling();
         StopTransmitter();
@@ -609,6 +567,106 @@ void DisplayInfo (unsigned char serialport)
     Serial1.println (rttyMarkBin);        // Correlation delay value for mark detection
     Serial1.print ("Thresh: ");
     Serial1.println (magThresh);          // Decode threshold. Mark/Space bin must be at least this value
+    Serial1.print ("Bits: ");             // Bits decoded by bit synchronizer (DPLL)
+    Serial1.print (rttyBits);
+    Serial1.print (" Frame Err: ");       // Framing errors (start/stop bit wrong)
+    Serial1.print (rttyFrameErrors);
+    Serial1.print (" DPLL Err: ");        // Last DPLL phase error at bit edge (65536 = 1 bit)
+    Serial1.print (rttyDpllErr);
+    Serial1.print (" Overruns: ");        // Blocks dropped (processing too slow)
+    Serial1.println (rttyOverruns);
+    Serial1.print ("Key Time: ");         // Time to key Mark/Space (Tx)
+    Serial1.print (rttyKeyTime);
+    Serial1.println (" us");
+    Serial1.print ("Tx ISR Max: ");       // Longest Tx timer interupt. ADC/serial interupts blocked this long
+    Serial1.print (txISRMaxTime);
+    Serial1.print (" us Work: ");         // Deferred keying. Count, longest latency, deadline misses and dropped
+    Serial1.print (workCount);
+    Serial1.print (" Latency: ");
+    Serial1.print (workMaxLatency);
+    Serial1.print (" us Miss: ");
+    Serial1.print (workDeadlineMiss);
+    Serial1.print (" Drop: ");
+    Serial1.println (workOverflow);
+    Serial1.print ("I2C: ");                // Si5351 writes sent by TWI interupt, data bytes, errors and last TWI error status
+    Serial1.print (i2cTransactions);
+    Serial1.print (" Bytes: ");
+    Serial1.print (i2cBytes);
+    Serial1.print (" Err: ");
+    Serial1.print (i2cErrors);
+    Serial1.print (" Last: 0x");
+    Serial1.println (i2cLastError, HEX);
+    Serial1.print ("Si5351 Set Freq: ");            // Bytes written by last SetFrequency() (full program without diffing), PLL resets, total bytes
+    Serial1.print (siSetFreqBytes);
+    Serial1.print ("/");
+    Serial1.print (SI_FULL_PROGRAM_BYTES);
+    Serial1.print (" bytes PLL Resets: ");
+    Serial1.print (siPLLResets);
+    Serial1.print (" Total: ");
+    Serial1.print (siBytesWritten);
+    Serial1.print (" Retune Fast: ");      // Divider calculations done incrementally and in full (see CalculateDividers())
+    Serial1.print (siFastRetunes);
+    Serial1.print (" Full: ");
+    Serial1.print (siFullRetunes);
+    Serial1.print (" SetFreq: ");                // Time to calculate and queue registers vs memory channel recall
+    Serial1.print (siSetFreqTime);
+    Serial1.print (" us Recall: ");
+    Serial1.print (memRecallTime);
+    Serial1.println (" us");
+    Serial1.print ("Fine Tune: ");            // Decoder tone offset from the programmed Si5351 frequency (see FineTune())
+    Serial1.print (tuneOffset);
+    Serial1.print (" Hz LO: ");
+    Serial1.print (clk0ctl.freq);
+    Serial1.print (" Steps: ");             // Encoder steps followed without retuning the Si5351
+    Serial1.println (tuneSteps);
+    Serial1.print ("Encoder Steps: ");               // Detents, batches applied (peak per second), steps dropped (count full) and quadrature states missed
+    Serial1.print (encoderSteps);
+    Serial1.print (" Updates: ");
+    Serial1.print (encoderUpdates);
+    Serial1.print (" Peak: ");
+    Serial1.print (encoderRate);
+    Serial1.print ("/s Dropped: ");
+    Serial1.print (encoderDropped);
+    Serial1.print (" Missed: ");
+    Serial1.println (encoderMissed);
+    Serial1.print ("Control Polls: ");            // Timer 1 polls, polls with controls active and time in ISR (% of CPU)
+    Serial1.print (ctlPolls);
+    Serial1.print (" Active: ");
+    Serial1.print (ctlActivePolls);
+    Serial1.print (" ISR Load: ");
+    if (ctlPolls) Serial1.print ((float)ctlIsrTicks * 100.0 / ((float)ctlPolls * (TIMER3MS + 1)), 3);
+    Serial1.println ("%");
+    Serial1.print ("Button Events: ");              // Debounced button events queued, dropped (queue full) and buttons held
+    Serial1.print (btnEvents);
+    Serial1.print (" Dropped: ");
+    Serial1.print (btnOverflow);
+    Serial1.print (" Held: 0x");
+    Serial1.println (buttons.state, HEX);
+    Serial1.print ("Spectrum Coverage: ");          // Samples in at least one FFT window, FFTs and rows displayed since setupFFT()
+    if (fhtHalfBlocks) Serial1.print ((float)fhtCovered * 100.0 / (float)fhtHalfBlocks, 1);
+    Serial1.print ("% FFTs: ");
+    Serial1.print (fhtFFTs);
+    Serial1.print (" Rows: ");
+    Serial1.print (fhtRows);
+    Serial1.print (" Rows/s: ");
+    if (fhtRowTime != fhtStartTime) Serial1.println ((float)fhtRows * 1000.0 / (float)(fhtRowTime - fhtStartTime), 1);
+    else Serial1.println (0);
+    Serial1.print ("Waterfall Row: ");         // Time to draw a waterfall row (last/longest) and the bar graph spectrum it replaced (see LCDMeasureWaterfall())
+    Serial1.print (wfRowTime);
+    Serial1.print (" Max: ");
+    Serial1.print (wfRowMaxTime);
+    Serial1.print (" Bar Graph: ");
+    Serial1.print (wfBarTime);
+    Serial1.println (" us");
+    Serial1.print ("Pin I/O digitalWrite: ");               // CPU cycles per pin write measured at startup (see MeasurePinIO())
+    Serial1.print (pinSlowCycles);
+    Serial1.print (" PinHigh/Low: ");
+    Serial1.print (pinFastCycles);
+    Serial1.println (" cycles");
+    DisplayBaudClock (1, &rttyClock);     // Tx bit time (expected and measured)
+    Serial1.print ("Squelch Closed: ");   // RTTY carrier detect gate
+    DisplaySquelchInfo (1, &rttySquelch);
+    DisplayRTTYConfig (1);                // Baud rate, shift and CPU budget
 
     Serial1.print ("\r\nPSK: ");
     Serial1.print (frequency_clk0);       // Currently tuned frequency
@@ -616,6 +674,26 @@ void DisplayInfo (unsigned char serialport)
     Serial1.print (pskbinthresh);         // When signals in phase this is the delay, used to detect phase shift
     Serial1.print (" Thresh: ");
     Serial1.println (magThresh);          // Delay 0 threshold.  If below this then its a phase shift
+    Serial1.print ("SNR: ");
+    Serial1.print (pskSNR);               // SNR (dB) of last character received
+    Serial1.print (" IMD: ");
+    Serial1.print (pskIMD);               // IMD (dB) measured on idle (continuous phase reversals)
+    Serial1.print (" Phase Err: ");
+    Serial1.print (pskPhaseErr);          // Average phase error (degrees) of last character received
+    Serial1.print (" Lock: ");
+    Serial1.println (pskLocked);
+    DisplayBaudClock (1, &pskClock);      // Rx/Tx bit time (expected and measured)
+
+    Serial1.print ("Squelch Closed: ");   // Carrier detect gate. Blocks skipped (%), processing time per block and characters
+    DisplaySquelchInfo (1, &pskSquelch);
+    Serial1.print ("Decode Load: ");      // CPU load (%) decoding RTTY and/or PSK, maximum and windows over budget
+    Serial1.print (decodeLoad);
+    Serial1.print ("% Max: ");
+    Serial1.print (decodeLoadMax);
+    Serial1.print ("% Over Budget: ");
+    Serial1.print (decodeBudgetExceeded);
+    Serial1.print (" PSK Overruns: ");    // PSK blocks dropped (processing too slow)
+    Serial1.println (pskOverruns);
     
   } else {
     Serial2.print ("RTTY: ");             // See comments above
@@ -630,6 +708,106 @@ void DisplayInfo (unsigned char serialport)
     Serial2.println (rttyMarkBin);
     Serial2.print ("Thresh: ");
     Serial2.println (magThresh);
+    Serial2.print ("Bits: ");
+    Serial2.print (rttyBits);
+    Serial2.print (" Frame Err: ");
+    Serial2.print (rttyFrameErrors);
+    Serial2.print (" DPLL Err: ");
+    Serial2.print (rttyDpllErr);
+    Serial2.print (" Overruns: ");
+    Serial2.println (rttyOverruns);
+    Serial2.print ("Key Time: ");
+    Serial2.print (rttyKeyTime);
+    Serial2.println (" us");
+    Serial2.print ("Tx ISR Max: ");
+    Serial2.print (txISRMaxTime);
+    Serial2.print (" us Work: ");
+    Serial2.print (workCount);
+    Serial2.print (" Latency: ");
+    Serial2.print (workMaxLatency);
+    Serial2.print (" us Miss: ");
+    Serial2.print (workDeadlineMiss);
+    Serial2.print (" Drop: ");
+    Serial2.println (workOverflow);
+    Serial2.print ("I2C: ");
+    Serial2.print (i2cTransactions);
+    Serial2.print (" Bytes: ");
+    Serial2.print (i2cBytes);
+    Serial2.print (" Err: ");
+    Serial2.print (i2cErrors);
+    Serial2.print (" Last: 0x");
+    Serial2.println (i2cLastError, HEX);
+    Serial2.print ("Si5351 Set Freq: ");
+    Serial2.print (siSetFreqBytes);
+    Serial2.print ("/");
+    Serial2.print (SI_FULL_PROGRAM_BYTES);
+    Serial2.print (" bytes PLL Resets: ");
+    Serial2.print (siPLLResets);
+    Serial2.print (" Total: ");
+    Serial2.print (siBytesWritten);
+    Serial2.print (" Retune Fast: ");
+    Serial2.print (siFastRetunes);
+    Serial2.print (" Full: ");
+    Serial2.print (siFullRetunes);
+    Serial2.print (" SetFreq: ");
+    Serial2.print (siSetFreqTime);
+    Serial2.print (" us Recall: ");
+    Serial2.print (memRecallTime);
+    Serial2.println (" us");
+    Serial2.print ("Fine Tune: ");
+    Serial2.print (tuneOffset);
+    Serial2.print (" Hz LO: ");
+    Serial2.print (clk0ctl.freq);
+    Serial2.print (" Steps: ");
+    Serial2.println (tuneSteps);
+    Serial2.print ("Encoder Steps: ");
+    Serial2.print (encoderSteps);
+    Serial2.print (" Updates: ");
+    Serial2.print (encoderUpdates);
+    Serial2.print (" Peak: ");
+    Serial2.print (encoderRate);
+    Serial2.print ("/s Dropped: ");
+    Serial2.print (encoderDropped);
+    Serial2.print (" Missed: ");
+    Serial2.println (encoderMissed);
+    Serial2.print ("Control Polls: ");
+    Serial2.print (ctlPolls);
+    Serial2.print (" Active: ");
+    Serial2.print (ctlActivePolls);
+    Serial2.print (" ISR Load: ");
+    if (ctlPolls) Serial2.print ((float)ctlIsrTicks * 100.0 / ((float)ctlPolls * (TIMER3MS + 1)), 3);
+    Serial2.println ("%");
+    Serial2.print ("Button Events: ");
+    Serial2.print (btnEvents);
+    Serial2.print (" Dropped: ");
+    Serial2.print (btnOverflow);
+    Serial2.print (" Held: 0x");
+    Serial2.println (buttons.state, HEX);
+    Serial2.print ("Spectrum Coverage: ");
+    if (fhtHalfBlocks) Serial2.print ((float)fhtCovered * 100.0 / (float)fhtHalfBlocks, 1);
+    Serial2.print ("% FFTs: ");
+    Serial2.print (fhtFFTs);
+    Serial2.print (" Rows: ");
+    Serial2.print (fhtRows);
+    Serial2.print (" Rows/s: ");
+    if (fhtRowTime != fhtStartTime) Serial2.println ((float)fhtRows * 1000.0 / (float)(fhtRowTime - fhtStartTime), 1);
+    else Serial2.println (0);
+    Serial2.print ("Waterfall Row: ");
+    Serial2.print (wfRowTime);
+    Serial2.print (" Max: ");
+    Serial2.print (wfRowMaxTime);
+    Serial2.print (" Bar Graph: ");
+    Serial2.print (wfBarTime);
+    Serial2.println (" us");
+    Serial2.print ("Pin I/O digitalWrite: ");
+    Serial2.print (pinSlowCycles);
+    Serial2.print (" PinHigh/Low: ");
+    Serial2.print (pinFastCycles);
+    Serial2.println (" cycles");
+    DisplayBaudClock (0, &rttyClock);
+    Serial2.print ("Squelch Closed: ");
+    DisplaySquelchInfo (0, &rttySquelch);
+    DisplayRTTYConfig (0);
     
     Serial2.print ("\r\nPSK: ");
     Serial2.print (frequency_clk0);
@@ -637,10 +815,117 @@ void DisplayInfo (unsigned char serialport)
     Serial2.print (pskbinthresh);
     Serial2.print (" Thresh: ");
     Serial2.println (magThresh);
+    Serial2.print ("SNR: ");
+    Serial2.print (pskSNR);
+    Serial2.print (" IMD: ");
+    Serial2.print (pskIMD);
+    Serial2.print (" Phase Err: ");
+    Serial2.print (pskPhaseErr);
+    Serial2.print (" Lock: ");
+    Serial2.println (pskLocked);
+    DisplayBaudClock (0, &pskClock);
+
+    Serial2.print ("Squelch Closed: ");
+    DisplaySquelchInfo (0, &pskSquelch);
+    Serial2.print ("Decode Load: ");
+    Serial2.print (decodeLoad);
+    Serial2.print ("% Max: ");
+    Serial2.print (decodeLoadMax);
+    Serial2.print ("% Over Budget: ");
+    Serial2.print (decodeBudgetExceeded);
+    Serial2.print (" PSK Overruns: ");
+    Serial2.println (pskOverruns);
   
   }  
 }
 
+void DisplaySquelchInfo (unsigned char serialport, Squelch_def *sq)
+{
+// This routine displays the carrier detect (squelch) statistics. i.e. % of blocks skipped, average
+// processing time (us) per block when open and closed, characters displayed and characters blocked (false lock),
+// number of times the gate opened and false opens (opened on noise)
+
+  unsigned long pct, topen, tclosed;
+
+  pct = topen = tclosed = 0;
+  if (sq->total) pct = (sq->closed * 100) / sq->total;
+  if (sq->total > sq->closed) topen = sq->openTime / (sq->total - sq->closed);
+  if (sq->closed) tclosed = sq->closedTime / sq->closed;
+
+  if (serialport) {
+    Serial1.print (pct);
+    Serial1.print ("% Open: ");
+    Serial1.print (topen);
+    Serial1.print (" us Closed: ");
+    Serial1.print (tclosed);
+    Serial1.print (" us Chars: ");
+    Serial1.print (sq->chars);
+    Serial1.print (" Blocked: ");
+    Serial1.print (sq->blocked);
+    Serial1.print (" Opens: ");
+    Serial1.print (sq->opens);
+    Serial1.print (" False: ");
+    Serial1.println (sq->falseOpens);
+  } else {
+    Serial2.print (pct);
+    Serial2.print ("% Open: ");
+    Serial2.print (topen);
+    Serial2.print (" us Closed: ");
+    Serial2.print (tclosed);
+    Serial2.print (" us Chars: ");
+    Serial2.print (sq->chars);
+    Serial2.print (" Blocked: ");
+    Serial2.print (sq->blocked);
+    Serial2.print (" Opens: ");
+    Serial2.print (sq->opens);
+    Serial2.print (" False: ");
+    Serial2.println (sq->falseOpens);
+  }
+}
+
+void DisplayBaudClock (unsigned char serialport, BaudClock_def *bc)
+{
+// This routine displays the bit time (us x10) of a baud clock and the average bit time measured since the clock
+// was enabled. Over a long message these should be the same (i.e. no drift)
+
+  unsigned long expected, measured, elapsed, symbols;
+
+  cli();                          // Symbol count updated by timer ISR
+  symbols = bc->symbols;
+  elapsed = micros() - bc->start;
+  sei();
+
+  expected = 1000000000UL / bc->baud;
+  measured = 0;
+  if (symbols) {
+    measured = (elapsed / symbols) * 10 + ((elapsed % symbols) * 10) / symbols;
+  }
+
+  if (serialport) {
+    Serial1.print ("Bit Time: ");
+    Serial1.print (expected / 10);
+    Serial1.print (".");
+    Serial1.print (expected % 10);
+    Serial1.print (" us Meas: ");
+    Serial1.print (measured / 10);
+    Serial1.print (".");
+    Serial1.print (measured % 10);
+    Serial1.print (" us Bits: ");
+    Serial1.println (symbols);
+  } else {
+    Serial2.print ("Bit Time: ");
+    Serial2.print (expected / 10);
+    Serial2.print (".");
+    Serial2.print (expected % 10);
+    Serial2.print (" us Meas: ");
+    Serial2.print (measured / 10);
+    Serial2.print (".");
+    Serial2.print (measured % 10);
+    Serial2.print (" us Bits: ");
+    Serial2.println (symbols);
+  }
+}
+
 void ExecuteNarrowWaterfall (void)
 {
 // This routine enable narrow spectrum display
@@ -716,8 +1001,13 @@ void ToggleRTTY (void)
     } else if (flags & DECODERTTY) {            // Current in Rx mode and switch to Tx mode
       ResetRTTY();
       ResetPSK();
-      SetFrequency (rttyTransmitMarkFreq);      // Enable to carrier to be mark frequency for idle condition
-                                                // Subsequent code will manipulate carrier
+      // Enable to carrier to be mark frequency for idle condition. Mark/Space registers are only calculated here 
+      // (not on every tuning step) and only if the frequency or shift changed since they were last calculated
+      // Subsequent code will manipulate carrier
+      UpdateRTTYTxFrequencies ();
+      if (!LoadSi5351Registers (rttyTransmitMarkFreq, 0, rttyMarkRegs)) SetFrequency (rttyTransmitMarkFreq);
+      ResetTxQueue ();                          // Empty Tx symbol queue. Timer sends idle until queue is filled
+      ResetWorkQueue ();                        // Empty deferred keying queue and reset latency statistics
       flags |= TRANSMITRTTY;                    // This is all that's needed to enable Tx
       flags |= TRANSMIT_CHAR_DONE;
       idle = 0;
@@ -732,11 +1022,125 @@ void ToggleRTTY (void)
 
 //      digitalWrite(RxMute, LOW);          // Mute receiver.  Not needed
       EnableTimers (1, TIMER3MS);         // Timer 1 is for Rotary
-      EnableTimers (4, TIMER22MS);        // Timer 4 is for 22ms for RTTY
+      EnableBaudClock (4, &rttyClock);    // Timer 4 is for RTTY bit time (22ms for 45.45 baud)
     }
   
 }
 
+void StartDualDecode (void)
+{
+// This routine starts RTTY and PSK Rx at the same time (dual decode) on the current frequency
+// Whichever decoder is locked displays its characters. Use ^R or ^P to switch to Tx or a single mode
+
+// Stop all timers otherwise bad things may happen 
+    StopSampling();
+    DisableTimers (4);              // Timer 4 is for 22ms for RTTY
+    DisableTimers (3);              // Timer 3 is for 32ms for PSK
+    DisableTimers (1);              // Timer 1 is for 5ms for Rotary
+    FlushSerialPorts();
+
+    if (flags & TRANSMITPSK || flags & TRANSMITRTTY) {    // Start decode on a seperate line
+      LCDDisplayCharacter(0xD);
+      LCDDisplayCharacter(0xA);
+    }
+    StopTransmitter();                  // Disable Tx and reset
+    ResetRTTY();
+    ResetPSK();
+    LCDDisplayMode ((char *)"Dual Rx");       // Update mode on LCD
+    LCDDisplayCharacter ('R');
+    LCDDisplayCharacter ('x');
+    LCDDisplayCharacter(0xD);
+    LCDDisplayCharacter(0xA);
+    LCDDisplayFrequency ();
+    LCDDisplayMenu(RXMENU);                   // Display Rx menu
+    SetFrequency (frequency_clk0);
+    DualControl (0);                          // Turn on sampling, RTTY and PSK Rx
+}
+
+void ConfigureRTTY (void)
+{
+// This routine steps to the next RTTY baud rate/shift (see NextRTTYConfig()) and saves it in EEPROM
+// If RTTY Rx or Tx is running then it is restarted with the new baud rate/shift
+
+  // Don't change baud rate in the middle of a character
+  if (flags & TRANSMITRTTY) {
+    LCDSignalError(CANNOT_COMPLETE_DECODE_ENABLED);
+    return;
+  }
+
+  NextRTTYConfig ();
+  EEPROMWriteRTTYConfig ();
+  
+  if ((flags & DECODERTTY) && (flags & DECODEPSK)) {
+    StopSampling();
+    DualControl (0);                    // Restart dual decode with new RTTY frequencies and bit timing
+  } else if (flags & DECODERTTY) {
+    StopSampling();
+    ResetRTTY();
+    RTTYControl (0);                    // Restart RTTY Rx with new frequencies and bit timing
+  }
+
+  ToggleSampling (0);
+  DisplayRTTYConfig (0);
+  DisplayRTTYConfig (1);
+  ToggleSampling (1);
+}
+
+void DisplayRTTYConfig (unsigned char serialport)
+{
+// This routine displays the RTTY baud rate, shift and the CPU budget for the configuration
+// Samples are processed in blocks of CORRBUFFSZ. Bit synchronizer needs several blocks per bit and 
+// block processing time (measured when carrier detect open) must be less than the block time (i.e. CPU % below 100)
+
+  unsigned long blocktime, proctime, cpu, bpb;
+
+  blocktime = (CORRBUFFSZ * 1000000UL) / F_SAMPLE;                       // Time (us) to sample a block
+  bpb = ((unsigned long)F_SAMPLE * 1000UL) / ((unsigned long)rttyBaud * CORRBUFFSZ);  // Blocks per bit x10
+  proctime = 0;
+  if (rttySquelch.total > rttySquelch.closed) proctime = rttySquelch.openTime / (rttySquelch.total - rttySquelch.closed);
+  cpu = (proctime * 100) / blocktime;
+
+  if (serialport) {
+    Serial1.print ("RTTY Baud: ");
+    Serial1.print (rttyBaud / 100);
+    Serial1.print (".");
+    Serial1.print (rttyBaud % 100);
+    Serial1.print (" Shift: ");
+    Serial1.print (rttyShift);
+    Serial1.print (" Blocks/Bit: ");
+    Serial1.print (bpb / 10);
+    Serial1.print (".");
+    Serial1.print (bpb % 10);
+    Serial1.print (" CPU: ");
+    Serial1.print (proctime);
+    Serial1.print ("/");
+    Serial1.print (blocktime);
+    Serial1.print (" us ");
+    Serial1.print (cpu);
+    Serial1.println ("%");
+    if (bpb < RTTY_MIN_BLOCKS_PER_BIT * 10) Serial1.println ("Too few blocks per bit");
+  } else {
+    Serial2.print ("RTTY Baud: ");
+    Serial2.print (rttyBaud / 100);
+    Serial2.print (".");
+    Serial2.print (rttyBaud % 100);
+    Serial2.print (" Shift: ");
+    Serial2.print (rttyShift);
+    Serial2.print (" Blocks/Bit: ");
+    Serial2.print (bpb / 10);
+    Serial2.print (".");
+    Serial2.print (bpb % 10);
+    Serial2.print (" CPU: ");
+    Serial2.print (proctime);
+    Serial2.print ("/");
+    Serial2.print (blocktime);
+    Serial2.print (" us ");
+    Serial2.print (cpu);
+    Serial2.println ("%");
+    if (bpb < RTTY_MIN_BLOCKS_PER_BIT * 10) Serial2.println ("Too few blocks per bit");
+  }
+}
+
 void TogglePSK (void)        
 {
 // This routine switches between Rx and Tx for PSK
@@ -768,8 +1172,13 @@ void TogglePSK (void)
     } else if (flags & DECODEPSK)  {
       ResetRTTY();
       ResetPSK();              
-      SetFrequency (frequency_clk0_tx);   // Turn on carrier with offset for Tx so that its received at 1Khz
-                                          // Subsequent code will manipulate carrier
+      // Turn on carrier with offset for Tx so that its received at 1Khz. Use registers from memory channel if tuned to it
+      // Subsequent code will manipulate carrier
+      if (pskTxRegsFreq != frequency_clk0_tx || !LoadSi5351Registers (frequency_clk0_tx, 0, pskTxRegs)) {
+        SetFrequency (frequency_clk0_tx);
+      }
+      ResetTxQueue ();                    // Empty Tx symbol queue. Timer sends idle until queue is filled
+      ResetWorkQueue ();                  // Empty deferred keying queue and reset latency statistics
       flags |= TRANSMIT_CHAR_DONE;
       flags |= TRANSMITPSK;               // This is all that's needed to enable Tx
       idle = 0;
@@ -785,7 +1194,7 @@ void TogglePSK (void)
  //      digitalWrite(RxMute, LOW);          // Mute receiver. Not needed
        
       EnableTimers (1, TIMER3MS);         // Timer 1 is for Rotary 
-      EnableTimers (3, TIMER32MS);        // Timer 3 is for 32ms for PSK
+      EnableBaudClock (3, &pskClock);     // Timer 3 is for 32ms for PSK
     }
 }
 
@@ -824,7 +1233,9 @@ void StopTransmitter (void)
   flags &= ~TRANSMITRTTY;
   flags &= ~TRANSMITPSK;
   flags &= ~TRANSMIT_CHAR_DONE;
-  digitalWrite(TxEnable, LOW);      // Disable Tranmitter
+  ResetTxQueue ();                  // Discard any pre-encoded symbols not yet transmitted
+  workQueueTail = workQueueHead;    // Discard any keying not yet done
+  PinLow(TxEnable);                 // Disable Tranmitter
 //  digitalWrite(RxMute, HIGH);       // Unute receiver. Not used
   DisableSi5351Clocks();            // This is rather harsh but it may save finals if TxEnable is not low.
                                     //Need to do a SetFrequency() after this is called
@@ -931,13 +1342,166 @@ void CalibrateSi5351 (void)
   SetFrequency (freq);
 }
 
+void MemoryChannels (void)
+{
+// This routine stores or recalls a memory channel (see Memory.cpp). The channels are listed then enter the 
+// channel number to recall it or S and the channel number to store the current frequency and mode
+// Only works on serial1.  Does not use serial2 (bluetooth)
+
+  DisplayMemoryChannels (1);
+  Serial1.println ("Enter channel to recall or S and channel to store (e.g. S 3): ");
+
+  FlushSerialPorts ();  // Ensure all serial arduino maintained tx and rx buffers are clean
+  ResetSerial();        // Ensure that we are starting with clean buffer and counters
+
+  if (ProcessSerial()) {
+    Serial1.println ("Exiting");
+    return;
+  }
+
+  // ParseSerial() stores a minus sign as a command so "-3" would otherwise be channel 3
+  if (numbers[0] >= MEMORY_CHANNELS || memchr (commands, '-', sizeof(commands))) {
+    Serial1.println ("Bad Channel");
+    return;
+  }
+
+  if (commands[0] == 'S') {
+    if (StoreMemory ((unsigned char)numbers[0])) {
+      Serial1.print ("Stored ");
+      Serial1.println (numbers[0]);
+    } else {
+      Serial1.println ("Store Failed");
+    }
+  } else if (RecallMemory ((unsigned char)numbers[0])) {
+    Serial1.print ("Recall: ");             // Time to program Si5351 from channel compared to SetFrequency()
+    Serial1.print (memRecallTime);
+    Serial1.print (" us SetFrequency: ");
+    Serial1.print (siSetFreqTime);
+    Serial1.println (" us");
+  } else {
+    Serial1.println ("Empty Channel");
+  }
+}
+
+void DisplayMemoryChannels (unsigned char serialport)
+{
+// This routine lists the memory channels that have been stored (channel, frequency, mode and RTTY baud/shift)
+
+  Memory_def mem;
+  unsigned char i;
+
+  for (i = 0; i < MEMORY_CHANNELS; i++) {
+    if (!ReadMemory (i, &mem)) continue;
+    if (serialport) {
+      Serial1.print (i);
+      Serial1.print (": ");
+      Serial1.print (mem.freq);
+      Serial1.print (" ");
+      Serial1.print ((char)mem.mode);
+      Serial1.print (" RTTY Cfg: 0x");        // Baud rate (low nibble) and shift (high nibble) index
+      Serial1.println (mem.rttyConfig, HEX);
+    } else {
+      Serial2.print (i);
+      Serial2.print (": ");
+      Serial2.print (mem.freq);
+      Serial2.print (" ");
+      Serial2.print ((char)mem.mode);
+      Serial2.print (" RTTY Cfg: 0x");
+      Serial2.println (mem.rttyConfig, HEX);
+    }
+  }
+}
+
+void BandScan (void)
+{
+// This routine scans a range of frequencies for activity (see Scan.cpp) then lists the most active frequencies.
+// Enter the number of a frequency to tune PSK Rx to it. Otherwise PSK Rx is restarted on the original frequency
+// Only works on serial1.  Does not use serial2 (bluetooth)
+
+  unsigned long start, stop, freq;
+  unsigned int step;
+  unsigned char i;
+
+  Serial1.println ("Enter start and stop frequency and optional step (e.g. 7030000 7100000 2000): ");
+
+  FlushSerialPorts ();  // Ensure all serial arduino maintained tx and rx buffers are clean
+  ResetSerial();        // Ensure that we are starting with clean buffer and counters
+
+  if (ProcessSerial()) {
+    Serial1.println ("Exiting");
+    return;
+  }
+
+  // Validate inputs
+  start = numbers[0];
+  stop = numbers[1];
+  step = numbers[2];
+  if (!step) step = SCAN_DEFAULT_STEP;
+  if (start < LOW_FREQUENCY_LIMIT || stop > HIGH_FREQUENCY_LIMIT || stop <= start) {
+    Serial1.println ("Freq out of band");
+    return;
+  }
+  if (step > SCAN_MAX_STEP || (stop - start) / step >= SCAN_MAX_STEPS) {
+    Serial1.println ("Bad Step");
+    return;
+  }
+
+// Stop all timers, Tx and decoding 
+  StopSampling();
+  DisableTimers (4);              // Timer 4 is for 22ms for RTTY
+  DisableTimers (3);              // Timer 3 is for 32ms for PSK
+  DisableTimers (1);              // Timer 1 is for 5ms for Rotary
+  StopTransmitter();
+  ResetRTTY();
+  ResetPSK();
+  flags &= ~NARROW_WATERFALL;
+  TermFlags &= ~DISP_WATERFALL;
+  TermFlags &= ~DISP_NARROW_WATERFALL;
+  LCDDisplayMode ((char *)"Scan");
+
+  Serial1.println ("Scanning - Any key to stop");
+  freq = frequency_clk0;
+  ScanBand (start, stop, step);
+
+  Serial1.print (scanSteps);
+  Serial1.print (" steps ");
+  Serial1.print (scanStepsPerSec / 10);
+  Serial1.print (".");
+  Serial1.print (scanStepsPerSec % 10);
+  Serial1.println (" steps/s");
+  if (!scanListCount) Serial1.println ("No Activity");
+  for (i = 0; i < scanListCount; i++) {
+    Serial1.print (i);
+    Serial1.print (": ");
+    Serial1.print (ScanTuneFrequency (i));
+    Serial1.print (" Level: ");             // Peak above passband average (16 = 6 dB)
+    Serial1.println (scanTable[scanList[i]].level);
+  }
+
+  // Select frequency to tune to
+  if (scanListCount) {
+    Serial1.println ("Enter number to tune: ");
+    FlushSerialPorts ();
+    ResetSerial();
+    if (!ProcessSerial() && numbers[0] < scanListCount) freq = ScanTuneFrequency (numbers[0]);
+  }
+
+  frequency_clk0 = freq;
+  LCDDisplayMode ((char *)"PSK Rx");      // Update LCD mode
+  LCDDisplayCharacter(0xD);
+  LCDDisplayCharacter(0xA);
+  SetFrequency (frequency_clk0);      
+  LCDDisplayFrequency ();
+  PSKControl (0);
+}
+
 unsigned char ProcessSerial ( void ) 
 // This routing is called to check is there is serial input and store the input into the serial buffer
 // if a CR/LF (Enter pressed) is received, then process the command and flush the buffer.
 // If CTL_Z is received then abort and return abort
 
 {
-    char temp;
+    char temp = 0;
 
     // Serial.available() returns the number of character that have been entered at the keyboard.
     // The idea here is that you keep processing characters until none are left.
@@ -7,7 +7,7 @@
 #define MAX_COMMAND_ENTRIES 6 
 
 // Control codes for terminal commands
-#define CTL_A 0x1     
+#define CTL_A 0x1     // RTTY Baud/Shift
 #define CTL_B 0x2     // Hex
 #define CTL_C 0x3     // Clear Screen
 #define CTL_D 0x4     // Capture Call sign
@@ -31,6 +31,9 @@
 #define CTL_X 0x18    // Dump ADC values to console
 #define CTL_Y 0x19    
 #define CTL_Z 0x1A    // Reset System
+#define CTL_BSLASH 0x1C   // Dual RTTY/PSK Rx
+#define CTL_RBRACKET 0x1D // Memory Channels
+#define CTL_CARET 0x1E    // Band Scan
 
 // Terminal specific flags
 #define MUTERX 0x1
@@ -53,9 +56,14 @@ void ProcessControlCharacter ( char code );
 char SerialTerminalPop (void);
 void DisplayHelp (unsigned char serialport);
 void DisplayInfo (unsigned char serialport);
+void DisplaySquelchInfo (unsigned char serialport, Squelch_def *sq);
+void DisplayBaudClock (unsigned char serialport, BaudClock_def *bc);
 
 void TogglePSK (void);
 void ToggleRTTY (void);
+void StartDualDecode (void);
+void ConfigureRTTY (void);
+void DisplayRTTYConfig (unsigned char serialport);
 void ExecuteWaterfall (void);
 void ExecuteNarrowWaterfall (void);
 
@@ -63,6 +71,9 @@ void StopTransmitter (void);
 
 unsigned char ProcessSerial (void);
 void CalibrateSi5351 (void);
+void MemoryChannels (void);
+void DisplayMemoryChannels (unsigned char serialport);
+void BandScan (void);
 
 #endif // _UART_H_
 
@@ -16,6 +16,20 @@ unsigned long temp;
 unsigned char base;
 unsigned char clkreg;
 
+// Shadow copy of Si5351 registers 0-65 last written. Used by Si5351UpdateRegisters() to only write the registers that change
+// Only the registers written by ResetSi5351() (3, 16-18, 26-65) are valid
+unsigned char siShadow[SI_SHADOW_REGS];
+unsigned char siShadowValid;                // Set by ResetSi5351() once the shadow matches the Si5351
+unsigned long siBytesWritten;               // Register bytes written to the Si5351
+unsigned int siSetFreqBytes;                // Register bytes written by last SetFrequency() (SI_FULL_PROGRAM_BYTES before diffing)
+unsigned int siPLLResets;                   // PLL resets. Only done when PLL registers change
+unsigned char siPLLProgrammed;              // PLL has been written since ResetSi5351()
+unsigned long siSetFreqTime;                // Time (us) last SetFrequency() took to calculate and queue registers
+
+// Cached divider solution used by CalculateDividers() for fast retuning (see RetuneStep())
+Si5351_Tune_def siTune;
+unsigned int siFastRetunes, siFullRetunes;  // Output divider calculations done incrementally and in full
+
 /*
 The way the Si5351 works (in a nutshell) is the a PLL frequency is generated based on the Crystal Frequency (XTAL).  A multisyncth multiplier (called Feedback Multisynth Divider
 but I refer to is at the PLL multisynth multiplier) is used to generate the PLL frequency. The PLL frequency MUST be between 600 Mhz and 900 Mhz!!. So for 25 Mhz clock the multipler must 
@@ -123,6 +137,10 @@ void ResetSi5351 (unsigned int loadcap)
   memset ((char *)&clk1ctl, 0, sizeof(clk1ctl));
   memset ((char *)&clk2ctl, 0, sizeof(clk2ctl));
   memset ((char *)&multisynth, 0, sizeof(multisynth));
+  memset ((char *)siShadow, 0, sizeof(siShadow));
+  siShadowValid = 0;
+  siPLLProgrammed = 0;
+  memset ((char *)&siTune, 0, sizeof(siTune));            // multisynth zeroed so PLL solution must be recalculated
 
   i2cInit();
 
@@ -148,6 +166,8 @@ void ResetSi5351 (unsigned int loadcap)
 
   // Define XTAL frequency. For Aadfruit it 25 Mhz.
   multisynth.Fxtal =  SI_CRY_FREQ_25MHZ;
+
+  siShadowValid = 1;                                      // Registers written above are now known
 }
 
 
@@ -167,23 +187,29 @@ void SetFrequency (unsigned long freq)
 // See note above about phase configuration and programming note AN619
 // Note that SI_XTAL can be use instead of PLL "A" or "B".  This simply passes crystal frequency to the output (i.e. output is 25 Mhz and multiplier and dividers are not used).
 {
+  unsigned long start;
+
   // Validate frequency limits
   if (!freq || freq > SI_MAX_OUT_FREQ || freq < SI_MIN_OUT_FREQ) {
     Serial1.println ("Bad Freq");
     return;
   }
   
-
+  start = siBytesWritten;
+  siSetFreqTime = micros();
 
   CalculateDividers (freq);
   ProgramSi5351();
 
+  siSetFreqTime = micros() - siSetFreqTime;
+  siSetFreqBytes = siBytesWritten - start;
 }
 
 
 void ProgramSi5351 (void)
 {
   unsigned char Si5351RegBuffer[10];
+  unsigned char bytes;
   
   // Zero all Buffer used for repeated write of all registers
   memset ((char *)&Si5351RegBuffer, 0, sizeof(Si5351RegBuffer));
@@ -191,18 +217,10 @@ void ProgramSi5351 (void)
   base = SIREG_26_MSNA_1;                        // Base register address for PLL A
 
   //Load the buffer with MSN register data
-  Si5351RegBuffer[0] = (multisynth.MSN_P3 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[1] = (multisynth.MSN_P3 & 0x000000FF);
-  Si5351RegBuffer[2] = (multisynth.MSN_P1 & 0x00030000) >> 16;
-  Si5351RegBuffer[3] = (multisynth.MSN_P1 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[4] = (multisynth.MSN_P1 & 0x000000FF);
-  Si5351RegBuffer[5] = ((multisynth.MSN_P3 & 0x000F0000) >> 12) |
-                       ((multisynth.MSN_P2 & 0x000F0000) >> 16);
-  Si5351RegBuffer[6] = (multisynth.MSN_P2 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[7] = (multisynth.MSN_P2 & 0x000000FF);
+  LoadPLLRegisters (Si5351RegBuffer);
   
-  // Write the data to the Si5351
-  Si5351RepeatedWriteRegister(base, 8, Si5351RegBuffer);
+  // Write the registers that changed to the Si5351. PLL is normally fixed (900 Mhz) so usually nothing is written
+  bytes = Si5351UpdateRegisters(base, SI_MSREGS, Si5351RegBuffer);
   
 //  Si5351WriteRegister( base++, (multisynth.MSN_P3 & 0x0000FF00) >> 8);
 //  Si5351WriteRegister( base++, (multisynth.MSN_P3 & 0x000000FF));
@@ -214,8 +232,12 @@ void ProgramSi5351 (void)
 //  Si5351WriteRegister( base++, (multisynth.MSN_P2 & 0x0000FF00) >> 8);
 //  Si5351WriteRegister( base, (multisynth.MSN_P2 & 0x000000FF));
 
-  // Reset PLLA (bit 5 set) & PLLB (bit 7 set)
-  Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET | SI_PLLB_RESET );
+  // Reset PLLA (bit 5 set) & PLLB (bit 7 set). Only needed if the PLL changed
+  if (bytes) {
+    Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET | SI_PLLB_RESET );
+    siPLLResets++;
+  }
+  siPLLProgrammed = 1;
 
   // Set the base register for the Multisynth diveder for the clock
   // clkreg is the actual data that will be written to the clock control register and we need to build it up based on parameters passed to this routine
@@ -225,22 +247,10 @@ void ProgramSi5351 (void)
   clkreg = clk0ctl.reg;
   memset ((char *)&Si5351RegBuffer, 0, sizeof(Si5351RegBuffer));
 
-  Si5351RegBuffer[0] = (multisynth.MS_P3 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[1] = (multisynth.MS_P3 & 0x000000FF);
-  Si5351RegBuffer[2] = ( ((multisynth.MS_P1 & 0x00030000) >> 16) |
-                         ((multisynth.R_DIV & 0x7) << 4) |
-                         ((multisynth.MS_DIVBY4 & 0x3) << 2)) ;
-  Si5351RegBuffer[3] = (multisynth.MS_P1 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[4] = (multisynth.MS_P1 & 0x000000FF);
-  Si5351RegBuffer[5] = ((multisynth.MS_P3 & 0x000F0000) >> 12) |
-                       ((multisynth.MS_P2 & 0x000F0000) >> 16);
-  Si5351RegBuffer[6] = (multisynth.MS_P2 & 0x0000FF00) >> 8;
-  Si5351RegBuffer[7] = (multisynth.MS_P2 & 0x000000FF);
-
-
+  LoadMSRegisters (Si5351RegBuffer);
   
-  // Write the values to the corresponding register
-  Si5351RepeatedWriteRegister(base, 8, Si5351RegBuffer);
+  // Write the values that changed to the corresponding register
+  Si5351UpdateRegisters(base, SI_MSREGS, Si5351RegBuffer);
   
 //  Si5351WriteRegister( base++, (multisynth.MS_P3 & 0x0000FF00) >> 8);
 //  Si5351WriteRegister( base++, (multisynth.MS_P3 & 0x000000FF));
@@ -303,14 +313,125 @@ For clock control register, the bits are as follows
   multisynth.ClkEnable &= ~SI_ENABLE_CLK0;       // Enable clk0, bit must be cleared to enable
   
   // The ResetSi5351() routine disables all output clocks and they need to be enabled.  Below enables the specific clock referenced in this routine
-  Si5351WriteRegister (SIREG_3_OUTPUT_ENABLE_CTL, multisynth.ClkEnable);
+  Si5351UpdateRegister (SIREG_3_OUTPUT_ENABLE_CTL, multisynth.ClkEnable);
+}
+
+
+void LoadPLLRegisters (unsigned char *regs)
+// This routine encodes the PLL A feedback multisynth divider (P1, P2, P3) calculated by CalculateDividers() into the 
+// 8 register values for PLL A (registers 26-33)
+{
+  regs[0] = (multisynth.MSN_P3 & 0x0000FF00) >> 8;
+  regs[1] = (multisynth.MSN_P3 & 0x000000FF);
+  regs[2] = (multisynth.MSN_P1 & 0x00030000) >> 16;
+  regs[3] = (multisynth.MSN_P1 & 0x0000FF00) >> 8;
+  regs[4] = (multisynth.MSN_P1 & 0x000000FF);
+  regs[5] = ((multisynth.MSN_P3 & 0x000F0000) >> 12) |
+            ((multisynth.MSN_P2 & 0x000F0000) >> 16);
+  regs[6] = (multisynth.MSN_P2 & 0x0000FF00) >> 8;
+  regs[7] = (multisynth.MSN_P2 & 0x000000FF);
+}
+
+
+unsigned char LoadSi5351Registers (unsigned long freq, unsigned char *pllregs, unsigned char *msregs)
+// This routine programs CLK0 for freq from register images calculated earlier (e.g. memory channel) without calculating
+// dividers. Only the registers that differ are written and the PLL is only reset if it changed.
+// pllregs can be 0 to keep the current PLL (e.g. images calculated with another correction). 
+// Returns 0 if the PLL has not been programmed since ResetSi5351() so SetFrequency() must be used
+{
+  if (!pllregs && !siPLLProgrammed) return 0;
+
+  if (pllregs) {
+    if (Si5351UpdateRegisters (SIREG_26_MSNA_1, SI_MSREGS, pllregs)) {
+      Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET | SI_PLLB_RESET );
+      siPLLResets++;
+    }
+    siPLLProgrammed = 1;
+  }
+  Si5351UpdateRegisters (SIREG_42_MSYN0_1, SI_MSREGS, msregs);
+
+  // Clock may have been powered down (see DisableSi5351Clocks())
+  UpdateClkControlRegister ();
+  multisynth.ClkEnable &= ~SI_ENABLE_CLK0;
+  Si5351UpdateRegister (SIREG_3_OUTPUT_ENABLE_CTL, multisynth.ClkEnable);
+
+  multisynth.MS_Fout = freq;
+  clk0ctl.freq = freq;
+
+  return 1;
+}
+
+
+void LoadMSRegisters (unsigned char *regs)
+// This routine encodes the output multisynth divider (P1, P2, P3) calculated by CalculateDividers() into the 
+// 8 register values for CLK0 (registers 42-49)
+{
+  regs[0] = (multisynth.MS_P3 & 0x0000FF00) >> 8;
+  regs[1] = (multisynth.MS_P3 & 0x000000FF);
+  regs[2] = ( ((multisynth.MS_P1 & 0x00030000) >> 16) |
+              ((multisynth.R_DIV & 0x7) << 4) |
+              ((multisynth.MS_DIVBY4 & 0x3) << 2)) ;
+  regs[3] = (multisynth.MS_P1 & 0x0000FF00) >> 8;
+  regs[4] = (multisynth.MS_P1 & 0x000000FF);
+  regs[5] = ((multisynth.MS_P3 & 0x000F0000) >> 12) |
+            ((multisynth.MS_P2 & 0x000F0000) >> 16);
+  regs[6] = (multisynth.MS_P2 & 0x0000FF00) >> 8;
+  regs[7] = (multisynth.MS_P2 & 0x000000FF);
+}
+
+
+void CalculateMSRegisters (unsigned long freq, unsigned char *regs)
+// This routine calculates the CLK0 output multisynth register values for a frequency without programming the Si5351
+// The PLL is always 900 Mhz so only the output multisynth changes with frequency.  The register values can be saved 
+// (e.g. RTTY Mark and Space) and written later with WriteMSRegisters() which is much faster than SetFrequency()
+{
+  CalculateDividers (freq);
+  LoadMSRegisters (regs);
+}
+
+
+void WriteMSRegisters (unsigned char *regs)
+// This routine writes precalculated CLK0 output multisynth registers (see CalculateMSRegisters()). 
+// Only the registers that differ from the last values written are sent (see Si5351UpdateRegisters())
+// The PLL is not reset. SetFrequency() must have been called first so that the PLL and clock are configured.
+{
+  Si5351UpdateRegisters(SIREG_42_MSYN0_1, SI_MSREGS, regs);
+}
+
+
+static void RetuneStep (long delta)
+// This routine moves the cached output divider solution (siTune) by delta Hz using only 32-bit arithmetic.
+// The solution is kept exact: PLL_Fvco x SI_MAXIMUM_DENOMINATOR = div x freq + rem where div is MS_a x c + MS_b
+// With div = qd x newfreq + rd then div x delta = qd x delta x newfreq + rd x delta so
+//   PLL_Fvco x c = (div - qd x delta) x newfreq + (rem - rd x delta)
+// and the last term is brought back into 0 to newfreq-1. |delta| <= SI_RETUNE_CHUNK so rd x delta fits in a long
+{
+  unsigned long freq, qd, rd;
+  long rem, q;
+
+  freq = siTune.freq + delta;
+  qd = siTune.div / freq;
+  rd = siTune.div % freq;
+
+  rem = (long)siTune.rem - (long)rd * delta;
+  q = rem / (long)freq;
+  rem -= q * (long)freq;
+  if (rem < 0) {
+    rem += freq;
+    q--;
+  }
+
+  siTune.div = siTune.div - (long)qd * delta + q;
+  siTune.rem = rem;
+  siTune.freq = freq;
 }
 
 
 void CalculateDividers (unsigned long freq)
 {
-  unsigned long numerator, remainder, b, c;
+  unsigned long numerator, remainder;
   uint64_t numerator64;
+  long delta;
 
   // Use the higher PLL frequency possible (one less calculation to make)
   multisynth.PLL_Fvco = SI_MAX_PLL_FREQ;
@@ -337,11 +458,14 @@ number approximation.
 */
 
 // Step 1. Calculate PLL Frequency Divider
-  // Calculate the corrected/calibrated crystal frequency that will be used to calculate the PLL frequency
-  multisynth.Fxtalcorr = multisynth.Fxtal + (long) ((double)(multisynth.correction / 10000000.0) * (double) multisynth.Fxtal);
+  // The PLL is fixed at SI_MAX_PLL_FREQ so the divider only changes if the crystal calibration changes
+  if (!siTune.pllValid || siTune.correction != multisynth.correction) {
+
+    // Calculate the corrected/calibrated crystal frequency that will be used to calculate the PLL frequency
+    multisynth.Fxtalcorr = multisynth.Fxtal + (long) ((double)(multisynth.correction / 10000000.0) * (double) multisynth.Fxtal);
 
-  // Calculate the multipler (quotient) to get the PLL frequency
-  multisynth.PLL_a = multisynth.PLL_Fvco / multisynth.Fxtalcorr;
+    // Calculate the multipler (quotient) to get the PLL frequency
+    multisynth.PLL_a = multisynth.PLL_Fvco / multisynth.Fxtalcorr;
 /*
 The basic approach is that x/y will result in a quotent q and remainder r/y (e.g. 3/2 is 1.5 Quotient is 1, remainder is 1/2). 
 We need to get the remainder from the division and then figure out the most accurate fraction based on the largest number that can be used (i.e. SI_MAXIMUM_DENOMINATOR).
@@ -353,28 +477,32 @@ may result in a 32bit integer to overflow.  So we need to use a 64bit integer wh
 So define a 64bit interger and completed the math, then convert back to a 32 bit integer.
 
 */  
-  // Calculate the remainder for the multiplier to get the PLL frequency
-  remainder = multisynth.PLL_Fvco % multisynth.Fxtalcorr;
-  numerator64 = remainder;
-  numerator64 *= SI_MAXIMUM_DENOMINATOR;
+    // Calculate the remainder for the multiplier to get the PLL frequency
+    remainder = multisynth.PLL_Fvco % multisynth.Fxtalcorr;
+    numerator64 = remainder;
+    numerator64 *= SI_MAXIMUM_DENOMINATOR;
 
-  do_div(numerator64, multisynth.Fxtalcorr); 
+    do_div(numerator64, multisynth.Fxtalcorr); 
   
-  numerator = (unsigned long)numerator64;
+    numerator = (unsigned long)numerator64;
   
-//  RationalNumberApproximation(numerator, SI_MAXIMUM_DENOMINATOR, (SI_MAXIMUM_DENOMINATOR - 1), SI_MAXIMUM_DENOMINATOR, &b, &c);   
-//  multisynth.PLL_b = b;
-//  multisynth.PLL_c = c;
-  multisynth.PLL_b = numerator;
-  multisynth.PLL_c = SI_MAXIMUM_DENOMINATOR;
+  //  RationalNumberApproximation(numerator, SI_MAXIMUM_DENOMINATOR, (SI_MAXIMUM_DENOMINATOR - 1), SI_MAXIMUM_DENOMINATOR, &b, &c);   
+  //  multisynth.PLL_b = b;
+  //  multisynth.PLL_c = c;
+    multisynth.PLL_b = numerator;
+    multisynth.PLL_c = SI_MAXIMUM_DENOMINATOR;
   
-//  FareyFraction (result, &multisynth.PLL_b, &multisynth.PLL_c);
+  //  FareyFraction (result, &multisynth.PLL_b, &multisynth.PLL_c);
 
-// Encode Fractional PLL Feedback Multisynth Divider into P1, P2 and P3
-  temp = (128 * multisynth.PLL_b) / multisynth.PLL_c;
-  multisynth.MSN_P1 = 128 * multisynth.PLL_a + temp - 512;
-  multisynth.MSN_P2 = 128 * multisynth.PLL_b - multisynth.PLL_c * temp;
-  multisynth.MSN_P3 = multisynth.PLL_c;
+  // Encode Fractional PLL Feedback Multisynth Divider into P1, P2 and P3
+    temp = (128 * multisynth.PLL_b) / multisynth.PLL_c;
+    multisynth.MSN_P1 = 128 * multisynth.PLL_a + temp - 512;
+    multisynth.MSN_P2 = 128 * multisynth.PLL_b - multisynth.PLL_c * temp;
+    multisynth.MSN_P3 = multisynth.PLL_c;
+
+    siTune.correction = multisynth.correction;
+    siTune.pllValid = 1;
+  }
 
 
 // Step 2. Calculate clock divider  
@@ -385,22 +513,49 @@ So define a 64bit interger and completed the math, then convert back to a 32 bit
   // Calculate the multipler to get the maximum PLL frequency
   // The divider below is used to calculate the multisynch dividers (a+b/c) to get the clock frequency from the PLL frequency calculated below
 
-  // Calculate the multipler (quotient) to get the Output frequency
-  multisynth.MS_a = multisynth.PLL_Fvco /freq;
+  // Small frequency steps (encoder, RTTY mark/space) move the cached solution. Large jumps do the full calculation 
+  delta = freq - siTune.freq;
+  if (siTune.msValid && freq <= SI_MAX_OUT_FREQ && delta <= SI_RETUNE_MAX && delta >= -SI_RETUNE_MAX) {
+    while (delta > SI_RETUNE_CHUNK) {
+      RetuneStep (SI_RETUNE_CHUNK);
+      delta -= SI_RETUNE_CHUNK;
+    }
+    while (delta < -SI_RETUNE_CHUNK) {
+      RetuneStep (-SI_RETUNE_CHUNK);
+      delta += SI_RETUNE_CHUNK;
+    }
+    if (delta) RetuneStep (delta);
+
+    multisynth.MS_a = siTune.div / SI_MAXIMUM_DENOMINATOR;
+    multisynth.MS_b = siTune.div % SI_MAXIMUM_DENOMINATOR;
+    siFastRetunes++;
+
+  } else {
+
+    // Calculate the multipler (quotient) to get the Output frequency
+    multisynth.MS_a = multisynth.PLL_Fvco /freq;
   
-  // Calculate the remainder for the multiplier to get the Output frequency
-  remainder = multisynth.PLL_Fvco % freq;
-  numerator64 = remainder;
-  numerator64 *= SI_MAXIMUM_DENOMINATOR;
+    // Calculate the remainder for the multiplier to get the Output frequency
+    remainder = multisynth.PLL_Fvco % freq;
+    numerator64 = remainder;
+    numerator64 *= SI_MAXIMUM_DENOMINATOR;
 
-  do_div(numerator64, freq); 
+    siTune.rem = do_div(numerator64, freq); 
   
-  numerator = (unsigned long)numerator64;
+    numerator = (unsigned long)numerator64;
   
-//  RationalNumberApproximation(numerator, SI_MAXIMUM_DENOMINATOR, (SI_MAXIMUM_DENOMINATOR - 1), SI_MAXIMUM_DENOMINATOR, &b, &c);   
-//  multisynth.MS_b = b;
-//  multisynth.MS_c = c;
-  multisynth.MS_b = numerator;
+  //  RationalNumberApproximation(numerator, SI_MAXIMUM_DENOMINATOR, (SI_MAXIMUM_DENOMINATOR - 1), SI_MAXIMUM_DENOMINATOR, &b, &c);   
+  //  multisynth.MS_b = b;
+  //  multisynth.MS_c = c;
+    multisynth.MS_b = numerator;
+
+    // Save solution for fast retuning
+    siTune.div = multisynth.MS_a * SI_MAXIMUM_DENOMINATOR + multisynth.MS_b;
+    siTune.freq = freq;
+    siTune.msValid = 1;
+    siFullRetunes++;
+  }
+
   multisynth.MS_c = SI_MAXIMUM_DENOMINATOR;
 
   temp = (128 * multisynth.MS_b) / multisynth.MS_c;
@@ -469,7 +624,7 @@ void UpdateClkControlRegister (void)
 // This routine write the clock control register variable stored in the clock control strucutre to the
 // Si5351 clock control register.  The register must be defined elsewhere.
 // This routine does not enable the clock.  Its assumed that its been enabled elsewhere
-  Si5351WriteRegister (SIREG_16_CLK0_CTL, clk0ctl.reg);
+  Si5351UpdateRegister (SIREG_16_CLK0_CTL, clk0ctl.reg);
 
 }
 
@@ -544,6 +699,7 @@ Cannot use Wire Library because its Interupt based and need to change fequency f
 Interupts cannot be layered.  Its one at a time.
 
 For I2C communication must be manually done
+Writes are queued and sent by the TWI interupt (see i2c.cpp). Errors are counted in i2cErrors (see ^Q)
 */
 
 
@@ -560,15 +716,17 @@ void Si5351RepeatedWriteRegister(unsigned char  addr, unsigned char  bytes, unsi
 //  }
 //  Wire.endTransmission();
 
-  i2cSendRepeatedRegister(addr, bytes, data);
+  if (i2cQueueWrite(addr, bytes, data)) return;   // Not sent so shadow copy must not change
+
+  // Copy the part of the write that is shadowed (registers past SI_SHADOW_REGS are not)
+  if (addr < SI_SHADOW_REGS) memcpy ((char *)&siShadow[addr], (char *)data, min (bytes, SI_SHADOW_REGS - addr));
+  siBytesWritten += bytes;
 }
 
 
 void Si5351WriteRegister (unsigned char reg, unsigned char value)
 // Routine uses the I2C protcol to write data to the Si5351 register.
 {
-  unsigned char err;
-  
 // I2C communication must be manually done. Wire library is Interupt based and cannot be used!!
 
 //  Wire.begin();
@@ -577,11 +735,52 @@ void Si5351WriteRegister (unsigned char reg, unsigned char value)
 //  Wire.write(value);
 //  Wire.endTransmission();
 
-  err = i2cSendRegister(reg, value);
-  if (err) {
-    Serial.print ("I2C W Err ");
-    Serial.println (err);
+  if (i2cQueueWrite(reg, 1, &value)) return;
+
+  if (reg < SI_SHADOW_REGS) siShadow[reg] = value;
+  siBytesWritten++;
+}
+
+
+unsigned char Si5351UpdateRegisters (unsigned char addr, unsigned char bytes, unsigned char *data)
+// Routine only writes the registers that differ from the shadow copy (siShadow). Changes separated by SI_BURST_GAP 
+// or fewer unchanged registers are sent as one repeated write (cheaper than another start, address and register byte).
+// If the shadow is not valid or the registers are not shadowed all registers are written. Returns bytes written
+{
+  unsigned char i, first, last, sent;
+
+  if (!siShadowValid || addr + bytes > SI_SHADOW_REGS) {
+    Si5351RepeatedWriteRegister (addr, bytes, data);
+    return bytes;
+  }
+
+  sent = 0;
+  i = 0;
+  while (i < bytes) {
+    if (data[i] == siShadow[addr + i]) {
+      i++;
+      continue;
+    }
+
+    // Found a change. Extend burst until more than SI_BURST_GAP registers are unchanged
+    first = last = i;
+    for (i++; i < bytes && (i - last) <= SI_BURST_GAP + 1; i++) {
+      if (data[i] != siShadow[addr + i]) last = i;
+    }
+
+    Si5351RepeatedWriteRegister (addr + first, last - first + 1, &data[first]);
+    sent += last - first + 1;
+    i = last + 1;
   }
+
+  return sent;
+}
+
+
+unsigned char Si5351UpdateRegister (unsigned char reg, unsigned char value)
+// Routine writes a register only if it differs from the shadow copy. Returns bytes written
+{
+  return Si5351UpdateRegisters (reg, 1, &value);
 }
 
 unsigned char Si5351ReadRegister (unsigned char reg)
@@ -600,8 +799,8 @@ unsigned char Si5351ReadRegister (unsigned char reg)
 
   err=i2cReadRegister(reg, &value);  
   if (err) {
-    Serial.print ("I2C R Err ");
-    Serial.println (err);
+    i2cErrors++;
+    i2cLastError = err;
     value = 0;
   }
 
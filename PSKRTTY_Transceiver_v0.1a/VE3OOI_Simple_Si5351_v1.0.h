@@ -33,12 +33,27 @@ typedef struct {
         unsigned long PLLFreq;
 } Si5351_CLK_def;
 
+// Cached divider solution for fast retuning (see CalculateDividers())
+typedef struct {
+  unsigned char pllValid;     // PLL divider in multisynth is valid for correction
+  unsigned char msValid;      // div and rem are valid for freq
+  long correction;            // Crystal correction used for PLL divider
+  unsigned long freq;         // Output frequency of cached solution
+  unsigned long div;          // Output divider x SI_MAXIMUM_DENOMINATOR (MS_a x MS_c + MS_b)
+  unsigned long rem;          // Remainder i.e. SI_MAX_PLL_FREQ x SI_MAXIMUM_DENOMINATOR = div x freq + rem
+} Si5351_Tune_def;
+
 void SetFrequency (unsigned long freq);
 
 void WriteSi5351PLL (void);
 void UpdateClkControlRegister (void);
 void UpdatePhaseControlRegister (void);
 void CalculateDividers (unsigned long freq);
+void LoadMSRegisters (unsigned char *regs);
+void LoadPLLRegisters (unsigned char *regs);
+unsigned char LoadSi5351Registers (unsigned long freq, unsigned char *pllregs, unsigned char *msregs);
+void CalculateMSRegisters (unsigned long freq, unsigned char *regs);
+void WriteMSRegisters (unsigned char *regs);
 void RationalNumberApproximation(unsigned long given_numerator, unsigned long given_denominator,
         unsigned long max_numerator, unsigned long max_denominator,
         unsigned long *best_numerator, unsigned long *best_denominator);
@@ -50,6 +65,8 @@ void InvertClk (unsigned char invert);
 void ProgramSi5351 (void);
 void Si5351WriteRegister (unsigned char reg, unsigned char value);
 void Si5351RepeatedWriteRegister(unsigned char  addr, unsigned char  bytes, unsigned char *data);
+unsigned char Si5351UpdateRegisters (unsigned char addr, unsigned char bytes, unsigned char *data);
+unsigned char Si5351UpdateRegister (unsigned char reg, unsigned char value);
 unsigned char Si5351ReadRegister (unsigned char reg);
 
 
@@ -70,6 +87,9 @@ unsigned char Si5351ReadRegister (unsigned char reg);
 #define SIREG_18_CLK2_CTL          18
 
 #define SI_MSREGS                  8
+#define SI_SHADOW_REGS             66       // Registers 0-65 are shadowed (see Si5351UpdateRegisters())
+#define SI_BURST_GAP               2        // Unchanged registers sent rather than starting another repeated write
+#define SI_FULL_PROGRAM_BYTES      19       // Bytes ProgramSi5351() writes without diffing (PLL 8, reset, MS 8, CLK0 ctl, output enable)
 #define SIREG_26_MSNA_1            26
 #define SIREG_27_MSNA_2            27
 #define SIREG_28_MSNA_3            28
@@ -150,6 +170,9 @@ unsigned char Si5351ReadRegister (unsigned char reg);
 #define SI_MAX_OUT_FREQ     30000000             // Fixed arbituarly to HF frequencies
 #define SI_MIN_OUT_FREQ     1000000
 
+#define SI_RETUNE_MAX       2000                 // Largest step (Hz) done incrementally. Larger jumps do full calculation
+#define SI_RETUNE_CHUNK     64                   // Largest step per RetuneStep(). 64 x SI_MAX_OUT_FREQ must fit in a long
+
 #define SI_MAX_MS_FREQ      150000000
 #define SI_MSYN_DIV_4     4
 #define SI_MSYN_DIV_6     6
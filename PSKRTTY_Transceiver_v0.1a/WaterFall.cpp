@@ -100,6 +100,39 @@ void setupFFT (void)
     binFreq[i] = round ((double)FreqPerBin * (double)i);
   }
 
+  // Reset streaming spectrum rows and statistics
+  memset (fhtRowSum, 0, sizeof(fhtRowSum));
+  fhtRowFFTs = 0;
+  fhtFFTs = fhtRows = 0;
+  fhtHalfBlocks = fhtCovered = fhtLastBlock = 0;
+  fhtStartTime = fhtRowTime = millis();
+}
+
+
+unsigned char AverageFFT (void)
+{
+// This routine adds the FFT output to the current display row. Once every FHT_ROW_MS the average of the FFTs
+// is put back in fht_log_out[] for display and 1 is returned.  Otherwise 0 is returned (nothing to display)
+
+  unsigned char i;
+  unsigned long now;
+
+  for (i=0; i<FHT_N2; i++) fhtRowSum[i] += fht_log_out[i];
+  fhtRowFFTs++;
+  fhtFFTs++;
+
+  now = millis();
+  if (now - fhtRowTime < FHT_ROW_MS && fhtRowFFTs < FHT_ROW_MAX_FFTS) return 0;
+
+  for (i=0; i<FHT_N2; i++) {
+    fht_log_out[i] = fhtRowSum[i] / fhtRowFFTs;
+    fhtRowSum[i] = 0;
+  }
+  fhtRowFFTs = 0;
+  fhtRowTime = now;
+  fhtRows++;
+
+  return 1;
 }
 
 
@@ -9,6 +9,7 @@ int FFTPeakSearch (unsigned int frequency, int threshold);
 void FFTPeaks (unsigned char maxPeaks); 
 void setupFFT (void);
 void FFTnoise (unsigned int freq);
+unsigned char AverageFFT (void);
 
 // FFT Defines
 #define LOG_OUT 1
@@ -17,7 +18,17 @@ void FFTnoise (unsigned int freq);
 #define LIN_OUT 0
 #define FHT_N 128     // set to 128 point fht
 #define FHT_N2 64     // this must be 64 or else LCD display water fall won't work
+#define FHT_RING (FHT_N + FHT_N2)     // ADC sample ring is the FFT window plus the half block being sampled
 #define WINDOW 1
 
+// Streaming spectrum defines. FFTs are done every FHT_N2 samples (6.7 ms) and averaged to the display rate
+#define FHT_ROW_MS 100                // Display a row every 100 ms
+#define FHT_ROW_MAX_FFTS 200          // Limit FFTs per row so fhtRowSum[] cannot overflow (display stalled)
+
+// Audio passband used by the band scanner (see Scan.cpp)
+#define CARRIER_MIN_BIN 4             // 300 Hz. Search audio passband only
+#define CARRIER_MAX_BIN 40            // 3000 Hz
+#define CARRIER_MARGIN 24             // Carrier must be this much above average (16 = 6 dB in fht_log_out)
+
 
 #endif // _WATERFALL_H_
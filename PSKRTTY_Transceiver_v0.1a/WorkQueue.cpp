@@ -0,0 +1,89 @@
+/*
+
+Routines to defer slow work (e.g. I2C writes to the Si5351) out of the timer interupts ("bottom half").
+
+AVR interupts don't nest so while a timer ISR does I2C the ADC, serial and encoder interupts are blocked for
+up to a few ms.  Timer3 (PSK) and Timer4 (RTTY) now only decide what needs to be done and queue a small work
+item.  The main loop calls RunDeferredWork() as often as possible (loop() and when sampling is toggled for slow
+LCD updates) to do the work.  The queue is a single producer (ISR) single consumer (main loop) ring so it 
+does not need interupts disabled.  The time from the ISR to the work is tracked against a deadline.
+
+*/
+
+#include "Arduino.h"
+
+#include "AllIncludes.h"
+
+#include "AllExternVariables.h"
+
+
+void ResetWorkQueue (void)
+{
+// Routine to empty the work queue and reset the statistics
+  workQueueHead = workQueueTail = 0;
+  workMaxLatency = 0;
+  workDeadlineMiss = 0;
+  workOverflow = 0;
+  workCount = 0;
+  txISRMaxTime = 0;
+}
+
+
+void PushWork (unsigned char type, unsigned char arg)
+{
+// Routine called by a timer ISR to queue work. The head is only updated after the entry is filled 
+// so the main loop never sees a partial entry.  If the queue is full the work is dropped and counted
+  unsigned char head, next;
+
+  head = workQueueHead;
+  next = (head + 1) & WORK_QUEUE_MASK;
+  if (next == workQueueTail) {
+    workOverflow++;
+    return;
+  }
+  workQueue[head].type = type;
+  workQueue[head].arg = arg;
+  workQueue[head].stamp = (unsigned int)micros();
+  workQueueHead = next;
+}
+
+
+void RunDeferredWork (void)
+{
+// Routine called from the main loop to do all queued work in order. 
+// Latency (ISR to start of work) is measured and work that starts after WORK_DEADLINE_US is counted as a miss
+  unsigned char tail;
+  unsigned int latency;
+
+  tail = workQueueTail;
+  while (tail != workQueueHead) {
+    latency = (unsigned int)micros() - workQueue[tail].stamp;
+    if (latency > workMaxLatency) workMaxLatency = latency;
+    if (latency > WORK_DEADLINE_US) workDeadlineMiss++;
+    workCount++;
+
+    ExecuteWork (workQueue[tail].type, workQueue[tail].arg);
+    tail = (tail + 1) & WORK_QUEUE_MASK;
+    workQueueTail = tail;
+  }
+}
+
+
+void ExecuteWork (unsigned char type, unsigned char arg)
+{
+// Routine to do a work item. Work queued before the transmitter was stopped is ignored
+  switch (type) {
+    case WORK_RTTY_KEY:
+      if (flags & TRANSMITRTTY) TxRTTYbit (arg);      // Change to Mark or Space frequency
+      break;
+
+    case WORK_PSK_INVERT:
+      if (flags & TRANSMITPSK) {
+        PinLow(TxEnable);                             // Turn off transmitter, power output decreases. helps reduce harmonics when carrier phase changed
+        InvertClk (arg);                              // Invert carrier 
+        i2cFlush();                                   // Wait for TWI interupt to send it
+        PinHigh(TxEnable);                            // Enable transmitter, power ouput increases
+      }
+      break;
+  }
+}
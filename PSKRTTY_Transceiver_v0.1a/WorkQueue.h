@@ -0,0 +1,25 @@
+#ifndef _WORKQUEUE_H_
+#define _WORKQUEUE_H_
+
+// Deferred Work Queue Routines
+void ResetWorkQueue (void);
+void PushWork (unsigned char type, unsigned char arg);
+void RunDeferredWork (void);
+void ExecuteWork (unsigned char type, unsigned char arg);
+
+#define WORK_QUEUE_SIZE 8               // Number of pending work items. Must be power of 2
+#define WORK_QUEUE_MASK (WORK_QUEUE_SIZE-1)
+
+#define WORK_DEADLINE_US 1000           // Work must start within 1 ms of the timer tick (under 10% of 75 baud bit)
+
+// Work item types
+#define WORK_RTTY_KEY 1                 // Key RTTY Mark (arg 1) or Space (arg 0)
+#define WORK_PSK_INVERT 2               // Invert PSK carrier (arg is new invert state)
+
+typedef struct {
+  unsigned char type;                   // Work to be done (WORK_xxx)
+  unsigned char arg;                    // Argument for the work
+  unsigned int stamp;                   // Time (us, low 16 bits) work was queued. Used for deadline
+} WorkItem_def;
+
+#endif // _WORKQUEUE_H_
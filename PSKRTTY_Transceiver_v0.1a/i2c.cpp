@@ -5,10 +5,18 @@ Cannot use interupt driver I2C from another interupt - bad things happen
 
 Routines adapted from  http://www.embedds.com/programming-avr-i2c-interface/
 
+Register writes are queued (i2cQueueWrite()) and sent by the TWI interupt at 400 Khz so the CPU does not wait
+for the transfer.  Tx keying is no longer done in a timer interupt (see WorkQueue.cpp) so this is now safe.
+Writes may be queued with interupts disabled. The TWI interupt cannot run then, so a full queue (or i2cFlush())
+sends the queue by polling i2cService() instead of waiting for the interupt.
+Reads are still done by polling after the queue is empty (i2cFlush()).
+
 */
 
 #include <inttypes.h>
+#include <string.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include "i2c.h"
 
@@ -17,9 +25,142 @@ Routines adapted from  http://www.embedds.com/programming-avr-i2c-interface/
 #define I2C_SLA_W_ACK 0x18
 #define I2C_SLA_R_ACK 0x40
 #define I2C_DATA_ACK 0x28
+#define I2C_STATUS_MASK 0xF8
 #define I2C_WRITE 0b11000000
 #define I2C_READ  0b11000001
 
+// TWCR values for the interupt driven engine
+#define I2C_INT_START    ((1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE))
+#define I2C_INT_CONTINUE ((1<<TWINT) | (1<<TWEN) | (1<<TWIE))
+#define I2C_INT_RESTART  ((1<<TWINT) | (1<<TWSTO) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE))   // Stop then start next transaction
+#define I2C_INT_STOP     ((1<<TWINT) | (1<<TWSTO) | (1<<TWEN))
+
+static volatile I2CTransaction_def i2cQueue[I2C_QUEUE_SIZE];
+static volatile uint8_t i2cQueueHead, i2cQueueTail;
+static volatile uint8_t i2cPos;             // Next data byte of current transaction
+static volatile uint8_t i2cActive;          // TWI interupt is sending the queue
+
+volatile uint16_t i2cErrors;                // Transactions dropped (no ACK, lost arbitration)
+volatile uint8_t i2cLastError;              // TWI status of last error
+volatile uint32_t i2cTransactions, i2cBytes;  // Transactions and data bytes sent
+
+static void i2cService(void);
+
+
+//////////////////////////////////
+// TWI ISR - send queued register writes. One interupt per START/byte
+//////////////////////////////////
+ISR(TWI_vect)
+{
+  i2cService();
+}
+
+
+static void i2cService(void)
+{
+// Next step of the queued transaction. Called from the TWI interupt or by i2cPoll() when interupts are disabled
+  uint8_t tail;
+
+  tail = i2cQueueTail;
+  switch (TWSR & I2C_STATUS_MASK) {
+    case I2C_START:                       // Start sent. Send address
+    case I2C_START_RPT:
+      TWDR = I2C_WRITE;
+      TWCR = I2C_INT_CONTINUE;
+      return;
+
+    case I2C_SLA_W_ACK:                   // Address acknowledged. Send register
+      TWDR = i2cQueue[tail].reg;
+      i2cPos = 0;
+      TWCR = I2C_INT_CONTINUE;
+      return;
+
+    case I2C_DATA_ACK:                    // Register or data acknowledged. Send next data byte
+      if (i2cPos < i2cQueue[tail].len) {
+        TWDR = i2cQueue[tail].data[i2cPos++];
+        TWCR = I2C_INT_CONTINUE;
+        return;
+      }
+      i2cTransactions++;
+      i2cBytes += i2cQueue[tail].len;
+      break;
+
+    default:                              // Error. Drop the transaction
+      i2cErrors++;
+      i2cLastError = TWSR & I2C_STATUS_MASK;
+      break;
+  }
+
+  // Transaction complete (or dropped). Start the next one or stop
+  tail = (tail + 1) & I2C_QUEUE_MASK;
+  i2cQueueTail = tail;
+  if (tail != i2cQueueHead) {
+    TWCR = I2C_INT_RESTART;
+  } else {
+    TWCR = I2C_INT_STOP;
+    i2cActive = 0;
+  }
+}
+
+
+static void i2cPoll(void)
+{
+// Called while waiting for the queue. With interupts disabled the TWI interupt cannot run so do its work here
+  if (!(SREG & (1<<SREG_I)) && i2cActive && (TWCR & (1<<TWINT))) i2cService();
+}
+
+
+uint8_t i2cQueueWrite(uint8_t reg, uint8_t bytes, uint8_t *data)
+{
+// Queue a register write. Writes longer than I2C_MAX_DATA are split (Si5351 auto increments the register address).
+// Waits if the queue is full. Returns 1 (nothing queued) if the TWI is not enabled (i2cInit() not called)
+  uint8_t head, next, sreg, len;
+
+  if (!(TWCR & (1<<TWEN))) return 1;
+
+  while (bytes) {
+    len = bytes > I2C_MAX_DATA ? I2C_MAX_DATA : bytes;
+    head = i2cQueueHead;
+    next = (head + 1) & I2C_QUEUE_MASK;
+    while (next == i2cQueueTail) i2cPoll ();    // Queue full. Wait for TWI interupt to send a transaction
+
+    i2cQueue[head].reg = reg;
+    i2cQueue[head].len = len;
+    memcpy ((void *)i2cQueue[head].data, data, len);
+
+    sreg = SREG;
+    cli();
+    i2cQueueHead = next;
+    if (!i2cActive) {                       // Engine idle so start it
+      i2cActive = 1;
+      while (TWCR & (1<<TWSTO)) ;           // Wait for last stop to complete
+      TWCR = I2C_INT_START;
+    }
+    SREG = sreg;
+
+    reg += len;
+    data += len;
+    bytes -= len;
+  }
+
+  return 0;
+}
+
+
+uint8_t i2cBusy(void)
+{
+// Completion flag. Returns 1 if queued writes have not been sent
+  return i2cActive;
+}
+
+
+void i2cFlush(void)
+{
+// Wait for all queued writes to be sent
+  while (i2cActive) i2cPoll ();
+  while (TWCR & (1<<TWSTO)) ;
+}
+
 uint8_t i2cStart(void)
 {
   TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN);
@@ -106,6 +247,7 @@ uint8_t i2cReadRegister(uint8_t reg, uint8_t *data)
 {
   uint8_t stts;
   
+  i2cFlush();                   // Queued writes must be sent first. Read is done by polling
   stts = i2cStart();
   if (stts != I2C_START) return 1;
 
@@ -129,10 +271,12 @@ uint8_t i2cReadRegister(uint8_t reg, uint8_t *data)
 }
 
 // Init TWI (I2C)
-//
+// 400 Khz (fast mode). SCL = F_CPU / (16 + 2 x TWBR) with prescaler 1
 void i2cInit()
 {
-  TWBR = 92;            
+  i2cFlush();
+  TWBR = I2C_TWBR;            
   TWSR = 0;
   TWDR = 0xFF;
+  TWCR = (1<<TWEN);           // Enable the TWI. i2cQueueWrite() does not queue until this is done
 }
@@ -3,7 +3,29 @@
 
 #include <inttypes.h>
 
+#ifndef F_CPU
+#define F_CPU 16000000UL              // Set by Arduino IDE for the board
+#endif
+#define I2C_FREQUENCY 400000UL        // Fast mode
+#define I2C_TWBR ((F_CPU / I2C_FREQUENCY - 16) / 2)
+#define I2C_QUEUE_SIZE 8              // Queued transactions. Must be power of 2
+#define I2C_QUEUE_MASK (I2C_QUEUE_SIZE-1)
+#define I2C_MAX_DATA 8                // Bytes per queued transaction (a multisynth is 8 registers). Longer writes are split
+
+typedef struct {
+  uint8_t reg;                        // First register
+  uint8_t len;                        // Number of data bytes
+  uint8_t data[I2C_MAX_DATA];
+} I2CTransaction_def;
+
+extern volatile uint16_t i2cErrors;
+extern volatile uint8_t i2cLastError;
+extern volatile uint32_t i2cTransactions, i2cBytes;
+
 void i2cInit();
+uint8_t i2cQueueWrite(uint8_t reg, uint8_t bytes, uint8_t *data);
+uint8_t i2cBusy(void);
+void i2cFlush(void);
 uint8_t i2cSendRegister(uint8_t reg, uint8_t data);
 uint8_t i2cReadRegister(uint8_t reg, uint8_t *data);
 uint8_t i2cSendRepeatedRegister(uint8_t reg, uint8_t bytes, uint8_t *data);
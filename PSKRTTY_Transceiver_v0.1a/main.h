@@ -17,11 +17,17 @@ void ResetFrequencies (void);
 void ExecuteSerial (char *str);
 void TestLEDS (void);
 void StatusLED (void);
+void MeasurePinIO (void);
 
 
 // EEPROM Routines
 void EEPROMWriteCorrection(void);
 void EEPROMReadCorrection(void);
+void EEPROMWriteRTTYConfig(void);
+void EEPROMReadRTTYConfig(void);
+
+#define EEPROM_RTTY_CONFIG    4         // Byte after Si5351 correction (dword at 0)
+#define EEPROM_MEMORY_BASE    8         // Memory channels (see Memory.h)
 
 // Error Codes
 #define PSK_BUFFER_OVERFLOW           0x1000
@@ -32,6 +38,7 @@ void EEPROMReadCorrection(void);
 #define FREQUENCY_NOT_SET             0x1010
 #define CANNOT_COMPLETE_DECODE_ENABLED 0x1020
 #define SERIAL_BUFFER_OVERFLOW        0x1040
+#define DECODE_BUDGET_EXCEEDED        0x1080
 
 // Frequencies defines
 #define DEFAULT_FREQUENCY           7100000
@@ -65,11 +72,8 @@ void EEPROMReadCorrection(void);
 #define UPDATE_FREQ           0x20000
 #define TOGGLE_SAMPLING       0x40000
 #define NARROW_WATERFALL      0x80000
-#define PBUTTON1_PUSHED       0x100000
-#define PBUTTON2_PUSHED       0x200000
-#define PBUTTON3_PUSHED       0x400000
-#define PBUTTON_REUSED        0x800000
 #define CLIPPING              0x1000000
+#define RTTYDONE              0x2000000
 #define DISPLAY_SIGNAL_LEVEL  0x80000000
 
 // Pins
@@ -90,6 +94,30 @@ void EEPROMReadCorrection(void);
 #define LOCKLED 3
 #define TXLED 2
 
+/* Port registers and bit of the pins used in time critical code (Tx keying, status LEDs) on the Mega 2560.
+ * Must match the Arduino pin numbers above.  PinHigh(TxEnable) etc. compile to a single SBI/CBI instruction
+ * (all these ports are in the low I/O space) instead of digitalWrite() pin table lookups.
+ * Only use on pins that are not driven by analogWrite() (digitalWrite() also turns off PWM)
+ */
+#define TxEnable_PORT PORTB       // Pin 13 is PB7
+#define TxEnable_PIN  PINB
+#define TxEnable_BIT  7
+#define OKLED_PORT    PORTG       // Pin 4 is PG5
+#define OKLED_PIN     PING
+#define OKLED_BIT     5
+#define LOCKLED_PORT  PORTE       // Pin 3 is PE5
+#define LOCKLED_PIN   PINE
+#define LOCKLED_BIT   5
+#define TXLED_PORT    PORTE       // Pin 2 is PE4
+#define TXLED_PIN     PINE
+#define TXLED_BIT     4
+
+#define PinHigh(pin)   (pin##_PORT |= (1 << pin##_BIT))
+#define PinLow(pin)    (pin##_PORT &= ~(1 << pin##_BIT))
+#define PinToggle(pin) (pin##_PIN = (1 << pin##_BIT))       // Writing 1 to PINx toggles the output
+
+#define PIN_IO_CALLS 256          // Calls timed by MeasurePinIO()
+
 //Push Buttons
 #define PBUTTON1  8
 #define PBUTTON2  11
@@ -109,8 +137,23 @@ void EEPROMReadCorrection(void);
 #define ENC_PB 5
 #define ENC_PORT PINH
 #define ENC_PBPORT PINE
+
+/* Control pins as port bits (Timer 1 ISR reads the ports once per poll, see ISR(TIMER1_COMPA_vect))
+ * Encoder A/B and PBUTTON1 (PORTH) and ENC_PB (PE3) have no pin change interupt on the Mega 2560. PBUTTON2/3
+ * (PB5/PB6) do (PCINT5/6) but are polled from the same snapshot by choice so that all buttons are debounced together.
+ * Other pins on these ports (Serial2, SPI) are masked off
+ */
+#define PBUTTON1_BIT (1 << PINH5)           // Pin 8
+#define PBUTTON2_BIT (1 << PINB5)           // Pin 11
+#define PBUTTON3_BIT (1 << PINB6)           // Pin 12
+#define PBUTTON_PORT PINB                   // Push buttons 2 and 3
+#define ENC_PB_BIT (1 << PINE3)             // Pin 5
+#define CTL_PINH_MASK (0x18 | PBUTTON1_BIT) // Encoder A/B and push button 1
+#define CTL_PINE_MASK ENC_PB_BIT
+#define CTL_PINB_MASK (PBUTTON2_BIT | PBUTTON3_BIT)
+#define CTL_HOLD_POLLS 10                   // Polls after last change before idle (longer than BTN_DEBOUNCE_POLLS)
+
 #define CW           1        // Encoder rotated clockwise
 #define CCW          0        // Encoder rotated counter clockwise
-#define PUSH_BUTTON_RESET 70000
 
 #endif // _MAIN_H_